@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Benchmarks the parsing of the records of a program load, which is the work
+//! the exporter does for every bpf(2) call it sees.
+//!
+//! Run with `cargo bench -p bpf-log-exporter`.
+
+use bpf_log_exporter::parser::{decode_proctitle, parse_bpf, parse_proctitle, parse_syscall};
+use criterion::{black_box, criterion_group, criterion_main, Criterion, Throughput};
+
+const SYSCALL: &str = "audit(1717072165.816:1373): arch=c000003e syscall=321 success=yes exit=13 a0=5 a1=7ffc3d1dbb70 a2=90 a3=0 items=0 ppid=284065 pid=284066 auid=1000 uid=0 gid=0 euid=0 suid=0 fsuid=0 egid=0 sgid=0 fsgid=0 tty=pts1 ses=3 comm=\"bpfman\" exe=\"/usr/sbin/bpfman\" subj=unconfined key=(null)";
+const BPF: &str = "audit(1717072165.816:1373): prog-id=4242 op=LOAD";
+const PROCTITLE: &str = "audit(1717072165.816:1373): proctitle=2F7573722F7362696E2F6270666D616E006C6F616400696D616765002D2D696D6167652D75726C0071756179";
+
+fn parse_load(c: &mut Criterion) {
+    let mut group = c.benchmark_group("parser");
+    group.throughput(Throughput::Elements(1));
+
+    group.bench_function("syscall", |b| b.iter(|| parse_syscall(black_box(SYSCALL))));
+    group.bench_function("bpf", |b| b.iter(|| parse_bpf(black_box(BPF))));
+
+    let mut cmdline = String::new();
+    group.bench_function("proctitle", |b| {
+        b.iter(|| {
+            cmdline.clear();
+            let record = parse_proctitle(black_box(PROCTITLE)).unwrap();
+            decode_proctitle(record.proctitle, &mut cmdline);
+        })
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, parse_load);
+criterion_main!(benches);
@@ -0,0 +1,4 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+pub mod parser;
@@ -1,14 +1,15 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::{cell::RefCell, num::NonZeroI32, str::from_utf8};
+use std::{cell::RefCell, io::ErrorKind, num::NonZeroI32};
 
 use anyhow::{anyhow, Context};
-use log::info;
+use bpf_log_exporter::parser::{decode_proctitle, parse_bpf, parse_proctitle, parse_syscall};
+use log::{info, warn};
 use netlink_packet_audit::AuditMessage;
 use netlink_packet_core::{NetlinkMessage, NetlinkPayload};
 use netlink_sys::{protocols::NETLINK_AUDIT, Socket, SocketAddr};
-use regex::Regex;
+use nix::libc;
 
 fn main() -> anyhow::Result<()> {
     env_logger::init();
@@ -50,10 +51,34 @@ impl LogMessage {
             cmdline: String::new(),
         }
     }
+
+    // Resets the message for the next event, keeping the strings' buffers.
+    fn clear(&mut self) {
+        self.timestamp.clear();
+        self.prog_id = 0;
+        self.op.clear();
+        self.syscall_op = 0;
+        self.pid = 0;
+        self.uid = 0;
+        self.gid = 0;
+        self.comm.clear();
+        self.cmdline.clear();
+    }
 }
 
 const NETLINK_GROUP_READ_LOG: u32 = 0x1;
 
+/// Size requested for the socket's receive buffer, so that bursts of audit
+/// records, such as CI nodes loading thousands of programs, queue up while a
+/// batch is being processed rather than overrunning the socket.
+const SOCKET_RECEIVE_BUFFER_SIZE: usize = 8 * 1024 * 1024;
+
+/// The most messages read per wakeup before they are processed.
+const RECEIVE_BATCH_SIZE: usize = 64;
+
+/// The largest audit message, MAX_AUDIT_MESSAGE_LENGTH in the kernel.
+const MAX_AUDIT_MESSAGE_LENGTH: usize = 8970;
+
 impl NetlinkAudit {
     fn new() -> Self {
         let mut sock = Socket::new(NETLINK_AUDIT).unwrap();
@@ -61,138 +86,116 @@ impl NetlinkAudit {
         sock.connect(&SocketAddr::new(0, 0)).unwrap();
         sock.add_membership(NETLINK_GROUP_READ_LOG)
             .expect("failed to add membership");
+        // The kernel caps the size to net.core.rmem_max, which is fine.
+        if let Err(e) = sock.set_rx_buf_sz(SOCKET_RECEIVE_BUFFER_SIZE) {
+            warn!("failed to set the socket receive buffer size: {e}");
+        }
         NetlinkAudit {
             sock: RefCell::new(sock),
         }
     }
 
     fn recieve_loop(&self) -> anyhow::Result<()> {
-        let mut receive_buffer = vec![0; 4096];
         let socket = self.sock.borrow_mut();
-        let is_hex = Regex::new(r"^[0-9A-F]+$").unwrap();
+        let mut batch = vec![0; RECEIVE_BATCH_SIZE * MAX_AUDIT_MESSAGE_LENGTH];
+        let mut lengths = Vec::with_capacity(RECEIVE_BATCH_SIZE);
+        let mut overruns: u64 = 0;
         let mut log_paylod = LogMessage::new();
         loop {
-            let n = socket.recv(&mut &mut receive_buffer[..], 0)?;
-            let bytes = &receive_buffer[..n];
-            let rx_packet = <NetlinkMessage<AuditMessage>>::deserialize(bytes).unwrap();
-            match rx_packet.payload {
-                NetlinkPayload::InnerMessage(AuditMessage::Event((event_id, message))) => {
-                    match event_id {
-                        1300 => {
-                            // syscall event - 321 is sys_bpf
-                            if message.contains("syscall=321") {
-                                let parts: Vec<&str> = message.split_whitespace().collect();
-                                let a0 = parts
-                                    .iter()
-                                    .find(|s| s.starts_with("a0="))
-                                    .unwrap()
-                                    .split('=')
-                                    .last()
-                                    .unwrap();
-                                let uid = parts
-                                    .iter()
-                                    .find(|s| s.starts_with("uid="))
-                                    .expect("uid not found")
-                                    .split('=')
-                                    .last()
-                                    .unwrap();
-                                let pid = parts
-                                    .iter()
-                                    .find(|s| s.starts_with("pid="))
-                                    .expect("pid not found")
-                                    .split('=')
-                                    .last()
-                                    .unwrap();
-                                let gid = parts
-                                    .iter()
-                                    .find(|s| s.starts_with("gid="))
-                                    .expect("gid not found")
-                                    .split('=')
-                                    .last()
-                                    .unwrap();
-                                let comm = parts
-                                    .iter()
-                                    .find(|s| s.starts_with("comm="))
-                                    .unwrap()
-                                    .split('=')
-                                    .last()
-                                    .unwrap();
-
-                                log_paylod.syscall_op = a0.parse().unwrap();
-                                log_paylod.uid = uid.parse().unwrap();
-                                log_paylod.pid = pid.parse().unwrap();
-                                log_paylod.gid = gid.parse().unwrap();
-                                log_paylod.comm = comm.replace('"', "").to_string();
-                            }
-                        }
-                        1334 => {
-                            // ebpf event
-                            let parts: Vec<&str> = message.split_whitespace().collect();
-                            let prog_id = parts
-                                .iter()
-                                .find(|s| s.starts_with("prog-id="))
-                                .unwrap()
-                                .split('=')
-                                .last()
-                                .unwrap();
-                            let op = parts
-                                .iter()
-                                .find(|s| s.starts_with("op="))
-                                .unwrap()
-                                .split('=')
-                                .last()
-                                .unwrap();
-                            log_paylod.prog_id = prog_id.parse().unwrap();
-                            log_paylod.op = op.to_string();
+            // Wait for a message, then take the ones already queued without
+            // waiting, up to a full batch.
+            lengths.clear();
+            while lengths.len() < RECEIVE_BATCH_SIZE {
+                let offset = lengths.len() * MAX_AUDIT_MESSAGE_LENGTH;
+                let slot = &mut batch[offset..offset + MAX_AUDIT_MESSAGE_LENGTH];
+                let flags = if lengths.is_empty() {
+                    0
+                } else {
+                    libc::MSG_DONTWAIT
+                };
+                match socket.recv(&mut &mut slot[..], flags) {
+                    Ok(n) => lengths.push(n),
+                    Err(e) if e.kind() == ErrorKind::WouldBlock => break,
+                    Err(e) if e.raw_os_error() == Some(libc::ENOBUFS) => {
+                        // The socket overran and the kernel dropped messages,
+                        // the events they belonged to are incomplete.
+                        overruns += 1;
+                        warn!("audit messages were dropped, socket overruns: {overruns}");
+                    }
+                    Err(e) => return Err(e.into()),
+                }
+            }
+
+            for (i, n) in lengths.iter().enumerate() {
+                let offset = i * MAX_AUDIT_MESSAGE_LENGTH;
+                if !handle_messages(&batch[offset..offset + n], &mut log_paylod)? {
+                    return Ok(());
+                }
+            }
+        }
+    }
+}
+
+/// Handles the netlink messages of a datagram. Returns false once the audit
+/// stream ended.
+fn handle_messages(mut bytes: &[u8], log_paylod: &mut LogMessage) -> anyhow::Result<bool> {
+    while !bytes.is_empty() {
+        let rx_packet = <NetlinkMessage<AuditMessage>>::deserialize(bytes)
+            .map_err(|e| anyhow!("invalid netlink message: {e}"))?;
+        // Messages are padded to 4 bytes.
+        let length = (rx_packet.header.length as usize + 3) & !3;
+        bytes = bytes.get(length.max(1)..).unwrap_or_default();
+
+        match rx_packet.payload {
+            NetlinkPayload::InnerMessage(AuditMessage::Event((event_id, message))) => {
+                match event_id {
+                    1300 => {
+                        // syscall event, only bpf(2) calls are kept
+                        if let Some(record) = parse_syscall(&message) {
+                            log_paylod.syscall_op = record.cmd;
+                            log_paylod.uid = record.uid;
+                            log_paylod.pid = record.pid;
+                            log_paylod.gid = record.gid;
+                            log_paylod.comm.clear();
+                            log_paylod.comm.push_str(record.comm);
                         }
-                        1327 => {
-                            // proctitle emit event
-                            let parts = message.split_whitespace().collect::<Vec<&str>>();
-                            let timestamp = parts
-                                .iter()
-                                .find(|s| s.starts_with("audit("))
-                                .unwrap()
-                                .split(':')
-                                .next()
-                                .unwrap();
-                            log_paylod.timestamp = timestamp.replace("audit(", "").to_string();
-
-                            let proctile = parts
-                                .iter()
-                                .find(|s| s.starts_with("proctitle="))
-                                .unwrap()
-                                .split('=')
-                                .last()
-                                .unwrap();
-                            if is_hex.is_match(proctile) {
-                                log_paylod.cmdline = from_utf8(&hex::decode(proctile).unwrap())
-                                    .unwrap()
-                                    .replace('\0', " ")
-                                    .to_string();
-                            } else {
-                                log_paylod.cmdline = proctile.replace('"', "").to_string();
-                            }
+                    }
+                    1334 => {
+                        // ebpf event
+                        if let Some(record) = parse_bpf(&message) {
+                            log_paylod.prog_id = record.prog_id;
+                            log_paylod.op.clear();
+                            log_paylod.op.push_str(record.op);
                         }
-                        1320 => {
-                            info!("{:?}", log_paylod);
-                            log_paylod = LogMessage::new();
+                    }
+                    1327 => {
+                        // proctitle emit event
+                        if let Some(record) = parse_proctitle(&message) {
+                            log_paylod.timestamp.clear();
+                            log_paylod.timestamp.push_str(record.timestamp);
+                            log_paylod.cmdline.clear();
+                            decode_proctitle(record.proctitle, &mut log_paylod.cmdline);
                         }
-                        _ => {}
                     }
-                }
-                NetlinkPayload::InnerMessage(AuditMessage::Other(_)) => {
-                    // discard messages that are not events
-                }
-                NetlinkPayload::Error(e) => {
-                    if e.code == NonZeroI32::new(-17) {
-                        break;
-                    } else {
-                        return Err(anyhow!(e));
+                    1320 => {
+                        info!("{:?}", log_paylod);
+                        log_paylod.clear();
                     }
+                    _ => {}
+                }
+            }
+            NetlinkPayload::InnerMessage(AuditMessage::Other(_)) => {
+                // discard messages that are not events
+            }
+            NetlinkPayload::Error(e) => {
+                if e.code == NonZeroI32::new(-17) {
+                    return Ok(false);
+                } else {
+                    return Err(anyhow!(e));
                 }
-                m => return Err(anyhow!("unexpected netlink message {:?}", m)),
             }
+            m => return Err(anyhow!("unexpected netlink message {:?}", m)),
         }
-        Ok(())
     }
+    Ok(true)
 }
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Parsers of the audit records the exporter logs.
+//!
+//! Each parser extracts all the fields it needs in a single scan of the
+//! record and borrows them from it, so parsing a record doesn't allocate.
+
+/// The `syscall` field value of bpf(2) records on x86_64.
+const SYS_BPF: &str = "321";
+
+/// Calls `field` with the key and the value of every `key=value` field of an
+/// audit record, in order.
+///
+/// Audit hex encodes the values that would contain spaces or quotes, and
+/// quotes the other untrusted strings, so values never contain whitespace.
+pub fn for_each_field<'a>(record: &'a str, mut field: impl FnMut(&'a str, &'a str)) {
+    for token in record.split_ascii_whitespace() {
+        if let Some((key, value)) = token.split_once('=') {
+            field(key, value);
+        }
+    }
+}
+
+/// Returns a quoted value without its quotes, or None if it isn't quoted.
+fn unquote(value: &str) -> Option<&str> {
+    value.strip_prefix('"')?.strip_suffix('"')
+}
+
+/// The fields of a SYSCALL record (type 1300) of a bpf(2) call.
+#[derive(Debug, Default, PartialEq, Eq)]
+pub struct SyscallRecord<'a> {
+    /// The bpf(2) command, the syscall's first argument.
+    pub cmd: u32,
+    pub pid: u32,
+    pub uid: u32,
+    pub gid: u32,
+    pub comm: &'a str,
+}
+
+/// Parses a SYSCALL record, returning None if it isn't for a bpf(2) call or
+/// lacks one of the fields.
+pub fn parse_syscall(record: &str) -> Option<SyscallRecord<'_>> {
+    let mut is_bpf = false;
+    let (mut cmd, mut pid, mut uid, mut gid, mut comm) = (None, None, None, None, None);
+    for_each_field(record, |key, value| match key {
+        "syscall" => is_bpf = value == SYS_BPF,
+        // Syscall arguments are in hex.
+        "a0" => cmd = u32::from_str_radix(value, 16).ok(),
+        "pid" => pid = value.parse().ok(),
+        "uid" => uid = value.parse().ok(),
+        "gid" => gid = value.parse().ok(),
+        "comm" => comm = Some(unquote(value).unwrap_or(value)),
+        _ => {}
+    });
+    if !is_bpf {
+        return None;
+    }
+    Some(SyscallRecord {
+        cmd: cmd?,
+        pid: pid?,
+        uid: uid?,
+        gid: gid?,
+        comm: comm?,
+    })
+}
+
+/// The fields of a BPF record (type 1334).
+#[derive(Debug, Default, PartialEq, Eq)]
+pub struct BpfRecord<'a> {
+    pub prog_id: u32,
+    /// LOAD or UNLOAD.
+    pub op: &'a str,
+}
+
+/// Parses a BPF record, returning None if it lacks one of the fields.
+pub fn parse_bpf(record: &str) -> Option<BpfRecord<'_>> {
+    let (mut prog_id, mut op) = (None, None);
+    for_each_field(record, |key, value| match key {
+        "prog-id" => prog_id = value.parse().ok(),
+        "op" => op = Some(value),
+        _ => {}
+    });
+    Some(BpfRecord {
+        prog_id: prog_id?,
+        op: op?,
+    })
+}
+
+/// The fields of a PROCTITLE record (type 1327).
+#[derive(Debug, Default, PartialEq, Eq)]
+pub struct ProctitleRecord<'a> {
+    /// The seconds part of the record's `audit(seconds:serial)` stamp.
+    pub timestamp: &'a str,
+    /// The command line, as recorded: see [`decode_proctitle`].
+    pub proctitle: &'a str,
+}
+
+/// Parses a PROCTITLE record, returning None if it lacks one of the fields.
+pub fn parse_proctitle(record: &str) -> Option<ProctitleRecord<'_>> {
+    let stamp = &record[record.find("audit(")? + "audit(".len()..];
+    let timestamp = &stamp[..stamp.find(':')?];
+
+    let mut proctitle = None;
+    for_each_field(stamp, |key, value| {
+        if key == "proctitle" {
+            proctitle = Some(value);
+        }
+    });
+    Some(ProctitleRecord {
+        timestamp,
+        proctitle: proctitle?,
+    })
+}
+
+fn hex_digit(b: u8) -> Option<u8> {
+    match b {
+        b'0'..=b'9' => Some(b - b'0'),
+        b'A'..=b'F' => Some(b - b'A' + 10),
+        _ => None,
+    }
+}
+
+/// Appends the command line recorded in a proctitle field to `cmdline`.
+///
+/// Command lines with more than one argument, or with unusual characters, are
+/// recorded as the hex encoding of their NUL separated arguments and are
+/// decoded with the arguments separated by spaces. The others are recorded
+/// quoted.
+pub fn decode_proctitle(proctitle: &str, cmdline: &mut String) {
+    if let Some(plain) = unquote(proctitle) {
+        cmdline.push_str(plain);
+        return;
+    }
+    let hex = proctitle.as_bytes();
+    if hex.len() % 2 != 0 || !hex.iter().all(|b| hex_digit(*b).is_some()) {
+        cmdline.push_str(proctitle);
+        return;
+    }
+
+    let decoded = hex
+        .chunks_exact(2)
+        .map(|pair| (hex_digit(pair[0]).unwrap() << 4) | hex_digit(pair[1]).unwrap())
+        .map(|b| if b == 0 { b' ' } else { b });
+    if hex.chunks_exact(2).all(|pair| pair[0] < b'8') {
+        // ASCII, which is what command lines nearly always are, is copied
+        // as is.
+        cmdline.extend(decoded.map(char::from));
+    } else {
+        cmdline.push_str(&String::from_utf8_lossy(&decoded.collect::<Vec<u8>>()));
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SYSCALL: &str = "audit(1717072165.816:1373): arch=c000003e syscall=321 success=yes exit=13 a0=1c a1=7ffc3d1dbb70 a2=90 a3=0 items=0 ppid=284065 pid=284066 auid=1000 uid=0 gid=0 euid=0 suid=0 fsuid=0 egid=0 sgid=0 fsgid=0 tty=pts1 ses=3 comm=\"bpfman\" exe=\"/usr/sbin/bpfman\" subj=unconfined key=(null)";
+
+    #[test]
+    fn test_parse_syscall() {
+        assert_eq!(
+            parse_syscall(SYSCALL),
+            Some(SyscallRecord {
+                cmd: 0x1c,
+                pid: 284066,
+                uid: 0,
+                gid: 0,
+                comm: "bpfman",
+            })
+        );
+
+        let open = SYSCALL.replace("syscall=321", "syscall=257");
+        assert_eq!(parse_syscall(&open), None);
+    }
+
+    #[test]
+    fn test_parse_bpf() {
+        assert_eq!(
+            parse_bpf("audit(1717072165.816:1373): prog-id=42 op=LOAD"),
+            Some(BpfRecord {
+                prog_id: 42,
+                op: "LOAD"
+            })
+        );
+        assert_eq!(parse_bpf("audit(1717072165.816:1373): op=LOAD"), None);
+    }
+
+    #[test]
+    fn test_parse_proctitle() {
+        let record =
+            parse_proctitle("audit(1717072165.816:1373): proctitle=627066006C6F6164").unwrap();
+        assert_eq!(record.timestamp, "1717072165.816");
+
+        let mut cmdline = String::new();
+        decode_proctitle(record.proctitle, &mut cmdline);
+        assert_eq!(cmdline, "bpf load");
+
+        cmdline.clear();
+        let record = parse_proctitle("audit(1.2:3): proctitle=\"bpftool\"").unwrap();
+        decode_proctitle(record.proctitle, &mut cmdline);
+        assert_eq!(cmdline, "bpftool");
+    }
+}
@@ -0,0 +1,361 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! A cache of the loaded eBPF programs, maps and links and of their metric
+//! labels, kept up to date incrementally between collections.
+//!
+//! Every collection walks the ids of the loaded objects, which doesn't require
+//! opening them, and only opens the objects that weren't seen before, by id.
+//! The metadata exported for an object doesn't change once it is loaded, so
+//! its labels are built once and reused by every collection, with
+//! the strings they share, such as names and types, interned.
+
+use std::{
+    collections::{HashMap, HashSet},
+    io,
+    sync::Arc,
+};
+
+use aya::{
+    loaded_programs,
+    maps::{loaded_maps, MapInfo},
+    programs::{loaded_links, ProgramInfo},
+    util::nr_cpus,
+};
+use bpfman::{map_bytes, types::ProgramType};
+use chrono::{prelude::DateTime, Utc};
+use opentelemetry::{KeyValue, StringValue};
+
+use crate::sys::{
+    link_details_by_id, loaded_ids, program_details_by_id, LinkDetails, ProgramDetails,
+    BPF_LINK_GET_NEXT_ID, BPF_MAP_GET_NEXT_ID, BPF_PROG_GET_NEXT_ID,
+};
+
+/// Hands out shared copies of label values, so that equal values are only
+/// stored once however many objects use them.
+#[derive(Default)]
+struct Interner(HashSet<Arc<str>>);
+
+impl Interner {
+    fn get(&mut self, value: &str) -> StringValue {
+        if let Some(v) = self.0.get(value) {
+            return v.clone().into();
+        }
+        let v: Arc<str> = value.into();
+        self.0.insert(v.clone());
+        v.into()
+    }
+
+    // Forgets the values no cached label uses anymore.
+    fn prune(&mut self) {
+        self.0.retain(|v| Arc::strong_count(v) > 1);
+    }
+}
+
+pub(crate) struct ProgramEntry {
+    pub(crate) info_labels: [KeyValue; 7],
+    pub(crate) key_labels: [KeyValue; 3],
+    pub(crate) load_time: i64,
+    pub(crate) jitted_bytes: u64,
+    pub(crate) translated_bytes: u64,
+    pub(crate) mem_bytes: u64,
+    pub(crate) verified_instructions: u64,
+    pub(crate) map_ids: Vec<u32>,
+}
+
+pub(crate) struct MapEntry {
+    pub(crate) name: StringValue,
+    pub(crate) map_type: u32,
+    pub(crate) info_labels: [KeyValue; 7],
+    pub(crate) key_labels: [KeyValue; 3],
+    pub(crate) key_size: u64,
+    pub(crate) value_size: u64,
+    pub(crate) max_entries: u64,
+    /// The estimated kernel memory taken by the map.
+    pub(crate) mem_bytes: u64,
+}
+
+pub(crate) struct LinkEntry {
+    pub(crate) labels: [KeyValue; 3],
+}
+
+#[derive(Default)]
+pub(crate) struct Inventory {
+    pub(crate) programs: HashMap<u32, ProgramEntry>,
+    pub(crate) maps: HashMap<u32, MapEntry>,
+    pub(crate) links: HashMap<u32, LinkEntry>,
+    interner: Interner,
+    // Reused by every refresh.
+    ids: Vec<u32>,
+}
+
+// Drops the entries whose id isn't in `ids` and returns the ids that don't
+// have an entry yet. A failure to list the ids drops every entry and returns
+// None, so that they are all fetched again by walking every loaded object.
+fn sync_ids<T>(
+    entries: &mut HashMap<u32, T>,
+    ids: &[u32],
+    listed: io::Result<()>,
+) -> Option<Vec<u32>> {
+    if listed.is_err() {
+        entries.clear();
+        return None;
+    }
+    entries.retain(|id, _| ids.binary_search(id).is_ok());
+    if entries.len() == ids.len() {
+        return Some(vec![]);
+    }
+    Some(
+        ids.iter()
+            .copied()
+            .filter(|id| !entries.contains_key(id))
+            .collect(),
+    )
+}
+
+// Needed by the walk of every loaded program, when the ids couldn't be
+// listed.
+impl From<ProgramInfo> for ProgramDetails {
+    fn from(program: ProgramInfo) -> Self {
+        ProgramDetails {
+            id: program.id(),
+            program_type: program.program_type(),
+            name: program.name_as_str().unwrap_or_default().to_string(),
+            tag: program.tag(),
+            gpl_compatible: program.gpl_compatible(),
+            map_ids: program.map_ids().unwrap_or_default(),
+            loaded_at: program.loaded_at(),
+            size_jitted: program.size_jitted(),
+            size_translated: program.size_translated(),
+            memory_locked: program.memory_locked().unwrap_or_default(),
+            verified_instruction_count: program.verified_instruction_count(),
+        }
+    }
+}
+
+// Returns the share of the memory of their maps of programs using the maps
+// in `map_ids`, with the memory of a map used by several programs split
+// evenly between them.
+fn map_bytes_shares(map_ids: &[&[u32]], map_bytes: impl Fn(u32) -> u64) -> Vec<u64> {
+    let mut users: HashMap<u32, u64> = HashMap::new();
+    for id in map_ids.iter().copied().flatten() {
+        *users.entry(*id).or_default() += 1;
+    }
+    map_ids
+        .iter()
+        .map(|ids| ids.iter().map(|id| map_bytes(*id) / users[id]).sum())
+        .collect()
+}
+
+impl Inventory {
+    /// Brings the inventory up to date with the objects currently loaded.
+    pub(crate) fn refresh(&mut self) {
+        self.refresh_programs();
+        self.refresh_maps();
+        self.refresh_links();
+        self.interner.prune();
+    }
+
+    /// Returns every program along with its share of the estimated memory of
+    /// the maps it uses.
+    pub(crate) fn program_map_bytes(&self) -> impl Iterator<Item = (&ProgramEntry, u64)> {
+        let programs: Vec<&ProgramEntry> = self.programs.values().collect();
+        let map_ids: Vec<&[u32]> = programs.iter().map(|p| p.map_ids.as_slice()).collect();
+        let shares = map_bytes_shares(&map_ids, |id| {
+            self.maps.get(&id).map(|m| m.mem_bytes).unwrap_or_default()
+        });
+        programs.into_iter().zip(shares)
+    }
+
+    fn refresh_programs(&mut self) {
+        let listed = loaded_ids(BPF_PROG_GET_NEXT_ID, &mut self.ids);
+        match sync_ids(&mut self.programs, &self.ids, listed) {
+            // Programs can be unloaded after their id was listed.
+            Some(new_ids) => new_ids
+                .into_iter()
+                .filter_map(|id| program_details_by_id(id).ok())
+                .for_each(|p| self.insert_program(p)),
+            None => loaded_programs()
+                .flatten()
+                .for_each(|p| self.insert_program(p.into())),
+        }
+    }
+
+    fn insert_program(&mut self, program: ProgramDetails) {
+        let id = program.id;
+        let ty: ProgramType = program.program_type.try_into().unwrap();
+        let load_time = DateTime::<Utc>::from(program.loaded_at);
+
+        let i = &mut self.interner;
+        let id_label: StringValue = id.to_string().into();
+        let name = i.get(&program.name);
+        let ty = i.get(&ty.to_string());
+
+        self.programs.insert(
+            id,
+            ProgramEntry {
+                info_labels: [
+                    KeyValue::new("id", id_label.clone()),
+                    KeyValue::new("name", name.clone()),
+                    KeyValue::new("type", ty.clone()),
+                    KeyValue::new("tag", program.tag.to_string()),
+                    KeyValue::new("gpl_compatible", program.gpl_compatible),
+                    KeyValue::new("map_ids", format!("{:?}", program.map_ids)),
+                    KeyValue::new(
+                        "load_time",
+                        load_time.format("%Y-%m-%d %H:%M:%S").to_string(),
+                    ),
+                ],
+                key_labels: [
+                    KeyValue::new("id", id_label),
+                    KeyValue::new("name", name),
+                    KeyValue::new("type", ty),
+                ],
+                load_time: load_time.timestamp(),
+                jitted_bytes: program.size_jitted.into(),
+                translated_bytes: program.size_translated.into(),
+                mem_bytes: program.memory_locked.into(),
+                verified_instructions: program.verified_instruction_count.into(),
+                map_ids: program.map_ids,
+            },
+        );
+    }
+
+    fn refresh_maps(&mut self) {
+        let listed = loaded_ids(BPF_MAP_GET_NEXT_ID, &mut self.ids);
+        let nr_cpus = nr_cpus().unwrap_or(1) as u64;
+        match sync_ids(&mut self.maps, &self.ids, listed) {
+            Some(new_ids) => new_ids
+                .into_iter()
+                .filter_map(|id| MapInfo::from_id(id).ok())
+                .for_each(|m| self.insert_map(&m, nr_cpus)),
+            None => loaded_maps()
+                .flatten()
+                .for_each(|m| self.insert_map(&m, nr_cpus)),
+        }
+    }
+
+    fn insert_map(&mut self, map: &MapInfo, nr_cpus: u64) {
+        let id = map.id();
+        let key_size = map.key_size();
+        let value_size = map.value_size();
+        let max_entries = map.max_entries();
+
+        let i = &mut self.interner;
+        let id_label: StringValue = id.to_string().into();
+        let name = i.get(map.name_as_str().unwrap_or_default());
+        let ty = i.get(&map.map_type().to_string());
+
+        self.maps.insert(
+            id,
+            MapEntry {
+                name: name.clone(),
+                map_type: map.map_type(),
+                info_labels: [
+                    KeyValue::new("name", name.clone()),
+                    KeyValue::new("id", id_label.clone()),
+                    KeyValue::new("type", ty.clone()),
+                    KeyValue::new("key_size", i.get(&key_size.to_string())),
+                    KeyValue::new("value_size", i.get(&value_size.to_string())),
+                    KeyValue::new("max_entries", i.get(&max_entries.to_string())),
+                    KeyValue::new("flags", i.get(&map.map_flags().to_string())),
+                ],
+                key_labels: [
+                    KeyValue::new("name", name),
+                    KeyValue::new("id", id_label),
+                    KeyValue::new("type", ty),
+                ],
+                key_size: key_size.into(),
+                value_size: value_size.into(),
+                max_entries: max_entries.into(),
+                mem_bytes: map_bytes(map.map_type(), key_size, value_size, max_entries, nr_cpus),
+            },
+        );
+    }
+
+    fn refresh_links(&mut self) {
+        let listed = loaded_ids(BPF_LINK_GET_NEXT_ID, &mut self.ids);
+        match sync_ids(&mut self.links, &self.ids, listed) {
+            Some(new_ids) => new_ids
+                .into_iter()
+                .filter_map(|id| link_details_by_id(id).ok())
+                .for_each(|l| self.insert_link(&l)),
+            None => loaded_links().flatten().for_each(|l| {
+                self.insert_link(&LinkDetails {
+                    link_type: l.type_,
+                    id: l.id,
+                    prog_id: l.prog_id,
+                })
+            }),
+        }
+    }
+
+    fn insert_link(&mut self, link: &LinkDetails) {
+        // TODO getting more link metadata will require an aya_patch
+        let i = &mut self.interner;
+        self.links.insert(
+            link.id,
+            LinkEntry {
+                labels: [
+                    KeyValue::new("id", link.id.to_string()),
+                    KeyValue::new("prog_id", link.prog_id.to_string()),
+                    KeyValue::new("type", i.get(&link.link_type.to_string())),
+                ],
+            },
+        );
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use nix::libc;
+
+    use super::*;
+
+    #[test]
+    fn test_sync_ids() {
+        let mut entries: HashMap<u32, ()> = [(1, ()), (2, ()), (5, ())].into();
+
+        // Ids 2 and 3 are still loaded, 3 is new.
+        assert_eq!(sync_ids(&mut entries, &[2, 3], Ok(())), Some(vec![3]));
+        assert_eq!(entries.keys().copied().collect::<Vec<_>>(), vec![2]);
+
+        // Nothing changed.
+        assert_eq!(sync_ids(&mut entries, &[2], Ok(())), Some(vec![]));
+
+        // The ids couldn't be listed.
+        assert_eq!(
+            sync_ids(
+                &mut entries,
+                &[2],
+                Err(io::Error::from_raw_os_error(libc::EPERM))
+            ),
+            None
+        );
+        assert!(entries.is_empty());
+    }
+
+    #[test]
+    fn test_map_bytes_shares() {
+        let map_bytes = |id| u64::from(id) * 100;
+        // Map 2 is shared by the first two programs.
+        let map_ids: [&[u32]; 3] = [&[1, 2], &[2], &[]];
+        assert_eq!(map_bytes_shares(&map_ids, map_bytes), vec![200, 100, 0]);
+    }
+
+    #[test]
+    fn test_interner() {
+        let mut i = Interner::default();
+        let a = i.get("xdp");
+        let b = i.get("xdp");
+        assert_eq!(a, b);
+        assert_eq!(i.0.len(), 1);
+
+        drop(a);
+        i.prune();
+        assert_eq!(i.0.len(), 1);
+        drop(b);
+        i.prune();
+        assert!(i.0.is_empty());
+    }
+}
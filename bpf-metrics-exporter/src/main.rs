@@ -1,18 +1,29 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use aya::{loaded_programs, maps::loaded_maps, programs::loaded_links};
-use bpfman::types::ProgramType;
-use chrono::{prelude::DateTime, Utc};
+use std::{
+    sync::{Arc, Mutex},
+    time::Duration,
+};
+
+use bpfman::list_dispatcher_stats;
 use clap::Parser;
+use inventory::Inventory;
+use map_export::MapExporter;
 use opentelemetry::{
     metrics::{MeterProvider as _, Unit},
     KeyValue,
 };
 use opentelemetry_otlp::WithExportConfig;
 use opentelemetry_sdk::{metrics::SdkMeterProvider, runtime, Resource};
+use runtime_stats::RunTimeSample;
 use tokio::signal::ctrl_c;
 
+mod inventory;
+mod map_export;
+mod runtime_stats;
+mod sys;
+
 fn init_meter_provider(grpc_endpoint: &str) -> SdkMeterProvider {
     opentelemetry_otlp::new_pipeline()
         .metrics(runtime::Tokio)
@@ -34,6 +45,27 @@ fn init_meter_provider(grpc_endpoint: &str) -> SdkMeterProvider {
 struct Cli {
     #[clap(long, default_value = "http://localhost:4317")]
     otel_grpc: String,
+    /// Periodically enable the kernel's BPF run time stats and export the
+    /// average run time and invocation rate of every program and bpfman
+    /// dispatcher slot. Enabling the stats slows every program run down a
+    /// little, so they are only enabled for a bounded window at a time.
+    #[clap(long)]
+    runtime_stats: bool,
+    /// How long, in seconds, the run time stats stay enabled for each sample.
+    #[clap(long, default_value_t = 5)]
+    runtime_stats_window: u64,
+    /// How often, in seconds, the run time stats are sampled.
+    #[clap(long, default_value_t = 60)]
+    runtime_stats_interval: u64,
+    /// Export the contents of the maps with this name, which can be given
+    /// more than once. Values are exported as 64 bit words, summed across CPUs
+    /// for per-CPU maps.
+    #[clap(long = "export-map", value_name = "NAME")]
+    export_maps: Vec<String>,
+    /// The most entries of each exported map read per collection. Larger maps
+    /// are read over several collections.
+    #[clap(long, default_value_t = 4096)]
+    map_sample_limit: usize,
 }
 
 #[tokio::main]
@@ -113,6 +145,89 @@ async fn main() -> anyhow::Result<()> {
         .with_unit(Unit::new("bytes"))
         .init();
 
+    let bpf_map_mem_bytes = meter
+        .u64_observable_counter("bpf_map_mem_bytes")
+        .with_description("Estimated BPF map kernel memory usage in bytes")
+        .with_unit(Unit::new("bytes"))
+        .init();
+
+    let bpf_program_map_mem_bytes = meter
+        .u64_observable_counter("bpf_program_map_mem_bytes")
+        .with_description(
+            "Estimated kernel memory usage in bytes of the BPF maps of a program, shared maps split evenly",
+        )
+        .with_unit(Unit::new("bytes"))
+        .init();
+
+    let bpf_dispatcher_slot_invocations = meter
+        .u64_observable_counter("bpf_dispatcher_slot_invocations")
+        .with_description("Number of times a bpfman dispatcher slot was invoked")
+        .init();
+
+    let bpf_dispatcher_slot_run_time = meter
+        .u64_observable_counter("bpf_dispatcher_slot_run_time")
+        .with_description("Cumulative time spent in a bpfman dispatcher slot")
+        .with_unit(Unit::new("nanoseconds"))
+        .init();
+
+    let bpf_dispatcher_slot_verdicts = meter
+        .u64_observable_counter("bpf_dispatcher_slot_verdicts")
+        .with_description("Number of times a bpfman dispatcher slot returned a verdict")
+        .init();
+
+    let bpf_dispatcher_slot_latency = meter
+        .u64_observable_counter("bpf_dispatcher_slot_latency")
+        .with_description("Number of bpfman dispatcher slot invocations per log2 latency bucket")
+        .init();
+
+    let bpf_program_avg_run_time = meter
+        .f64_observable_gauge("bpf_program_avg_run_time")
+        .with_description("Average run time of a BPF program over the last run time stats window")
+        .with_unit(Unit::new("nanoseconds"))
+        .init();
+
+    let bpf_program_invocation_rate = meter
+        .f64_observable_gauge("bpf_program_invocation_rate")
+        .with_description("Rate a BPF program ran at over the last run time stats window")
+        .with_unit(Unit::new("invocations/second"))
+        .init();
+
+    let bpf_dispatcher_slot_avg_run_time = meter
+        .f64_observable_gauge("bpf_dispatcher_slot_avg_run_time")
+        .with_description(
+            "Average run time of a bpfman dispatcher slot over the last run time stats window",
+        )
+        .with_unit(Unit::new("nanoseconds"))
+        .init();
+
+    let bpf_dispatcher_slot_invocation_rate = meter
+        .f64_observable_gauge("bpf_dispatcher_slot_invocation_rate")
+        .with_description(
+            "Rate a bpfman dispatcher slot ran at over the last run time stats window",
+        )
+        .with_unit(Unit::new("invocations/second"))
+        .init();
+
+    let bpf_map_value = meter
+        .u64_observable_gauge("bpf_map_value")
+        .with_description("A 64 bit word of the value of an entry of an exported BPF map")
+        .init();
+
+    let inventory = Mutex::new(Inventory::default());
+    let map_exporter = Mutex::new(MapExporter::new(cli.export_maps, cli.map_sample_limit));
+    let run_time_sample = Arc::new(Mutex::new(RunTimeSample::default()));
+
+    if cli.runtime_stats {
+        if cli.runtime_stats_window == 0 || cli.runtime_stats_window > cli.runtime_stats_interval {
+            anyhow::bail!("the run time stats window must be between 1s and the interval");
+        }
+        tokio::spawn(runtime_stats::run(
+            run_time_sample.clone(),
+            Duration::from_secs(cli.runtime_stats_window),
+            Duration::from_secs(cli.runtime_stats_interval),
+        ));
+    }
+
     meter
         .register_callback(
             &[
@@ -127,125 +242,174 @@ async fn main() -> anyhow::Result<()> {
                 bpf_map_key_size.as_any(),
                 bpf_map_value_size.as_any(),
                 bpf_map_max_entries.as_any(),
+                bpf_map_mem_bytes.as_any(),
+                bpf_program_map_mem_bytes.as_any(),
+                bpf_dispatcher_slot_invocations.as_any(),
+                bpf_dispatcher_slot_run_time.as_any(),
+                bpf_dispatcher_slot_verdicts.as_any(),
+                bpf_dispatcher_slot_latency.as_any(),
+                bpf_program_avg_run_time.as_any(),
+                bpf_program_invocation_rate.as_any(),
+                bpf_dispatcher_slot_avg_run_time.as_any(),
+                bpf_dispatcher_slot_invocation_rate.as_any(),
+                bpf_map_value.as_any(),
             ],
             move |observer| {
-                for program in loaded_programs().flatten() {
-                    let id = program.id();
-                    let name = program.name_as_str().unwrap_or_default().to_string();
-                    let ty: ProgramType = program.program_type().try_into().unwrap();
-                    let tag = program.tag().to_string();
-                    let gpl_compatible = program.gpl_compatible();
-                    let map_ids = program.map_ids().unwrap_or_default();
-
-                    let load_time = DateTime::<Utc>::from(program.loaded_at());
-                    let jitted_bytes = program.size_jitted();
-                    let translated_bytes = program.size_translated();
-                    let mem_bytes = program.memory_locked().unwrap_or_default();
-                    let verified_instructions = program.verified_instruction_count();
-
-                    let prog_info_labels = [
-                        KeyValue::new("id", id.to_string()),
-                        KeyValue::new("name", name.clone()),
-                        KeyValue::new("type", format!("{ty}")),
-                        KeyValue::new("tag", tag.clone()),
-                        KeyValue::new("gpl_compatible", gpl_compatible),
-                        KeyValue::new("map_ids", format!("{map_ids:?}")),
-                        KeyValue::new(
-                            "load_time",
-                            load_time.format("%Y-%m-%d %H:%M:%S").to_string(),
-                        ),
-                    ];
+                let mut inventory = inventory.lock().unwrap();
+                inventory.refresh();
 
-                    observer.observe_u64(&bpf_program_info, 1, &prog_info_labels);
-
-                    let prog_key_labels = [
-                        KeyValue::new("id", id.to_string()),
-                        KeyValue::new("name", name),
-                        KeyValue::new("type", format!("{ty}")),
-                    ];
+                for program in inventory.programs.values() {
+                    observer.observe_u64(&bpf_program_info, 1, &program.info_labels);
 
                     observer.observe_i64(
                         &bpf_program_load_time,
-                        load_time.timestamp(),
-                        &prog_key_labels,
+                        program.load_time,
+                        &program.key_labels,
                     );
 
                     observer.observe_u64(
                         &bpf_program_size_jitted_bytes,
-                        jitted_bytes.into(),
-                        &prog_key_labels,
+                        program.jitted_bytes,
+                        &program.key_labels,
                     );
 
                     observer.observe_u64(
                         &bpf_program_size_translated_bytes,
-                        translated_bytes.into(),
-                        &prog_key_labels,
+                        program.translated_bytes,
+                        &program.key_labels,
                     );
 
                     observer.observe_u64(
                         &bpf_program_mem_bytes,
-                        mem_bytes.into(),
-                        &prog_key_labels,
+                        program.mem_bytes,
+                        &program.key_labels,
                     );
 
                     observer.observe_u64(
                         &bpf_program_verified_instructions,
-                        verified_instructions.into(),
-                        &prog_key_labels,
+                        program.verified_instructions,
+                        &program.key_labels,
                     );
                 }
 
-                for link in loaded_links().flatten() {
-                    let id = link.id;
-                    let prog_id = link.prog_id;
-                    let _type = link.type_;
-                    // TODO getting more link metadata will require an aya_patch
-                    // let link_info = match link.__bindgen_anon_1 {
-                    //     // aya_obj::bpf_link_info__bindgen_ty_1::raw_tracepoint(i) => "tracepoint",
-                    //     aya_obj::generated::bpf_link_info__bindgen_ty_1{ raw_tracepoint } => format!("tracepoint name: "),
-                    // }
-
-                    let link_labels = [
-                        KeyValue::new("id", id.to_string()),
-                        KeyValue::new("prog_id", prog_id.to_string()),
-                        KeyValue::new("type", _type.to_string()),
-                    ];
+                let run_time_sample = run_time_sample.lock().unwrap();
+                for (id, stats) in &run_time_sample.programs {
+                    let Some(program) = inventory.programs.get(id) else {
+                        continue;
+                    };
+                    observer.observe_f64(
+                        &bpf_program_avg_run_time,
+                        stats.avg_run_time_ns,
+                        &program.key_labels,
+                    );
+                    observer.observe_f64(
+                        &bpf_program_invocation_rate,
+                        stats.invocations_per_second,
+                        &program.key_labels,
+                    );
+                }
+                for slot in &run_time_sample.slots {
+                    observer.observe_f64(
+                        &bpf_dispatcher_slot_avg_run_time,
+                        slot.stats.avg_run_time_ns,
+                        &slot.labels,
+                    );
+                    observer.observe_f64(
+                        &bpf_dispatcher_slot_invocation_rate,
+                        slot.stats.invocations_per_second,
+                        &slot.labels,
+                    );
+                }
+                drop(run_time_sample);
 
-                    observer.observe_u64(&bpf_link_info, 1, &link_labels);
+                for link in inventory.links.values() {
+                    observer.observe_u64(&bpf_link_info, 1, &link.labels);
                 }
 
-                for map in loaded_maps().flatten() {
-                    let map_id = map.id();
-                    let name = map.name_as_str().unwrap_or_default().to_string();
-                    let ty = map.map_type().to_string();
-                    let key_size = map.key_size();
-                    let value_size = map.value_size();
-                    let max_entries = map.max_entries();
-                    let flags = map.map_flags();
-
-                    let map_labels = [
-                        KeyValue::new("name", name.clone()),
-                        KeyValue::new("id", map_id.to_string()),
-                        KeyValue::new("type", ty.clone()),
-                        KeyValue::new("key_size", key_size.to_string()),
-                        KeyValue::new("value_size", value_size.to_string()),
-                        KeyValue::new("max_entries", max_entries.to_string()),
-                        KeyValue::new("flags", flags.to_string()),
-                    ];
+                for map in inventory.maps.values() {
+                    observer.observe_u64(&bpf_map_info, 1, &map.info_labels);
+
+                    observer.observe_u64(&bpf_map_key_size, map.key_size, &map.key_labels);
 
-                    observer.observe_u64(&bpf_map_info, 1, &map_labels);
+                    observer.observe_u64(&bpf_map_value_size, map.value_size, &map.key_labels);
+
+                    observer.observe_u64(&bpf_map_max_entries, map.max_entries, &map.key_labels);
+
+                    observer.observe_u64(&bpf_map_mem_bytes, map.mem_bytes, &map.key_labels);
+                }
 
-                    let map_key_labels = [
-                        KeyValue::new("name", name),
-                        KeyValue::new("id", map_id.to_string()),
-                        KeyValue::new("type", ty),
+                for (program, bytes) in inventory.program_map_bytes() {
+                    observer.observe_u64(&bpf_program_map_mem_bytes, bytes, &program.key_labels);
+                }
+
+                let mut map_exporter = map_exporter.lock().unwrap();
+                map_exporter.collect(&inventory.maps);
+                map_exporter.for_each_value(|value, labels| {
+                    observer.observe_u64(&bpf_map_value, value, labels);
+                });
+                drop(map_exporter);
+
+                // Dispatcher slot stats are only available for dispatchers
+                // loaded with collect_stats enabled.
+                for stats in list_dispatcher_stats().unwrap_or_default() {
+                    let direction = stats.direction.map(|d| d.to_string()).unwrap_or_default();
+                    let slot_labels = [
+                        KeyValue::new("type", format!("{}", stats.kind)),
+                        KeyValue::new("if_index", stats.if_index.to_string()),
+                        KeyValue::new("direction", direction.clone()),
+                        // Both revisions of a dispatcher being replaced may
+                        // be listed.
+                        KeyValue::new("revision", stats.revision.to_string()),
+                        KeyValue::new("slot", stats.slot.to_string()),
                     ];
 
-                    observer.observe_u64(&bpf_map_key_size, key_size.into(), &map_key_labels);
+                    observer.observe_u64(
+                        &bpf_dispatcher_slot_invocations,
+                        stats.count,
+                        &slot_labels,
+                    );
 
-                    observer.observe_u64(&bpf_map_value_size, value_size.into(), &map_key_labels);
+                    observer.observe_u64(
+                        &bpf_dispatcher_slot_run_time,
+                        stats.run_time_ns,
+                        &slot_labels,
+                    );
 
-                    observer.observe_u64(&bpf_map_max_entries, max_entries.into(), &map_key_labels);
+                    for (bucket, count) in stats.verdicts.iter().enumerate() {
+                        if *count == 0 {
+                            continue;
+                        }
+                        let verdict_labels = [
+                            KeyValue::new("type", format!("{}", stats.kind)),
+                            KeyValue::new("if_index", stats.if_index.to_string()),
+                            KeyValue::new("direction", direction.clone()),
+                            KeyValue::new("revision", stats.revision.to_string()),
+                            KeyValue::new("slot", stats.slot.to_string()),
+                            KeyValue::new("verdict", stats.verdict_name(bucket)),
+                        ];
+                        observer.observe_u64(
+                            &bpf_dispatcher_slot_verdicts,
+                            *count,
+                            &verdict_labels,
+                        );
+                    }
+
+                    for (bucket, count) in stats.latency.iter().enumerate() {
+                        if *count == 0 {
+                            continue;
+                        }
+                        // Bucket 0 also counts anything faster than 1ns
+                        let min_ns = if bucket == 0 { 0 } else { 1u64 << bucket };
+                        let latency_labels = [
+                            KeyValue::new("type", format!("{}", stats.kind)),
+                            KeyValue::new("if_index", stats.if_index.to_string()),
+                            KeyValue::new("direction", direction.clone()),
+                            KeyValue::new("revision", stats.revision.to_string()),
+                            KeyValue::new("slot", stats.slot.to_string()),
+                            KeyValue::new("min_ns", min_ns.to_string()),
+                        ];
+                        observer.observe_u64(&bpf_dispatcher_slot_latency, *count, &latency_labels);
+                    }
                 }
             },
         )
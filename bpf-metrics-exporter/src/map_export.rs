@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Optional export of the contents of selected maps.
+//!
+//! Values are exported as arrays of 64 bit words, summed across CPUs for
+//! per-CPU maps, which is what counter maps such as the examples'
+//! `xdp_stats_map` hold. Keys of 4 or 8 bytes are exported as integers and
+//! longer ones in hex.
+//!
+//! Entries are read with BPF_MAP_LOOKUP_BATCH, falling back to one lookup per
+//! key on kernels without batch support for the map type, or when a hash map
+//! has a bucket with more entries than the sample limit, as batches of hash
+//! maps only return whole buckets. Each collection
+//! reads at most `sample_limit` entries of a map, picking up where the
+//! previous one stopped, so the time a collection takes is bounded however
+//! large a map grows. The entries of a large map are exported with the value
+//! they had when they were last read, and dropped once a whole pass over the
+//! map didn't find them anymore.
+
+use std::{
+    collections::HashMap,
+    fmt::Write as _,
+    io,
+    os::fd::{AsFd, OwnedFd},
+    sync::Arc,
+};
+
+use aya::util::nr_cpus;
+use nix::libc;
+use opentelemetry::{KeyValue, StringValue};
+
+use crate::{
+    inventory::MapEntry,
+    sys::{map_fd_by_id, map_get_next_key, map_lookup_batch, map_lookup_elem},
+};
+
+const BPF_MAP_TYPE_HASH: u32 = 1;
+const BPF_MAP_TYPE_ARRAY: u32 = 2;
+const BPF_MAP_TYPE_PERCPU_HASH: u32 = 5;
+const BPF_MAP_TYPE_PERCPU_ARRAY: u32 = 6;
+const BPF_MAP_TYPE_LRU_HASH: u32 = 9;
+const BPF_MAP_TYPE_LRU_PERCPU_HASH: u32 = 10;
+
+// The most entries read per BPF_MAP_LOOKUP_BATCH call.
+const BATCH_SIZE: usize = 256;
+
+// Returned by the kernel for commands a map type doesn't implement.
+const ENOTSUPP: i32 = 524;
+
+/// The kernel truncates map names to 15 characters, so a longer name selects
+/// the maps whose name is its first 15 characters.
+fn name_matches(selected: &str, name: &str) -> bool {
+    selected == name || (name.len() == 15 && selected.starts_with(name))
+}
+
+fn key_label(key: &[u8]) -> Arc<str> {
+    match key.len() {
+        4 => u32::from_ne_bytes(key.try_into().unwrap())
+            .to_string()
+            .into(),
+        8 => u64::from_ne_bytes(key.try_into().unwrap())
+            .to_string()
+            .into(),
+        _ => {
+            let mut hex = String::with_capacity(key.len() * 2);
+            for b in key {
+                let _ = write!(hex, "{b:02x}");
+            }
+            hex.into()
+        }
+    }
+}
+
+/// Sums the values of an entry on every CPU, `stride` bytes apart, into
+/// `total` as 64 bit words.
+///
+/// Per-CPU values are padded to 8 bytes by the kernel, so the common case
+/// adds whole words across CPUs in a loop without branches that the compiler
+/// vectorizes. Values that aren't a whole number of words are zero padded.
+fn aggregate(values: &[u8], stride: usize, total: &mut [u64]) {
+    total.fill(0);
+    if stride % 8 == 0 {
+        for cpu in values.chunks_exact(stride) {
+            for (t, word) in total.iter_mut().zip(cpu.chunks_exact(8)) {
+                *t = t.wrapping_add(u64::from_ne_bytes(word.try_into().unwrap()));
+            }
+        }
+    } else {
+        for cpu in values.chunks_exact(stride) {
+            for (t, word) in total.iter_mut().zip(cpu.chunks(8)) {
+                let mut padded = [0; 8];
+                padded[..word.len()].copy_from_slice(word);
+                *t = t.wrapping_add(u64::from_ne_bytes(padded));
+            }
+        }
+    }
+}
+
+struct Entry {
+    key: StringValue,
+    words: Vec<u64>,
+    // The pass over the map the entry was last read in.
+    pass: u64,
+}
+
+struct ExportedMap {
+    fd: OwnedFd,
+    id: StringValue,
+    name: StringValue,
+    key_size: usize,
+    // The bytes a value takes on one CPU, and on all of them.
+    cpu_stride: usize,
+    value_size: usize,
+    words: usize,
+    batch: bool,
+    // Where the next collection starts from: a batch position, or the last
+    // key read without batches. None at the start of a pass.
+    cursor: Option<Vec<u8>>,
+    pass: u64,
+    entries: HashMap<Box<[u8]>, Entry>,
+    keys: Vec<u8>,
+    values: Vec<u8>,
+    out_batch: Vec<u8>,
+}
+
+impl ExportedMap {
+    fn open(id: u32, map: &MapEntry, nr_cpus: usize) -> io::Result<Self> {
+        let per_cpu = matches!(
+            map.map_type,
+            BPF_MAP_TYPE_PERCPU_HASH | BPF_MAP_TYPE_PERCPU_ARRAY | BPF_MAP_TYPE_LRU_PERCPU_HASH
+        );
+        let key_size = map.key_size as usize;
+        let (cpu_stride, value_size) = if per_cpu {
+            let stride = (map.value_size as usize + 7) & !7;
+            (stride, stride * nr_cpus)
+        } else {
+            (map.value_size as usize, map.value_size as usize)
+        };
+
+        Ok(Self {
+            fd: map_fd_by_id(id)?,
+            id: id.to_string().into(),
+            name: map.name.clone(),
+            key_size,
+            cpu_stride,
+            value_size,
+            words: (map.value_size as usize + 7) / 8,
+            batch: true,
+            cursor: None,
+            pass: 0,
+            entries: HashMap::new(),
+            keys: vec![0; key_size * BATCH_SIZE],
+            values: vec![0; value_size * BATCH_SIZE],
+            // Batch positions are a key for arrays and a bucket index for
+            // hash maps.
+            out_batch: vec![0; key_size.max(8)],
+        })
+    }
+
+    // Grows the buffers to hold `count` entries.
+    fn reserve(&mut self, count: usize) {
+        if self.keys.len() < count * self.key_size {
+            self.keys.resize(count * self.key_size, 0);
+            self.values.resize(count * self.value_size, 0);
+        }
+    }
+
+    // Reads up to `limit` entries into the buffers, or up to `max` when the
+    // next bucket of a hash map holds more than `limit`, returning how many
+    // were read and whether the end of the map was reached.
+    fn read(&mut self, limit: usize, max: usize) -> io::Result<(usize, bool)> {
+        let mut batch_size = limit;
+        while self.batch {
+            match map_lookup_batch(
+                self.fd.as_fd(),
+                self.cursor.as_deref(),
+                &mut self.out_batch,
+                &mut self.keys,
+                &mut self.values,
+                batch_size as u32,
+            ) {
+                Ok((count, done)) => {
+                    self.cursor = Some(self.out_batch.clone());
+                    return Ok((count as usize, done));
+                }
+                // The bucket doesn't fit in the batch.
+                Err(e) if e.raw_os_error() == Some(libc::ENOSPC) && batch_size < max => {
+                    batch_size = (batch_size * 2).min(max);
+                    self.reserve(batch_size);
+                }
+                Err(e)
+                    if matches!(
+                        e.raw_os_error(),
+                        Some(libc::ENOSPC | libc::EINVAL | libc::EOPNOTSUPP | ENOTSUPP)
+                    ) =>
+                {
+                    // No batch support, or a bucket larger than the sample
+                    // limit. Batch positions and keys don't mix, start over.
+                    self.batch = false;
+                    self.cursor = None;
+                }
+                Err(e) => return Err(e),
+            }
+        }
+
+        let (ks, vs) = (self.key_size, self.value_size);
+        let mut count = 0;
+        while count < limit {
+            let (prev, next) = self.keys.split_at_mut(count * ks);
+            let prev = match count {
+                0 => self.cursor.as_deref(),
+                _ => Some(&prev[(count - 1) * ks..]),
+            };
+            let next = &mut next[..ks];
+            if !map_get_next_key(self.fd.as_fd(), prev, next)? {
+                return Ok((count, true));
+            }
+            let value = &mut self.values[count * vs..(count + 1) * vs];
+            if map_lookup_elem(self.fd.as_fd(), next, value).is_err() {
+                // Deleted meanwhile.
+                value.fill(0);
+            }
+            count += 1;
+        }
+        self.cursor = Some(self.keys[(count - 1) * ks..count * ks].to_vec());
+        Ok((count, false))
+    }
+
+    fn collect(&mut self, sample_limit: usize) -> io::Result<()> {
+        let mut read = 0;
+        while read < sample_limit {
+            let left = sample_limit - read;
+            let (count, done) = self.read(BATCH_SIZE.min(left), left)?;
+            for i in 0..count {
+                let key = &self.keys[i * self.key_size..(i + 1) * self.key_size];
+                let values = &self.values[i * self.value_size..(i + 1) * self.value_size];
+                if !self.entries.contains_key(key) {
+                    self.entries.insert(
+                        key.into(),
+                        Entry {
+                            key: key_label(key).into(),
+                            words: vec![0; self.words],
+                            pass: 0,
+                        },
+                    );
+                }
+                let entry = self.entries.get_mut(key).unwrap();
+                aggregate(values, self.cpu_stride, &mut entry.words);
+                entry.pass = self.pass;
+            }
+            read += count;
+
+            if done {
+                // Drop what this pass didn't see and stop, so that a small map
+                // is read once per collection.
+                let pass = self.pass;
+                self.entries.retain(|_, e| e.pass == pass);
+                self.pass += 1;
+                self.cursor = None;
+                break;
+            }
+            if count == 0 {
+                break;
+            }
+        }
+        Ok(())
+    }
+}
+
+/// Reads the contents of the maps selected by name.
+pub(crate) struct MapExporter {
+    names: Vec<String>,
+    sample_limit: usize,
+    nr_cpus: usize,
+    maps: HashMap<u32, ExportedMap>,
+}
+
+impl MapExporter {
+    pub(crate) fn new(names: Vec<String>, sample_limit: usize) -> Self {
+        Self {
+            names,
+            sample_limit,
+            nr_cpus: nr_cpus().unwrap_or(1),
+            maps: HashMap::new(),
+        }
+    }
+
+    /// Reads the selected maps among the loaded `maps`.
+    pub(crate) fn collect(&mut self, maps: &HashMap<u32, MapEntry>) {
+        if self.names.is_empty() {
+            return;
+        }
+
+        self.maps.retain(|id, _| maps.contains_key(id));
+        for (id, map) in maps {
+            if self.maps.contains_key(id)
+                || !self
+                    .names
+                    .iter()
+                    .any(|n| name_matches(n, map.name.as_str()))
+            {
+                continue;
+            }
+            if !matches!(
+                map.map_type,
+                BPF_MAP_TYPE_HASH
+                    | BPF_MAP_TYPE_ARRAY
+                    | BPF_MAP_TYPE_PERCPU_HASH
+                    | BPF_MAP_TYPE_PERCPU_ARRAY
+                    | BPF_MAP_TYPE_LRU_HASH
+                    | BPF_MAP_TYPE_LRU_PERCPU_HASH
+            ) {
+                continue;
+            }
+            match ExportedMap::open(*id, map, self.nr_cpus) {
+                Ok(exported) => {
+                    self.maps.insert(*id, exported);
+                }
+                Err(e) => eprintln!("unable to open map {id}: {e}"),
+            }
+        }
+
+        for (id, map) in self.maps.iter_mut() {
+            if let Err(e) = map.collect(self.sample_limit) {
+                eprintln!("unable to read map {id}: {e}");
+            }
+        }
+    }
+
+    /// Calls `observe` with every word of every exported entry and its labels.
+    pub(crate) fn for_each_value(&self, mut observe: impl FnMut(u64, &[KeyValue])) {
+        for map in self.maps.values() {
+            for entry in map.entries.values() {
+                for (field, word) in entry.words.iter().enumerate() {
+                    observe(
+                        *word,
+                        &[
+                            KeyValue::new("map_id", map.id.clone()),
+                            KeyValue::new("map_name", map.name.clone()),
+                            KeyValue::new("key", entry.key.clone()),
+                            KeyValue::new("field", field as i64),
+                        ],
+                    );
+                }
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_aggregate() {
+        // Two CPUs, values of two words.
+        let values: Vec<u8> = [1u64, 10, 2, 20]
+            .iter()
+            .flat_map(|v| v.to_ne_bytes())
+            .collect();
+        let mut total = [0; 2];
+        aggregate(&values, 16, &mut total);
+        assert_eq!(total, [3, 30]);
+
+        // A single 4 byte value.
+        let mut total = [0; 1];
+        aggregate(&7u32.to_ne_bytes(), 4, &mut total);
+        assert_eq!(total, [7]);
+    }
+
+    #[test]
+    fn test_key_label() {
+        assert_eq!(&*key_label(&2u32.to_ne_bytes()), "2");
+        assert_eq!(&*key_label(&[0xab, 0x01]), "ab01");
+    }
+
+    #[test]
+    fn test_name_matches() {
+        assert!(name_matches("xdp_stats_map", "xdp_stats_map"));
+        assert!(name_matches("bpfman_events_dropped", "bpfman_events_d"));
+        assert!(!name_matches("xdp_stats_map", "tc_stats_map"));
+    }
+}
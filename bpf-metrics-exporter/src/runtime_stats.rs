@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Opt-in sampling of the run time the kernel accounts to each program.
+//!
+//! The kernel only accounts run time and run counts while BPF_ENABLE_STATS is
+//! in effect, which adds two clock reads to every program run, so the sampler
+//! only turns it on for a bounded window once per interval and keeps the
+//! average run time and invocation rate over the last window.
+//!
+//! Programs attached to a bpfman dispatcher slot are extensions that the
+//! dispatcher jumps to directly, which the kernel never accounts separately.
+//! Their figures come from the dispatcher's own slot stats over the same
+//! window instead, for the dispatchers loaded with `collect_stats` enabled.
+
+use std::{
+    collections::HashMap,
+    io,
+    os::fd::AsFd,
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+
+use aya::loaded_programs;
+use bpfman::{list_dispatcher_stats, types::DispatcherSlotStats};
+use opentelemetry::KeyValue;
+
+use crate::sys::{enable_run_time_stats, program_run_stats};
+
+/// The average cost and rate of the runs of a program over a window.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) struct RunTimeStats {
+    pub(crate) avg_run_time_ns: f64,
+    pub(crate) invocations_per_second: f64,
+}
+
+impl RunTimeStats {
+    // Returns None when nothing ran during the window.
+    fn new(run_time_ns: u64, run_cnt: u64, window: Duration) -> Option<Self> {
+        if run_cnt == 0 || window.is_zero() {
+            return None;
+        }
+        Some(Self {
+            avg_run_time_ns: run_time_ns as f64 / run_cnt as f64,
+            invocations_per_second: run_cnt as f64 / window.as_secs_f64(),
+        })
+    }
+}
+
+pub(crate) struct SlotRunTimeStats {
+    pub(crate) labels: [KeyValue; 6],
+    pub(crate) stats: RunTimeStats,
+}
+
+/// The run time stats of the last window, by program id and dispatcher slot.
+#[derive(Default)]
+pub(crate) struct RunTimeSample {
+    pub(crate) programs: HashMap<u32, RunTimeStats>,
+    pub(crate) slots: Vec<SlotRunTimeStats>,
+}
+
+// The run time and run count of every loaded program, by program id.
+fn program_counters() -> HashMap<u32, (u64, u64)> {
+    loaded_programs()
+        .flatten()
+        .filter_map(|program| {
+            let fd = program.fd().ok()?;
+            Some((program.id(), program_run_stats(fd.as_fd()).ok()?))
+        })
+        .collect()
+}
+
+fn same_slot(a: &DispatcherSlotStats, b: &DispatcherSlotStats) -> bool {
+    a.kind == b.kind
+        && a.if_index == b.if_index
+        && a.direction == b.direction
+        && a.revision == b.revision
+        && a.slot == b.slot
+}
+
+impl RunTimeSample {
+    // Builds a sample from the counters read at the start and the end of a
+    // window. Counters only ever grow, so programs and slots that weren't
+    // there at the start of the window are left out.
+    fn new(
+        programs_start: &HashMap<u32, (u64, u64)>,
+        programs_end: &HashMap<u32, (u64, u64)>,
+        slots_start: &[DispatcherSlotStats],
+        slots_end: &[DispatcherSlotStats],
+        window: Duration,
+    ) -> Self {
+        let mut sample = RunTimeSample::default();
+
+        for (id, (run_time_ns, run_cnt)) in programs_end {
+            let Some((start_run_time_ns, start_run_cnt)) = programs_start.get(id) else {
+                continue;
+            };
+            if let Some(stats) = RunTimeStats::new(
+                run_time_ns.saturating_sub(*start_run_time_ns),
+                run_cnt.saturating_sub(*start_run_cnt),
+                window,
+            ) {
+                sample.programs.insert(*id, stats);
+            }
+        }
+
+        for end in slots_end {
+            let Some(start) = slots_start.iter().find(|start| same_slot(start, end)) else {
+                continue;
+            };
+            let run_time_ns = end.run_time_ns.saturating_sub(start.run_time_ns);
+            let count = end.count.saturating_sub(start.count);
+            let Some(stats) = RunTimeStats::new(run_time_ns, count, window) else {
+                continue;
+            };
+
+            if let Some(prog_id) = end.prog_id {
+                sample.programs.entry(prog_id).or_insert(stats);
+            }
+
+            sample.slots.push(SlotRunTimeStats {
+                labels: [
+                    KeyValue::new("type", end.kind.to_string()),
+                    KeyValue::new("if_index", end.if_index.to_string()),
+                    KeyValue::new(
+                        "direction",
+                        end.direction.map(|d| d.to_string()).unwrap_or_default(),
+                    ),
+                    // Both revisions of a dispatcher being replaced may be
+                    // sampled in the same window.
+                    KeyValue::new("revision", end.revision.to_string()),
+                    KeyValue::new("slot", end.slot.to_string()),
+                    KeyValue::new(
+                        "prog_id",
+                        end.prog_id.map(|id| id.to_string()).unwrap_or_default(),
+                    ),
+                ],
+                stats,
+            });
+        }
+
+        sample
+    }
+}
+
+/// Enables run time stats for `window` and returns what ran meanwhile.
+pub(crate) async fn sample(window: Duration) -> io::Result<RunTimeSample> {
+    let stats_fd = enable_run_time_stats()?;
+
+    let started = Instant::now();
+    let programs_start = program_counters();
+    let slots_start = list_dispatcher_stats().unwrap_or_default();
+
+    tokio::time::sleep(window).await;
+
+    let programs_end = program_counters();
+    let slots_end = list_dispatcher_stats().unwrap_or_default();
+    let elapsed = started.elapsed();
+    drop(stats_fd);
+
+    Ok(RunTimeSample::new(
+        &programs_start,
+        &programs_end,
+        &slots_start,
+        &slots_end,
+        elapsed,
+    ))
+}
+
+/// Takes a sample every `interval` and stores it in `latest`.
+pub(crate) async fn run(latest: Arc<Mutex<RunTimeSample>>, window: Duration, interval: Duration) {
+    let mut ticker = tokio::time::interval(interval);
+    loop {
+        ticker.tick().await;
+        match sample(window).await {
+            Ok(sample) => *latest.lock().unwrap() = sample,
+            Err(e) => eprintln!("unable to enable BPF run time stats: {e}"),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use bpfman::types::ProgramType;
+
+    use super::*;
+
+    fn slot(slot: u32, prog_id: Option<u32>, count: u64, run_time_ns: u64) -> DispatcherSlotStats {
+        DispatcherSlotStats {
+            kind: ProgramType::Xdp,
+            if_index: 2,
+            direction: None,
+            revision: 1,
+            slot,
+            prog_id,
+            count,
+            run_time_ns,
+            verdicts: vec![],
+            latency: vec![],
+        }
+    }
+
+    #[test]
+    fn test_run_time_sample() {
+        let window = Duration::from_secs(2);
+        let programs_start = HashMap::from([(1, (1000, 10)), (2, (0, 0)), (3, (50, 1))]);
+        // Program 4 was loaded during the window.
+        let programs_end = HashMap::from([(1, (5000, 30)), (2, (0, 0)), (3, (50, 1)), (4, (9, 9))]);
+        let slots_start = [slot(0, Some(2), 100, 10_000)];
+        let slots_end = [slot(0, Some(2), 300, 40_000), slot(1, Some(5), 10, 10)];
+
+        let sample = RunTimeSample::new(
+            &programs_start,
+            &programs_end,
+            &slots_start,
+            &slots_end,
+            window,
+        );
+
+        assert_eq!(
+            sample.programs.get(&1),
+            Some(&RunTimeStats {
+                avg_run_time_ns: 200.0,
+                invocations_per_second: 10.0,
+            })
+        );
+        // Program 2 is the extension in slot 0, which only the dispatcher
+        // accounts.
+        assert_eq!(
+            sample.programs.get(&2),
+            Some(&RunTimeStats {
+                avg_run_time_ns: 150.0,
+                invocations_per_second: 100.0,
+            })
+        );
+        assert!(!sample.programs.contains_key(&3));
+        assert!(!sample.programs.contains_key(&4));
+
+        assert_eq!(sample.slots.len(), 1);
+        assert_eq!(sample.slots[0].labels[3], KeyValue::new("revision", "1"));
+        assert_eq!(sample.slots[0].labels[5], KeyValue::new("prog_id", "2"));
+    }
+}
@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! The few bpf(2) commands the exporter needs that aya doesn't expose.
+
+use std::{
+    fs, io, mem,
+    os::fd::{AsFd, AsRawFd, BorrowedFd, FromRawFd, OwnedFd},
+    time::{Duration, SystemTime},
+};
+
+use nix::libc;
+
+const BPF_MAP_LOOKUP_ELEM: libc::c_long = 1;
+const BPF_MAP_GET_NEXT_KEY: libc::c_long = 4;
+pub(crate) const BPF_PROG_GET_NEXT_ID: libc::c_long = 11;
+pub(crate) const BPF_MAP_GET_NEXT_ID: libc::c_long = 12;
+const BPF_PROG_GET_FD_BY_ID: libc::c_long = 13;
+const BPF_MAP_GET_FD_BY_ID: libc::c_long = 14;
+const BPF_OBJ_GET_INFO_BY_FD: libc::c_long = 15;
+const BPF_MAP_LOOKUP_BATCH: libc::c_long = 24;
+const BPF_LINK_GET_FD_BY_ID: libc::c_long = 30;
+pub(crate) const BPF_LINK_GET_NEXT_ID: libc::c_long = 31;
+const BPF_ENABLE_STATS: libc::c_long = 32;
+
+const BPF_F_RDONLY: u32 = 1 << 3;
+
+const BPF_STATS_RUN_TIME: u32 = 0;
+
+// Calls bpf(2) with `attr` as the command's part of `union bpf_attr`.
+fn bpf<T>(cmd: libc::c_long, attr: &mut T) -> io::Result<libc::c_long> {
+    // SAFETY: callers pass a valid bpf_attr prefix for `cmd`, which outlives
+    // the call.
+    let ret = unsafe { libc::syscall(libc::SYS_bpf, cmd, attr as *mut T, mem::size_of::<T>()) };
+    if ret < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    Ok(ret)
+}
+
+// The part of `union bpf_attr` used by the BPF_*_GET_NEXT_ID commands.
+#[repr(C)]
+#[derive(Default)]
+struct NextIdAttr {
+    start_id: u32,
+    next_id: u32,
+    open_flags: u32,
+}
+
+/// Fills `ids` with the ids of the loaded objects of the kind `cmd` iterates
+/// over, in increasing order.
+pub(crate) fn loaded_ids(cmd: libc::c_long, ids: &mut Vec<u32>) -> io::Result<()> {
+    ids.clear();
+    let mut attr = NextIdAttr::default();
+    loop {
+        if let Err(err) = bpf(cmd, &mut attr) {
+            return match err.raw_os_error() {
+                Some(libc::ENOENT) => Ok(()),
+                _ => Err(err),
+            };
+        }
+        ids.push(attr.next_id);
+        attr.start_id = attr.next_id;
+    }
+}
+
+/// Turns on the kernel's accounting of program run time and run count, which
+/// stays on until the returned file descriptor, and every other one obtained
+/// the same way, is closed.
+pub(crate) fn enable_run_time_stats() -> io::Result<OwnedFd> {
+    let mut attr = BPF_STATS_RUN_TIME;
+    let fd = bpf(BPF_ENABLE_STATS, &mut attr)?;
+    // SAFETY: BPF_ENABLE_STATS returns a new file descriptor we now own.
+    Ok(unsafe { OwnedFd::from_raw_fd(fd as i32) })
+}
+
+#[repr(C)]
+struct ObjInfoAttr {
+    bpf_fd: u32,
+    info_len: u32,
+    info: u64,
+}
+
+// The start of struct bpf_prog_info, up to the run time stats.
+#[repr(C)]
+struct ProgRunStatsInfo {
+    _skipped: [u8; 192],
+    run_time_ns: u64,
+    run_cnt: u64,
+}
+
+/// Returns the total run time, in nanoseconds, and run count the kernel has
+/// accounted to a program while run time stats were enabled.
+pub(crate) fn program_run_stats(fd: BorrowedFd<'_>) -> io::Result<(u64, u64)> {
+    let mut info = ProgRunStatsInfo {
+        _skipped: [0; 192],
+        run_time_ns: 0,
+        run_cnt: 0,
+    };
+    obj_info(fd, &mut info)?;
+    Ok((info.run_time_ns, info.run_cnt))
+}
+
+// The part of `union bpf_attr` used by BPF_MAP_GET_FD_BY_ID.
+#[repr(C)]
+struct GetFdByIdAttr {
+    id: u32,
+    next_id: u32,
+    open_flags: u32,
+}
+
+// Opens the object with the given id with one of the BPF_*_GET_FD_BY_ID
+// commands.
+fn fd_by_id(cmd: libc::c_long, id: u32, open_flags: u32) -> io::Result<OwnedFd> {
+    let mut attr = GetFdByIdAttr {
+        id,
+        next_id: 0,
+        open_flags,
+    };
+    let fd = bpf(cmd, &mut attr)?;
+    // SAFETY: the BPF_*_GET_FD_BY_ID commands return a new file descriptor we
+    // now own.
+    Ok(unsafe { OwnedFd::from_raw_fd(fd as i32) })
+}
+
+/// Opens the map with the given id, read-only.
+pub(crate) fn map_fd_by_id(id: u32) -> io::Result<OwnedFd> {
+    fd_by_id(BPF_MAP_GET_FD_BY_ID, id, BPF_F_RDONLY)
+}
+
+// Fills `info` with the information of the object `fd` refers to.
+fn obj_info<T>(fd: BorrowedFd<'_>, info: &mut T) -> io::Result<()> {
+    let mut attr = ObjInfoAttr {
+        bpf_fd: fd.as_raw_fd() as u32,
+        info_len: mem::size_of::<T>() as u32,
+        info: info as *mut T as u64,
+    };
+    bpf(BPF_OBJ_GET_INFO_BY_FD, &mut attr).map(|_| ())
+}
+
+// struct bpf_prog_info, up to the number of verified instructions.
+#[repr(C)]
+struct BpfProgInfo {
+    prog_type: u32,
+    id: u32,
+    tag: [u8; 8],
+    jited_prog_len: u32,
+    xlated_prog_len: u32,
+    jited_prog_insns: u64,
+    xlated_prog_insns: u64,
+    load_time: u64,
+    created_by_uid: u32,
+    nr_map_ids: u32,
+    map_ids: u64,
+    name: [u8; 16],
+    ifindex: u32,
+    gpl_compatible: u32,
+    _skipped: [u8; 128],
+    verified_insns: u32,
+    _pad: u32,
+}
+
+/// The information the exporter reports about a loaded program.
+pub(crate) struct ProgramDetails {
+    pub(crate) id: u32,
+    pub(crate) program_type: u32,
+    pub(crate) name: String,
+    pub(crate) tag: u64,
+    pub(crate) gpl_compatible: bool,
+    pub(crate) map_ids: Vec<u32>,
+    pub(crate) loaded_at: SystemTime,
+    pub(crate) size_jitted: u32,
+    pub(crate) size_translated: u32,
+    pub(crate) memory_locked: u32,
+    pub(crate) verified_instruction_count: u32,
+}
+
+// Returns the time the system booted at, which program load times are
+// relative to.
+fn boot_time() -> SystemTime {
+    let mut ts = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    // SAFETY: `ts` is a valid timespec for the call to write to.
+    unsafe { libc::clock_gettime(libc::CLOCK_BOOTTIME, &mut ts) };
+    let since_boot = Duration::new(ts.tv_sec as u64, ts.tv_nsec as u32);
+    SystemTime::now() - since_boot
+}
+
+// Returns the memory the kernel accounts to the object `fd` refers to, as
+// reported in its fdinfo.
+fn memlock(fd: BorrowedFd<'_>) -> u32 {
+    fs::read_to_string(format!("/proc/self/fdinfo/{}", fd.as_raw_fd()))
+        .ok()
+        .and_then(|fdinfo| {
+            fdinfo
+                .lines()
+                .find_map(|l| l.strip_prefix("memlock:"))
+                .and_then(|v| v.trim().parse().ok())
+        })
+        .unwrap_or_default()
+}
+
+/// Returns the information of the program with the given id, without going
+/// through every loaded program like aya's loaded_programs does.
+pub(crate) fn program_details_by_id(id: u32) -> io::Result<ProgramDetails> {
+    let fd = fd_by_id(BPF_PROG_GET_FD_BY_ID, id, 0)?;
+    // SAFETY: bpf_prog_info only holds integers, for which zero is valid.
+    let mut info: BpfProgInfo = unsafe { mem::zeroed() };
+    obj_info(fd.as_fd(), &mut info)?;
+
+    // The map ids are only copied out when asked for.
+    let mut map_ids = vec![0u32; info.nr_map_ids as usize];
+    if !map_ids.is_empty() {
+        // SAFETY: as above.
+        let mut with_maps: BpfProgInfo = unsafe { mem::zeroed() };
+        with_maps.nr_map_ids = map_ids.len() as u32;
+        with_maps.map_ids = map_ids.as_mut_ptr() as u64;
+        obj_info(fd.as_fd(), &mut with_maps)?;
+        map_ids.truncate(with_maps.nr_map_ids.min(info.nr_map_ids) as usize);
+    }
+
+    let name_len = info.name.iter().position(|c| *c == 0).unwrap_or(16);
+    Ok(ProgramDetails {
+        id: info.id,
+        program_type: info.prog_type,
+        name: String::from_utf8_lossy(&info.name[..name_len]).into_owned(),
+        tag: u64::from_be_bytes(info.tag),
+        gpl_compatible: info.gpl_compatible & 1 != 0,
+        map_ids,
+        loaded_at: boot_time() + Duration::from_nanos(info.load_time),
+        size_jitted: info.jited_prog_len,
+        size_translated: info.xlated_prog_len,
+        memory_locked: memlock(fd.as_fd()),
+        verified_instruction_count: info.verified_insns,
+    })
+}
+
+/// The start of struct bpf_link_info.
+#[repr(C)]
+#[derive(Default)]
+pub(crate) struct LinkDetails {
+    pub(crate) link_type: u32,
+    pub(crate) id: u32,
+    pub(crate) prog_id: u32,
+}
+
+/// Returns the information of the link with the given id.
+pub(crate) fn link_details_by_id(id: u32) -> io::Result<LinkDetails> {
+    let fd = fd_by_id(BPF_LINK_GET_FD_BY_ID, id, 0)?;
+    let mut info = LinkDetails::default();
+    obj_info(fd.as_fd(), &mut info)?;
+    Ok(info)
+}
+
+// The part of `union bpf_attr` used by BPF_MAP_LOOKUP_ELEM and
+// BPF_MAP_GET_NEXT_KEY.
+#[repr(C)]
+struct MapElemAttr {
+    map_fd: u32,
+    key: u64,
+    value_or_next_key: u64,
+    flags: u64,
+}
+
+/// Looks `key` up in the map and copies its value to `value`.
+pub(crate) fn map_lookup_elem(fd: BorrowedFd<'_>, key: &[u8], value: &mut [u8]) -> io::Result<()> {
+    let mut attr = MapElemAttr {
+        map_fd: fd.as_raw_fd() as u32,
+        key: key.as_ptr() as u64,
+        value_or_next_key: value.as_mut_ptr() as u64,
+        flags: 0,
+    };
+    bpf(BPF_MAP_LOOKUP_ELEM, &mut attr).map(|_| ())
+}
+
+/// Copies the key following `key`, or the first key when `key` is None, to
+/// `next_key`. Returns false once there are no more keys.
+pub(crate) fn map_get_next_key(
+    fd: BorrowedFd<'_>,
+    key: Option<&[u8]>,
+    next_key: &mut [u8],
+) -> io::Result<bool> {
+    let mut attr = MapElemAttr {
+        map_fd: fd.as_raw_fd() as u32,
+        key: key.map_or(0, |k| k.as_ptr() as u64),
+        value_or_next_key: next_key.as_mut_ptr() as u64,
+        flags: 0,
+    };
+    match bpf(BPF_MAP_GET_NEXT_KEY, &mut attr) {
+        Ok(_) => Ok(true),
+        Err(e) if e.raw_os_error() == Some(libc::ENOENT) => Ok(false),
+        Err(e) => Err(e),
+    }
+}
+
+// The part of `union bpf_attr` used by the BPF_MAP_*_BATCH commands.
+#[repr(C)]
+struct MapBatchAttr {
+    in_batch: u64,
+    out_batch: u64,
+    keys: u64,
+    values: u64,
+    count: u32,
+    map_fd: u32,
+    elem_flags: u64,
+    flags: u64,
+}
+
+/// Reads up to `count` entries of the map into `keys` and `values`, starting
+/// after the position `in_batch` was returned for, or at the start of the
+/// map when it is None, and stores the position reached in `out_batch`.
+/// Returns the number of entries read and whether the end of the map was
+/// reached.
+pub(crate) fn map_lookup_batch(
+    fd: BorrowedFd<'_>,
+    in_batch: Option<&[u8]>,
+    out_batch: &mut [u8],
+    keys: &mut [u8],
+    values: &mut [u8],
+    count: u32,
+) -> io::Result<(u32, bool)> {
+    let mut attr = MapBatchAttr {
+        in_batch: in_batch.map_or(0, |b| b.as_ptr() as u64),
+        out_batch: out_batch.as_mut_ptr() as u64,
+        keys: keys.as_mut_ptr() as u64,
+        values: values.as_mut_ptr() as u64,
+        count,
+        map_fd: fd.as_raw_fd() as u32,
+        elem_flags: 0,
+        flags: 0,
+    };
+    match bpf(BPF_MAP_LOOKUP_BATCH, &mut attr) {
+        Ok(_) => Ok((attr.count, false)),
+        Err(e) if e.raw_os_error() == Some(libc::ENOENT) => Ok((attr.count, true)),
+        Err(e) => Err(e),
+    }
+}
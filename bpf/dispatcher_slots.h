@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause)
+// Copyright Authors of bpfman
+
+/* Expands DISPATCHER_SLOT(n) once for every program slot of a dispatcher, i.e.
+ * for n in [0, MAX_DISPATCHER_ACTIONS). Dispatchers include this file twice:
+ * once to define the prog<n>() stubs and once to build the call chain.
+ *
+ * The default build has 10 slots, matching libxdp. xtask also builds the
+ * dispatchers with a larger MAX_DISPATCHER_ACTIONS (up to 64) for interfaces
+ * that need more programs. Since the call chain exits as soon as it runs out
+ * of enabled programs, the extra slots cost nothing for short chains. The XDP
+ * dispatcher is also built with fewer slots, so that interfaces configured
+ * with specialized_dispatcher load the smallest one that fits their chain.
+ *
+ * There is deliberately no include guard.
+ */
+
+#ifndef DISPATCHER_SLOT
+#error "DISPATCHER_SLOT(n) must be defined before including dispatcher_slots.h"
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 64
+#error "MAX_DISPATCHER_ACTIONS must not be greater than 64"
+#endif
+
+
+#if MAX_DISPATCHER_ACTIONS > 0
+DISPATCHER_SLOT(0)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 1
+DISPATCHER_SLOT(1)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 2
+DISPATCHER_SLOT(2)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 3
+DISPATCHER_SLOT(3)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 4
+DISPATCHER_SLOT(4)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 5
+DISPATCHER_SLOT(5)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 6
+DISPATCHER_SLOT(6)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 7
+DISPATCHER_SLOT(7)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 8
+DISPATCHER_SLOT(8)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 9
+DISPATCHER_SLOT(9)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 10
+DISPATCHER_SLOT(10)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 11
+DISPATCHER_SLOT(11)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 12
+DISPATCHER_SLOT(12)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 13
+DISPATCHER_SLOT(13)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 14
+DISPATCHER_SLOT(14)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 15
+DISPATCHER_SLOT(15)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 16
+DISPATCHER_SLOT(16)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 17
+DISPATCHER_SLOT(17)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 18
+DISPATCHER_SLOT(18)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 19
+DISPATCHER_SLOT(19)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 20
+DISPATCHER_SLOT(20)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 21
+DISPATCHER_SLOT(21)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 22
+DISPATCHER_SLOT(22)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 23
+DISPATCHER_SLOT(23)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 24
+DISPATCHER_SLOT(24)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 25
+DISPATCHER_SLOT(25)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 26
+DISPATCHER_SLOT(26)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 27
+DISPATCHER_SLOT(27)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 28
+DISPATCHER_SLOT(28)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 29
+DISPATCHER_SLOT(29)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 30
+DISPATCHER_SLOT(30)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 31
+DISPATCHER_SLOT(31)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 32
+DISPATCHER_SLOT(32)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 33
+DISPATCHER_SLOT(33)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 34
+DISPATCHER_SLOT(34)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 35
+DISPATCHER_SLOT(35)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 36
+DISPATCHER_SLOT(36)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 37
+DISPATCHER_SLOT(37)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 38
+DISPATCHER_SLOT(38)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 39
+DISPATCHER_SLOT(39)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 40
+DISPATCHER_SLOT(40)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 41
+DISPATCHER_SLOT(41)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 42
+DISPATCHER_SLOT(42)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 43
+DISPATCHER_SLOT(43)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 44
+DISPATCHER_SLOT(44)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 45
+DISPATCHER_SLOT(45)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 46
+DISPATCHER_SLOT(46)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 47
+DISPATCHER_SLOT(47)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 48
+DISPATCHER_SLOT(48)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 49
+DISPATCHER_SLOT(49)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 50
+DISPATCHER_SLOT(50)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 51
+DISPATCHER_SLOT(51)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 52
+DISPATCHER_SLOT(52)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 53
+DISPATCHER_SLOT(53)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 54
+DISPATCHER_SLOT(54)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 55
+DISPATCHER_SLOT(55)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 56
+DISPATCHER_SLOT(56)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 57
+DISPATCHER_SLOT(57)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 58
+DISPATCHER_SLOT(58)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 59
+DISPATCHER_SLOT(59)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 60
+DISPATCHER_SLOT(60)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 61
+DISPATCHER_SLOT(61)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 62
+DISPATCHER_SLOT(62)
+#endif
+
+#if MAX_DISPATCHER_ACTIONS > 63
+DISPATCHER_SLOT(63)
+#endif
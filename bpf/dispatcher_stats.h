@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause)
+// Copyright Authors of bpfman
+
+#ifndef __DISPATCHER_STATS_H
+#define __DISPATCHER_STATS_H
+
+/* Optional per-slot instrumentation shared by the XDP and TC dispatchers.
+ *
+ * Collection is controlled by DISPATCHER_FLAG_STATS in the dispatcher's
+ * `dispatcher_flags` global. Like the dispatcher config, that global lives in
+ * rodata and is frozen at load time, so when the flag is clear the verifier
+ * prunes every stats branch and the fast path is identical to the
+ * uninstrumented dispatcher.
+ */
+
+#define DISPATCHER_FLAG_STATS (1U << 0)
+
+/* Number of verdict buckets per slot. The last bucket collects any return
+ * code that does not fit in the others.
+ */
+#define DISPATCHER_MAX_VERDICTS 16
+#define DISPATCHER_VERDICT_OTHER (DISPATCHER_MAX_VERDICTS - 1)
+
+/* Number of log2 latency buckets per slot. Bucket i counts invocations that
+ * took [2^i, 2^(i+1)) ns, bucket 0 also counts anything faster and the last
+ * bucket anything slower.
+ */
+#define DISPATCHER_LATENCY_BUCKETS 24
+
+struct dispatcher_slot_stats {
+  __u64 count;       /* Number of times the slot was invoked */
+  __u64 run_time_ns; /* Cumulative time spent in the slot */
+  __u64 verdicts[DISPATCHER_MAX_VERDICTS];
+  __u64 latency[DISPATCHER_LATENCY_BUCKETS];
+};
+
+static __always_inline __u32 dispatcher_latency_bucket(__u64 delta) {
+  __u32 bucket = 0;
+
+  if (delta >= (1ULL << 16)) {
+    delta >>= 16;
+    bucket += 16;
+  }
+  if (delta >= (1ULL << 8)) {
+    delta >>= 8;
+    bucket += 8;
+  }
+  if (delta >= (1ULL << 4)) {
+    delta >>= 4;
+    bucket += 4;
+  }
+  if (delta >= (1ULL << 2)) {
+    delta >>= 2;
+    bucket += 2;
+  }
+  if (delta >= (1ULL << 1))
+    bucket += 1;
+
+  if (bucket >= DISPATCHER_LATENCY_BUCKETS)
+    bucket = DISPATCHER_LATENCY_BUCKETS - 1;
+  return bucket;
+}
+
+/* Accounts a single invocation of a slot that started at `start` and
+ * returned a verdict counted in `verdict` (already mapped to a bucket).
+ */
+static __always_inline void
+dispatcher_stats_update(struct dispatcher_slot_stats *stats, __u64 start,
+                        __u32 verdict) {
+  __u64 delta = bpf_ktime_get_ns() - start;
+
+  stats->count++;
+  stats->run_time_ns += delta;
+  if (verdict >= DISPATCHER_MAX_VERDICTS)
+    verdict = DISPATCHER_VERDICT_OTHER;
+  stats->verdicts[verdict]++;
+  stats->latency[dispatcher_latency_bucket(delta)]++;
+}
+
+#endif /* __DISPATCHER_STATS_H */
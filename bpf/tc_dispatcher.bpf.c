@@ -7,10 +7,15 @@
 #include <bpf/bpf_endian.h>
 #include <bpf/bpf_helpers.h>
 
+#include "dispatcher_stats.h"
+
 #define TC_METADATA_SECTION "tc_metadata"
 #define TC_DISPATCHER_VERSION 1
 #define TC_DISPATCHER_RETVAL 30
+/* The number of program slots can be overridden at build time. */
+#ifndef MAX_DISPATCHER_ACTIONS
 #define MAX_DISPATCHER_ACTIONS 10
+#endif
 
 struct tc_dispatcher_config {
   __u8 num_progs_enabled;
@@ -19,85 +24,50 @@ struct tc_dispatcher_config {
 };
 volatile const struct tc_dispatcher_config CONFIG = {};
 
-__attribute__((noinline)) int prog0(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog1(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog2(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog3(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
+/* Dispatcher behaviour flags (DISPATCHER_FLAG_*). */
+volatile const __u32 dispatcher_flags = 0;
+
+/* Per-slot stats. There is one TC dispatcher per interface and direction, so
+ * each map accounts a single direction.
+ */
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __type(key, __u32);
+  __type(value, struct dispatcher_slot_stats);
+  __uint(max_entries, MAX_DISPATCHER_ACTIONS);
+} tc_disp_stats SEC(".maps");
+
+static __always_inline __u64 slot_start(void) {
+  if (!(dispatcher_flags & DISPATCHER_FLAG_STATS))
+    return 0;
+  return bpf_ktime_get_ns();
 }
 
-__attribute__((noinline)) int prog4(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
+static __always_inline void slot_record(__u32 slot, __u64 start, int ret) {
+  struct dispatcher_slot_stats *stats;
 
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
+  if (!(dispatcher_flags & DISPATCHER_FLAG_STATS))
+    return;
 
-__attribute__((noinline)) int prog5(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
+  stats = bpf_map_lookup_elem(&tc_disp_stats, &slot);
+  if (!stats)
+    return;
 
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
+  /* Same offset as chain_call_actions, so TC_ACT_UNSPEC (-1) is bucket 0 */
+  dispatcher_stats_update(stats, start,
+                          ret >= -1 ? ret + 1 : DISPATCHER_VERDICT_OTHER);
 }
 
-__attribute__((noinline)) int prog6(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog7(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog8(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
-
-__attribute__((noinline)) int prog9(struct __sk_buff *skb) {
-  volatile int ret = TC_DISPATCHER_RETVAL;
-
-  if (!skb)
-    return TC_ACT_UNSPEC;
-  return ret;
-}
+#define DISPATCHER_SLOT(n)                                                     \
+  __attribute__((noinline)) int prog##n(struct __sk_buff *skb) {               \
+    volatile int ret = TC_DISPATCHER_RETVAL;                                   \
+                                                                               \
+    if (!skb)                                                                  \
+      return TC_ACT_UNSPEC;                                                    \
+    return ret;                                                                \
+  }
+#include "dispatcher_slots.h"
+#undef DISPATCHER_SLOT
 
 __attribute__((noinline)) int compat_test(struct __sk_buff *skb) {
   volatile int ret = TC_DISPATCHER_RETVAL;
@@ -110,72 +80,24 @@ __attribute__((noinline)) int compat_test(struct __sk_buff *skb) {
 SEC("classifier/dispatcher")
 int tc_dispatcher(struct __sk_buff *skb) {
   __u8 num_progs_enabled = CONFIG.num_progs_enabled;
+  __u64 start;
   int ret;
 
-  if (num_progs_enabled < 1)
-    goto out;
-  ret = prog0(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[0]))
-    return ret;
-
-  if (num_progs_enabled < 2)
-    goto out;
-  ret = prog1(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[1]))
-    return ret;
-
-  if (num_progs_enabled < 3)
-    goto out;
-  ret = prog2(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[2]))
-    return ret;
-
-  if (num_progs_enabled < 4)
-    goto out;
-  ret = prog3(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[3]))
-    return ret;
-
-  if (num_progs_enabled < 5)
-    goto out;
-  ret = prog4(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[4]))
-    return ret;
-
-  if (num_progs_enabled < 6)
-    goto out;
-  ret = prog5(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[5]))
-    return ret;
-
-  if (num_progs_enabled < 7)
-    goto out;
-  ret = prog6(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[6]))
-    return ret;
-
-  if (num_progs_enabled < 8)
-    goto out;
-  ret = prog7(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[7]))
-    return ret;
-
-  if (num_progs_enabled < 9)
-    goto out;
-  ret = prog8(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[8]))
-    return ret;
-
-  if (num_progs_enabled < 10)
-    goto out;
-  ret = prog9(skb);
-  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[9]))
+#define DISPATCHER_SLOT(n)                                                     \
+  if (num_progs_enabled < (n) + 1)                                             \
+    goto out;                                                                  \
+  start = slot_start();                                                        \
+  ret = prog##n(skb);                                                          \
+  slot_record(n, start, ret);                                                  \
+  if (!((1U << (ret + 1)) & CONFIG.chain_call_actions[n]))                     \
     return ret;
+#include "dispatcher_slots.h"
+#undef DISPATCHER_SLOT
 
   /* keep a reference to the compat_test() function so we can use it
    * as an freplace target in xdp_multiprog__check_compat() in libxdp
    */
-  if (num_progs_enabled < 11)
+  if (num_progs_enabled < MAX_DISPATCHER_ACTIONS + 1)
     goto out;
   ret = compat_test(skb);
 out:
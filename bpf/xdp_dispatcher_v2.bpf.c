@@ -6,16 +6,40 @@
 
 // clang-format off
 #include <linux/bpf.h>
+#include <linux/if_ether.h>
 #include <linux/in.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
 #include <bpf/bpf_endian.h>
 #include <bpf/bpf_helpers.h>
 // clang-format on
 
+#include "dispatcher_stats.h"
+
 #define XDP_METADATA_SECTION "xdp_metadata"
 #define XDP_DISPATCHER_VERSION 2
 #define XDP_DISPATCHER_MAGIC 236
 #define XDP_DISPATCHER_RETVAL 31
+/* The number of program slots can be overridden at build time. Only the
+ * default of 10 is compatible with libxdp.
+ */
+#ifndef MAX_DISPATCHER_ACTIONS
 #define MAX_DISPATCHER_ACTIONS 10
+#endif
+
+/* Built with DISPATCHER_UNIFORM_ACTIONS for chains where every enabled slot
+ * has the same chain call actions. The actions of slot 0 are then read once
+ * and tested against the return value of every slot, instead of being read
+ * from conf for each slot. bpfman only loads this variant when all the slots
+ * it enables have the actions of slot 0.
+ */
+#ifdef DISPATCHER_UNIFORM_ACTIONS
+#define SLOT_ACTIONS(n) chain_call_actions
+#else
+#define SLOT_ACTIONS(n) conf.chain_call_actions[n]
+#endif
 
 struct xdp_dispatcher_conf {
   __u8 magic;              /* Set to XDP_DISPATCHER_MAGIC */
@@ -41,86 +65,202 @@ struct xdp_dispatcher_conf {
  */
 static volatile const struct xdp_dispatcher_conf conf = {};
 
-__attribute__((noinline)) int prog0(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
-
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+/* Dispatcher behaviour flags (DISPATCHER_FLAG_*). These are kept outside of
+ * xdp_dispatcher_conf so that the conf layout stays compatible with libxdp.
+ */
+static volatile const __u32 dispatcher_flags = 0;
+
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __type(key, __u32);
+  __type(value, struct dispatcher_slot_stats);
+  __uint(max_entries, MAX_DISPATCHER_ACTIONS);
+} xdp_disp_stats SEC(".maps");
+
+static __always_inline __u64 slot_start(void) {
+  if (!(dispatcher_flags & DISPATCHER_FLAG_STATS))
+    return 0;
+  return bpf_ktime_get_ns();
 }
 
-__attribute__((noinline)) int prog1(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+static __always_inline void slot_record(__u32 slot, __u64 start, int ret) {
+  struct dispatcher_slot_stats *stats;
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
-}
+  if (!(dispatcher_flags & DISPATCHER_FLAG_STATS))
+    return;
 
-__attribute__((noinline)) int prog2(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+  stats = bpf_map_lookup_elem(&xdp_disp_stats, &slot);
+  if (!stats)
+    return;
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+  /* XDP verdicts are counted by their return code */
+  dispatcher_stats_update(stats, start,
+                          ret >= 0 ? ret : DISPATCHER_VERDICT_OTHER);
 }
 
-__attribute__((noinline)) int prog3(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
-
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
-}
+/* Verdict cache.
+ *
+ * When DISPATCHER_FLAG_VERDICT_CACHE is set, the dispatcher looks up the flow
+ * of each TCP or UDP packet in xdp_verdict_cache before running any slot, and
+ * returns the cached verdict if there is one that hasn't expired. A program
+ * publishes verdicts when XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT is set in its
+ * program_flags[] entry: when it returns a verdict that ends the chain,
+ * per chain_call_actions, the dispatcher caches it for the flow for
+ * verdict_cache_ttl_ns. Only XDP_PASS and XDP_DROP are cached, since replaying
+ * XDP_TX or XDP_REDIRECT would skip the program's side effects.
+ */
+#define DISPATCHER_FLAG_VERDICT_CACHE (1U << 1)
+#define XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT (1U << 0)
+
+/* Resized at load time, and to a single entry when the cache is off */
+#ifndef VERDICT_CACHE_ENTRIES
+#define VERDICT_CACHE_ENTRIES 16384
+#endif
+
+static volatile const __u64 verdict_cache_ttl_ns = 1000000000ULL;
+
+struct flow_key {
+  __u32 saddr[4];
+  __u32 daddr[4];
+  __u16 sport;
+  __u16 dport;
+  __u8 proto;
+  __u8 pad[3];
+};
 
-__attribute__((noinline)) int prog4(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+struct verdict_cache_entry {
+  __u64 expires_ns;
+  __u32 verdict;
+  __u32 slot; /* Slot that published the verdict */
+};
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+struct {
+  __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+  __type(key, struct flow_key);
+  __type(value, struct verdict_cache_entry);
+  __uint(max_entries, VERDICT_CACHE_ENTRIES);
+} xdp_verdict_cache SEC(".maps");
+
+static __always_inline int parse_ports(void *l4, void *data_end, __u8 proto,
+                                       struct flow_key *key) {
+  if (proto == IPPROTO_TCP) {
+    struct tcphdr *tcp = l4;
+
+    if ((void *)(tcp + 1) > data_end)
+      return -1;
+    key->sport = tcp->source;
+    key->dport = tcp->dest;
+    return 0;
+  }
+  if (proto == IPPROTO_UDP) {
+    struct udphdr *udp = l4;
+
+    if ((void *)(udp + 1) > data_end)
+      return -1;
+    key->sport = udp->source;
+    key->dport = udp->dest;
+    return 0;
+  }
+  return -1;
 }
 
-__attribute__((noinline)) int prog5(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
-
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+/* Fills in the flow key of a TCP or UDP packet over IPv4 or IPv6. Returns -1
+ * for any other packet, which then always goes through the slots.
+ */
+static __always_inline int parse_flow_key(struct xdp_md *ctx,
+                                          struct flow_key *key) {
+  void *data_end = (void *)(long)ctx->data_end;
+  void *data = (void *)(long)ctx->data;
+  struct ethhdr *eth = data;
+
+  if ((void *)(eth + 1) > data_end)
+    return -1;
+
+  __builtin_memset(key, 0, sizeof(*key));
+  if (eth->h_proto == bpf_htons(ETH_P_IP)) {
+    struct iphdr *ip = (void *)(eth + 1);
+
+    if ((void *)(ip + 1) > data_end || ip->ihl < 5)
+      return -1;
+    /* Later fragments don't carry the ports */
+    if (ip->frag_off & bpf_htons(0x1fff))
+      return -1;
+    key->saddr[0] = ip->saddr;
+    key->daddr[0] = ip->daddr;
+    key->proto = ip->protocol;
+    return parse_ports((void *)ip + ip->ihl * 4, data_end, ip->protocol, key);
+  }
+  if (eth->h_proto == bpf_htons(ETH_P_IPV6)) {
+    struct ipv6hdr *ip6 = (void *)(eth + 1);
+
+    if ((void *)(ip6 + 1) > data_end)
+      return -1;
+    __builtin_memcpy(key->saddr, &ip6->saddr, sizeof(key->saddr));
+    __builtin_memcpy(key->daddr, &ip6->daddr, sizeof(key->daddr));
+    key->proto = ip6->nexthdr;
+    return parse_ports(ip6 + 1, data_end, ip6->nexthdr, key);
+  }
+  return -1;
 }
 
-__attribute__((noinline)) int prog6(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+/* Returns the cached verdict of the flow, or -1 if there is none. */
+static __always_inline int verdict_cache_lookup(struct flow_key *key) {
+  struct verdict_cache_entry *entry;
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+  entry = bpf_map_lookup_elem(&xdp_verdict_cache, key);
+  if (!entry || entry->expires_ns < bpf_ktime_get_ns())
+    return -1;
+  return entry->verdict;
 }
 
-__attribute__((noinline)) int prog7(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+static __always_inline void verdict_cache_store(struct flow_key *key,
+                                                __u32 slot, int ret) {
+  struct verdict_cache_entry entry = {};
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+  if (ret != XDP_PASS && ret != XDP_DROP)
+    return;
+  entry.expires_ns = bpf_ktime_get_ns() + verdict_cache_ttl_ns;
+  entry.verdict = ret;
+  entry.slot = slot;
+  bpf_map_update_elem(&xdp_verdict_cache, key, &entry, BPF_ANY);
 }
 
-__attribute__((noinline)) int prog8(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+/* RX queue scoping.
+ *
+ * A program with XDP_DISPATCHER_PROG_FLAG_RX_QUEUES set in its program_flags[]
+ * entry only runs for packets received on the queues set in its
+ * slot_rx_queues[] entry, bit n standing for queue n. Packets received on other
+ * queues go on to the next slot as if the program had returned one of its
+ * chain call actions. Queues from 64 on can't be selected, so a scoped program
+ * never runs for them. Like dispatcher_flags, the masks are kept outside of
+ * xdp_dispatcher_conf so that its layout stays compatible with libxdp.
+ */
+#define XDP_DISPATCHER_PROG_FLAG_RX_QUEUES (1U << 1)
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
-}
+static volatile const __u64 slot_rx_queues[MAX_DISPATCHER_ACTIONS] = {};
 
-__attribute__((noinline)) int prog9(struct xdp_md *ctx) {
-  volatile int ret = XDP_DISPATCHER_RETVAL;
+static __always_inline int slot_runs_on_queue(struct xdp_md *ctx, __u32 slot) {
+  __u32 queue;
 
-  if (!ctx)
-    return XDP_ABORTED;
-  return ret;
+  if (!(conf.program_flags[slot] & XDP_DISPATCHER_PROG_FLAG_RX_QUEUES))
+    return 1;
+  queue = ctx->rx_queue_index;
+  if (queue >= 64)
+    return 0;
+  return (slot_rx_queues[slot] >> queue) & 1;
 }
 
+#define DISPATCHER_SLOT(n)                                                     \
+  __attribute__((noinline)) int prog##n(struct xdp_md *ctx) {                  \
+    volatile int ret = XDP_DISPATCHER_RETVAL;                                  \
+                                                                               \
+    if (!ctx)                                                                  \
+      return XDP_ABORTED;                                                      \
+    return ret;                                                                \
+  }
+#include "dispatcher_slots.h"
+#undef DISPATCHER_SLOT
+
 __attribute__((noinline)) int compat_test(struct xdp_md *ctx) {
   volatile int ret = XDP_DISPATCHER_RETVAL;
 
@@ -129,80 +269,62 @@ __attribute__((noinline)) int compat_test(struct xdp_md *ctx) {
   return ret;
 }
 
-SEC("xdp")
-int xdp_dispatcher(struct xdp_md *ctx) {
+static __always_inline int dispatch(struct xdp_md *ctx) {
   __u8 num_progs_enabled = conf.num_progs_enabled;
+  struct flow_key key;
+  int have_key = 0;
+  __u64 start;
   int ret;
-
-  if (num_progs_enabled < 1)
-    goto out;
-  ret = prog0(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[0]))
-    return ret;
-
-  if (num_progs_enabled < 2)
-    goto out;
-  ret = prog1(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[1]))
-    return ret;
-
-  if (num_progs_enabled < 3)
-    goto out;
-  ret = prog2(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[2]))
-    return ret;
-
-  if (num_progs_enabled < 4)
-    goto out;
-  ret = prog3(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[3]))
-    return ret;
-
-  if (num_progs_enabled < 5)
-    goto out;
-  ret = prog4(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[4]))
-    return ret;
-
-  if (num_progs_enabled < 6)
-    goto out;
-  ret = prog5(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[5]))
-    return ret;
-
-  if (num_progs_enabled < 7)
-    goto out;
-  ret = prog6(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[6]))
-    return ret;
-
-  if (num_progs_enabled < 8)
-    goto out;
-  ret = prog7(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[7]))
-    return ret;
-
-  if (num_progs_enabled < 9)
-    goto out;
-  ret = prog8(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[8]))
-    return ret;
-
-  if (num_progs_enabled < 10)
-    goto out;
-  ret = prog9(ctx);
-  if (!((1U << ret) & conf.chain_call_actions[9]))
-    return ret;
+#ifdef DISPATCHER_UNIFORM_ACTIONS
+  __u32 chain_call_actions = conf.chain_call_actions[0];
+#endif
+
+  if (dispatcher_flags & DISPATCHER_FLAG_VERDICT_CACHE) {
+    have_key = !parse_flow_key(ctx, &key);
+    if (have_key) {
+      ret = verdict_cache_lookup(&key);
+      if (ret >= 0)
+        return ret;
+    }
+  }
+
+#define DISPATCHER_SLOT(n)                                                     \
+  if (num_progs_enabled < (n) + 1)                                             \
+    goto out;                                                                  \
+  if (slot_runs_on_queue(ctx, n)) {                                            \
+    start = slot_start();                                                      \
+    ret = prog##n(ctx);                                                        \
+    slot_record(n, start, ret);                                                \
+    if (!((1U << ret) & SLOT_ACTIONS(n))) {                                    \
+      if (have_key &&                                                          \
+          (conf.program_flags[n] & XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT))    \
+        verdict_cache_store(&key, n, ret);                                     \
+      return ret;                                                              \
+    }                                                                          \
+  }
+#include "dispatcher_slots.h"
+#undef DISPATCHER_SLOT
 
   /* keep a reference to the compat_test() function so we can use it
    * as an freplace target in xdp_multiprog__check_compat() in libxdp
    */
-  if (num_progs_enabled < 11)
+  if (num_progs_enabled < MAX_DISPATCHER_ACTIONS + 1)
     goto out;
   ret = compat_test(ctx);
 out:
   return XDP_PASS;
 }
 
+SEC("xdp")
+int xdp_dispatcher(struct xdp_md *ctx) { return dispatch(ctx); }
+
+/* Same dispatcher, loaded with BPF_F_XDP_HAS_FRAGS so that it can be attached
+ * to interfaces that receive multi-buffer packets (e.g. with a jumbo MTU).
+ * bpfman only uses it when every attached program supports frags, and sets
+ * conf.is_xdp_frags accordingly.
+ */
+SEC("xdp.frags")
+int xdp_dispatcher_frags(struct xdp_md *ctx) { return dispatch(ctx); }
+
 char _license[] SEC("license") = "GPL";
 __uint(dispatcher_version, XDP_DISPATCHER_VERSION) SEC(XDP_METADATA_SECTION);
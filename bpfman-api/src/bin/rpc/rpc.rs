@@ -1,7 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 use bpfman::{
-    add_program, get_program, list_programs, pull_bytecode, remove_program,
+    add_program, add_program_to_interfaces, get_program, list_programs, pull_bytecode,
+    remove_program,
     types::{
         FentryProgram, FexitProgram, KprobeProgram, ListFilter, Location, Program, ProgramData,
         TcProceedOn, TcProgram, TracepointProgram, UprobeProgram, XdpProceedOn, XdpProgram,
@@ -9,10 +10,11 @@ use bpfman::{
 };
 use bpfman_api::v1::{
     attach_info::Info, bpfman_server::Bpfman, bytecode_location::Location as RpcLocation,
-    list_response::ListResult, FentryAttachInfo, FexitAttachInfo, GetRequest, GetResponse,
-    KprobeAttachInfo, ListRequest, ListResponse, LoadRequest, LoadResponse, PullBytecodeRequest,
-    PullBytecodeResponse, TcAttachInfo, TracepointAttachInfo, UnloadRequest, UnloadResponse,
-    UprobeAttachInfo, XdpAttachInfo,
+    list_response::ListResult, BatchLoadRequest, BatchLoadResponse, BatchLoadResult,
+    FentryAttachInfo, FexitAttachInfo, GetRequest, GetResponse, KernelProgramInfo,
+    KprobeAttachInfo, ListRequest, ListResponse, LoadRequest, LoadResponse, ProgramInfo,
+    PullBytecodeRequest, PullBytecodeResponse, TcAttachInfo, TracepointAttachInfo, UnloadRequest,
+    UnloadResponse, UprobeAttachInfo, XdpAttachInfo,
 };
 use tonic::{Request, Response, Status};
 
@@ -24,106 +26,150 @@ impl BpfmanLoader {
     }
 }
 
-#[tonic::async_trait]
-impl Bpfman for BpfmanLoader {
-    async fn load(&self, request: Request<LoadRequest>) -> Result<Response<LoadResponse>, Status> {
-        let request = request.into_inner();
+fn program_from_request(request: LoadRequest) -> Result<Program, Status> {
+    let bytecode_source = match request
+        .bytecode
+        .ok_or(Status::aborted("missing bytecode info"))?
+        .location
+        .ok_or(Status::aborted("missing location"))?
+    {
+        RpcLocation::Image(i) => Location::Image(i.into()),
+        RpcLocation::File(p) => Location::File(p),
+    };
 
-        let bytecode_source = match request
-            .bytecode
-            .ok_or(Status::aborted("missing bytecode info"))?
-            .location
-            .ok_or(Status::aborted("missing location"))?
-        {
-            RpcLocation::Image(i) => Location::Image(i.into()),
-            RpcLocation::File(p) => Location::File(p),
-        };
+    let data = ProgramData::new(
+        bytecode_source,
+        request.name,
+        request.metadata,
+        request.global_data,
+        request.map_owner_id,
+        request.share_maps,
+    )
+    .map_err(|e| Status::aborted(format!("failed to create ProgramData: {e}")))?;
 
-        let data = ProgramData::new(
-            bytecode_source,
-            request.name,
-            request.metadata,
-            request.global_data,
-            request.map_owner_id,
-        )
-        .map_err(|e| Status::aborted(format!("failed to create ProgramData: {e}")))?;
-
-        let program = match request
-            .attach
-            .ok_or(Status::aborted("missing attach info"))?
-            .info
-            .ok_or(Status::aborted("missing info"))?
-        {
-            Info::XdpAttachInfo(XdpAttachInfo {
+    let program = match request
+        .attach
+        .ok_or(Status::aborted("missing attach info"))?
+        .info
+        .ok_or(Status::aborted("missing info"))?
+    {
+        Info::XdpAttachInfo(XdpAttachInfo {
+            priority,
+            iface,
+            position: _,
+            proceed_on,
+            cache_verdict,
+            rx_queues,
+        }) => Program::Xdp(
+            XdpProgram::new(
+                data,
                 priority,
                 iface,
-                position: _,
-                proceed_on,
-            }) => Program::Xdp(
-                XdpProgram::new(
+                XdpProceedOn::from_int32s(proceed_on)
+                    .map_err(|_| Status::aborted("failed to parse proceed_on"))?,
+                cache_verdict,
+                rx_queues,
+            )
+            .map_err(|e| Status::aborted(format!("failed to create xdpprogram: {e}")))?,
+        ),
+        Info::TcAttachInfo(TcAttachInfo {
+            priority,
+            iface,
+            position: _,
+            direction,
+            proceed_on,
+        }) => {
+            let direction = direction
+                .try_into()
+                .map_err(|_| Status::aborted("direction is not a string"))?;
+            Program::Tc(
+                TcProgram::new(
                     data,
                     priority,
                     iface,
-                    XdpProceedOn::from_int32s(proceed_on)
+                    TcProceedOn::from_int32s(proceed_on)
                         .map_err(|_| Status::aborted("failed to parse proceed_on"))?,
+                    direction,
                 )
-                .map_err(|e| Status::aborted(format!("failed to create xdpprogram: {e}")))?,
-            ),
-            Info::TcAttachInfo(TcAttachInfo {
-                priority,
+                .map_err(|e| Status::aborted(format!("failed to create tcprogram: {e}")))?,
+            )
+        }
+        Info::TracepointAttachInfo(TracepointAttachInfo { tracepoint }) => Program::Tracepoint(
+            TracepointProgram::new(data, tracepoint)
+                .map_err(|e| Status::aborted(format!("failed to create tcprogram: {e}")))?,
+        ),
+        Info::KprobeAttachInfo(KprobeAttachInfo {
+            fn_name,
+            offset,
+            retprobe,
+            container_pid,
+        }) => Program::Kprobe(
+            KprobeProgram::new(data, fn_name, offset, retprobe, container_pid)
+                .map_err(|e| Status::aborted(format!("failed to create kprobeprogram: {e}")))?,
+        ),
+        Info::UprobeAttachInfo(UprobeAttachInfo {
+            fn_name,
+            offset,
+            target,
+            retprobe,
+            pid,
+            container_pid,
+        }) => Program::Uprobe(
+            UprobeProgram::new(data, fn_name, offset, target, retprobe, pid, container_pid)
+                .map_err(|e| Status::aborted(format!("failed to create uprobeprogram: {e}")))?,
+        ),
+        Info::FentryAttachInfo(FentryAttachInfo { fn_name }) => Program::Fentry(
+            FentryProgram::new(data, fn_name)
+                .map_err(|e| Status::aborted(format!("failed to create fentryprogram: {e}")))?,
+        ),
+        Info::FexitAttachInfo(FexitAttachInfo { fn_name }) => Program::Fexit(
+            FexitProgram::new(data, fn_name)
+                .map_err(|e| Status::aborted(format!("failed to create fexitprogram: {e}")))?,
+        ),
+    };
+
+    Ok(program)
+}
+
+// Builds the result of a program a batch load attached to an interface. The
+// program is loaded either way, so a conversion error only fails its own
+// result, and tells the id the program can be unloaded with.
+fn batch_load_result(iface: String, program: &Program) -> BatchLoadResult {
+    let converted = ProgramInfo::try_from(program)
+        .map_err(|e| format!("convert Program to GRPC program: {e}"))
+        .and_then(|info| {
+            KernelProgramInfo::try_from(program)
+                .map(|kernel_info| (info, kernel_info))
+                .map_err(|e| format!("convert Program to GRPC kernel program info: {e}"))
+        });
+    match converted {
+        Ok((info, kernel_info)) => BatchLoadResult {
+            iface,
+            info: Some(info),
+            kernel_info: Some(kernel_info),
+            error: None,
+        },
+        Err(e) => {
+            let error = match program.get_data().get_id() {
+                Ok(id) => format!("program {id} was loaded, but failed to {e}"),
+                Err(_) => format!("failed to {e}"),
+            };
+            BatchLoadResult {
                 iface,
-                position: _,
-                direction,
-                proceed_on,
-            }) => {
-                let direction = direction
-                    .try_into()
-                    .map_err(|_| Status::aborted("direction is not a string"))?;
-                Program::Tc(
-                    TcProgram::new(
-                        data,
-                        priority,
-                        iface,
-                        TcProceedOn::from_int32s(proceed_on)
-                            .map_err(|_| Status::aborted("failed to parse proceed_on"))?,
-                        direction,
-                    )
-                    .map_err(|e| Status::aborted(format!("failed to create tcprogram: {e}")))?,
-                )
+                info: None,
+                kernel_info: None,
+                error: Some(error),
             }
-            Info::TracepointAttachInfo(TracepointAttachInfo { tracepoint }) => Program::Tracepoint(
-                TracepointProgram::new(data, tracepoint)
-                    .map_err(|e| Status::aborted(format!("failed to create tcprogram: {e}")))?,
-            ),
-            Info::KprobeAttachInfo(KprobeAttachInfo {
-                fn_name,
-                offset,
-                retprobe,
-                container_pid,
-            }) => Program::Kprobe(
-                KprobeProgram::new(data, fn_name, offset, retprobe, container_pid)
-                    .map_err(|e| Status::aborted(format!("failed to create kprobeprogram: {e}")))?,
-            ),
-            Info::UprobeAttachInfo(UprobeAttachInfo {
-                fn_name,
-                offset,
-                target,
-                retprobe,
-                pid,
-                container_pid,
-            }) => Program::Uprobe(
-                UprobeProgram::new(data, fn_name, offset, target, retprobe, pid, container_pid)
-                    .map_err(|e| Status::aborted(format!("failed to create uprobeprogram: {e}")))?,
-            ),
-            Info::FentryAttachInfo(FentryAttachInfo { fn_name }) => Program::Fentry(
-                FentryProgram::new(data, fn_name)
-                    .map_err(|e| Status::aborted(format!("failed to create fentryprogram: {e}")))?,
-            ),
-            Info::FexitAttachInfo(FexitAttachInfo { fn_name }) => Program::Fexit(
-                FexitProgram::new(data, fn_name)
-                    .map_err(|e| Status::aborted(format!("failed to create fexitprogram: {e}")))?,
-            ),
-        };
+        }
+    }
+}
+
+#[tonic::async_trait]
+impl Bpfman for BpfmanLoader {
+    async fn load(&self, request: Request<LoadRequest>) -> Result<Response<LoadResponse>, Status> {
+        let request = request.into_inner();
+
+        let program = program_from_request(request)?;
 
         let program = add_program(program)
             .await
@@ -142,6 +188,35 @@ impl Bpfman for BpfmanLoader {
         Ok(Response::new(reply_entry))
     }
 
+    async fn batch_load(
+        &self,
+        request: Request<BatchLoadRequest>,
+    ) -> Result<Response<BatchLoadResponse>, Status> {
+        let request = request.into_inner();
+
+        let program =
+            program_from_request(request.program.ok_or(Status::aborted("missing program"))?)?;
+
+        let mut reply = BatchLoadResponse { results: vec![] };
+        for (iface, result) in add_program_to_interfaces(program, request.ifaces)
+            .await
+            .map_err(|e| Status::aborted(format!("{e}")))?
+        {
+            let reply_entry = match result {
+                Ok(program) => batch_load_result(iface, &program),
+                Err(e) => BatchLoadResult {
+                    iface,
+                    info: None,
+                    kernel_info: None,
+                    error: Some(format!("{e}")),
+                },
+            };
+            reply.results.push(reply_entry)
+        }
+
+        Ok(Response::new(reply))
+    }
+
     async fn unload(
         &self,
         request: Request<UnloadRequest>,
@@ -29,6 +29,11 @@ pub async fn serve(csi_support: bool, timeout: u64, socket_path: &Path) -> anyho
     let shutdown_rx3 = shutdown_tx.subscribe();
     let shutdown_handle = tokio::spawn(shutdown_handler(timeout, shutdown_tx));
 
+    // Load the state of earlier runs before taking requests.
+    if let Err(e) = bpfman::recover_state().await {
+        error!("Unable to recover bpfman state: {e}");
+    }
+
     let loader = BpfmanLoader::new();
     let service = BpfmanServer::new(loader);
 
@@ -37,6 +42,13 @@ pub async fn serve(csi_support: bool, timeout: u64, socket_path: &Path) -> anyho
     let handle = serve_unix(socket_path, service.clone(), shutdown_rx1).await?;
     listeners.push(handle);
 
+    // Only logs what is wrong, so it doesn't have to hold up requests.
+    tokio::spawn(async {
+        if let Err(e) = bpfman::check_state().await {
+            error!("Unable to check bpfman state: {e}");
+        }
+    });
+
     if csi_support {
         let storage_manager = StorageManager::new();
         let storage_manager_handle =
@@ -88,6 +88,14 @@ pub struct ProgramInfo {
         ::prost::alloc::string::String,
         ::prost::alloc::string::String,
     >,
+    #[prost(bool, tag = "9")]
+    pub share_maps: bool,
+    /// Estimated kernel memory of the maps the program uses, and the share
+    /// of it accounted to the program when other programs use them too.
+    #[prost(uint64, tag = "10")]
+    pub map_bytes: u64,
+    #[prost(uint64, tag = "11")]
+    pub map_bytes_share: u64,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -100,6 +108,10 @@ pub struct XdpAttachInfo {
     pub position: i32,
     #[prost(int32, repeated, tag = "4")]
     pub proceed_on: ::prost::alloc::vec::Vec<i32>,
+    #[prost(bool, tag = "5")]
+    pub cache_verdict: bool,
+    #[prost(uint32, repeated, tag = "6")]
+    pub rx_queues: ::prost::alloc::vec::Vec<u32>,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -213,6 +225,8 @@ pub struct LoadRequest {
     pub uuid: ::core::option::Option<::prost::alloc::string::String>,
     #[prost(uint32, optional, tag = "8")]
     pub map_owner_id: ::core::option::Option<u32>,
+    #[prost(bool, tag = "9")]
+    pub share_maps: bool,
 }
 #[allow(clippy::derive_partial_eq_without_eq)]
 #[derive(Clone, PartialEq, ::prost::Message)]
@@ -284,6 +298,41 @@ pub struct GetResponse {
     #[prost(message, optional, tag = "2")]
     pub kernel_info: ::core::option::Option<KernelProgramInfo>,
 }
+/// BatchLoadRequest represents a request to load one XDP or TC program and
+/// attach a copy of it to each of the given network interfaces. The iface set
+/// in the program's attach info is ignored. The bytecode is only fetched once
+/// and the interfaces are handled in parallel.
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct BatchLoadRequest {
+    #[prost(message, optional, tag = "1")]
+    pub program: ::core::option::Option<LoadRequest>,
+    #[prost(string, repeated, tag = "2")]
+    pub ifaces: ::prost::alloc::vec::Vec<::prost::alloc::string::String>,
+}
+/// BatchLoadResult represents the outcome of attaching the program of a
+/// BatchLoadRequest to a single interface. Either the program's info and
+/// kernel info or an error are set.
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct BatchLoadResult {
+    #[prost(string, tag = "1")]
+    pub iface: ::prost::alloc::string::String,
+    #[prost(message, optional, tag = "2")]
+    pub info: ::core::option::Option<ProgramInfo>,
+    #[prost(message, optional, tag = "3")]
+    pub kernel_info: ::core::option::Option<KernelProgramInfo>,
+    #[prost(string, optional, tag = "4")]
+    pub error: ::core::option::Option<::prost::alloc::string::String>,
+}
+/// BatchLoadResponse contains one BatchLoadResult per interface of the
+/// BatchLoadRequest, in the same order.
+#[allow(clippy::derive_partial_eq_without_eq)]
+#[derive(Clone, PartialEq, ::prost::Message)]
+pub struct BatchLoadResponse {
+    #[prost(message, repeated, tag = "1")]
+    pub results: ::prost::alloc::vec::Vec<BatchLoadResult>,
+}
 /// Generated client implementations.
 pub mod bpfman_client {
     #![allow(unused_variables, dead_code, missing_docs, clippy::let_unit_value)]
@@ -459,6 +508,31 @@ pub mod bpfman_client {
             req.extensions_mut().insert(GrpcMethod::new("bpfman.v1.Bpfman", "Get"));
             self.inner.unary(req, path, codec).await
         }
+        pub async fn batch_load(
+            &mut self,
+            request: impl tonic::IntoRequest<super::BatchLoadRequest>,
+        ) -> std::result::Result<
+            tonic::Response<super::BatchLoadResponse>,
+            tonic::Status,
+        > {
+            self.inner
+                .ready()
+                .await
+                .map_err(|e| {
+                    tonic::Status::new(
+                        tonic::Code::Unknown,
+                        format!("Service was not ready: {}", e.into()),
+                    )
+                })?;
+            let codec = tonic::codec::ProstCodec::default();
+            let path = http::uri::PathAndQuery::from_static(
+                "/bpfman.v1.Bpfman/BatchLoad",
+            );
+            let mut req = request.into_request();
+            req.extensions_mut()
+                .insert(GrpcMethod::new("bpfman.v1.Bpfman", "BatchLoad"));
+            self.inner.unary(req, path, codec).await
+        }
     }
 }
 /// Generated server implementations.
@@ -491,6 +565,13 @@ pub mod bpfman_server {
             &self,
             request: tonic::Request<super::GetRequest>,
         ) -> std::result::Result<tonic::Response<super::GetResponse>, tonic::Status>;
+        async fn batch_load(
+            &self,
+            request: tonic::Request<super::BatchLoadRequest>,
+        ) -> std::result::Result<
+            tonic::Response<super::BatchLoadResponse>,
+            tonic::Status,
+        >;
     }
     #[derive(Debug)]
     pub struct BpfmanServer<T: Bpfman> {
@@ -793,6 +874,52 @@ pub mod bpfman_server {
                     };
                     Box::pin(fut)
                 }
+                "/bpfman.v1.Bpfman/BatchLoad" => {
+                    #[allow(non_camel_case_types)]
+                    struct BatchLoadSvc<T: Bpfman>(pub Arc<T>);
+                    impl<
+                        T: Bpfman,
+                    > tonic::server::UnaryService<super::BatchLoadRequest>
+                    for BatchLoadSvc<T> {
+                        type Response = super::BatchLoadResponse;
+                        type Future = BoxFuture<
+                            tonic::Response<Self::Response>,
+                            tonic::Status,
+                        >;
+                        fn call(
+                            &mut self,
+                            request: tonic::Request<super::BatchLoadRequest>,
+                        ) -> Self::Future {
+                            let inner = Arc::clone(&self.0);
+                            let fut = async move {
+                                <T as Bpfman>::batch_load(&inner, request).await
+                            };
+                            Box::pin(fut)
+                        }
+                    }
+                    let accept_compression_encodings = self.accept_compression_encodings;
+                    let send_compression_encodings = self.send_compression_encodings;
+                    let max_decoding_message_size = self.max_decoding_message_size;
+                    let max_encoding_message_size = self.max_encoding_message_size;
+                    let inner = self.inner.clone();
+                    let fut = async move {
+                        let inner = inner.0;
+                        let method = BatchLoadSvc(inner);
+                        let codec = tonic::codec::ProstCodec::default();
+                        let mut grpc = tonic::server::Grpc::new(codec)
+                            .apply_compression_config(
+                                accept_compression_encodings,
+                                send_compression_encodings,
+                            )
+                            .apply_max_message_size_config(
+                                max_decoding_message_size,
+                                max_encoding_message_size,
+                            );
+                        let res = grpc.unary(method, req).await;
+                        Ok(res)
+                    };
+                    Box::pin(fut)
+                }
                 _ => {
                     Box::pin(async move {
                         Ok(
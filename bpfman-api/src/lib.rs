@@ -49,6 +49,8 @@ impl TryFrom<&Program> for ProgramInfo {
                     iface: p.get_iface()?.to_string(),
                     position: p.get_current_position()?.unwrap_or(0) as i32,
                     proceed_on: p.get_proceed_on()?.as_action_vec(),
+                    cache_verdict: p.get_cache_verdict()?,
+                    rx_queues: p.get_rx_queues()?,
                 })),
                 Program::Tc(p) => Some(Info::TcAttachInfo(TcAttachInfo {
                     priority: p.get_priority()?,
@@ -100,6 +102,9 @@ impl TryFrom<&Program> for ProgramInfo {
                 .map(|m| m.to_string())
                 .collect(),
             metadata: data.get_metadata()?,
+            share_maps: data.get_share_maps()?,
+            map_bytes: data.get_map_bytes()?,
+            map_bytes_share: data.get_map_bytes_share()?,
         })
     }
 }
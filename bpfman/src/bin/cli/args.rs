@@ -77,6 +77,13 @@ pub(crate) struct LoadFileArgs {
     #[clap(long, verbatim_doc_comment)]
     pub(crate) map_owner_id: Option<u32>,
 
+    /// Optional: Use the maps of a program already loaded from the same bytecode with
+    /// --share-maps, if there is one, instead of creating new maps. The first program
+    /// loaded from a bytecode with --share-maps owns the maps of the others.
+    /// Ignored if --map-owner-id is given.
+    #[clap(long, verbatim_doc_comment)]
+    pub(crate) share_maps: bool,
+
     #[clap(subcommand)]
     pub(crate) command: LoadCommands,
 }
@@ -117,6 +124,13 @@ pub(crate) struct LoadImageArgs {
     #[clap(long, verbatim_doc_comment)]
     pub(crate) map_owner_id: Option<u32>,
 
+    /// Optional: Use the maps of a program already loaded from the same bytecode with
+    /// --share-maps, if there is one, instead of creating new maps. The first program
+    /// loaded from a bytecode with --share-maps owns the maps of the others.
+    /// Ignored if --map-owner-id is given.
+    #[clap(long, verbatim_doc_comment)]
+    pub(crate) share_maps: bool,
+
     #[clap(subcommand)]
     pub(crate) command: LoadCommands,
 }
@@ -150,6 +164,21 @@ pub(crate) enum LoadCommands {
         /// [default: pass, dispatcher_return]
         #[clap(long, verbatim_doc_comment, num_args(1..))]
         proceed_on: Vec<String>,
+
+        /// Optional: Cache the pass and drop verdicts of this program that end the
+        /// chain per flow, so that later packets of the same flow skip the chain.
+        /// Only for programs whose verdict depends on the flow alone.
+        #[clap(long)]
+        cache_verdict: bool,
+
+        /// Optional: Only run the program for packets received on these RX queues.
+        /// Queues from 64 on can't be selected.
+        /// Multiple values supported by repeating the parameter.
+        /// Example: --rx-queues 0 --rx-queues 1
+        ///
+        /// [default: all queues]
+        #[clap(long, verbatim_doc_comment, num_args(1..))]
+        rx_queues: Vec<u32>,
     },
     #[command(disable_version_flag = true)]
     /// Install an eBPF program on the TC hook point for a given interface.
@@ -40,6 +40,7 @@ pub(crate) async fn execute_load_file(args: &LoadFileArgs) -> anyhow::Result<()>
             .collect(),
         parse_global(&args.global),
         args.map_owner_id,
+        args.share_maps,
     )?;
 
     let program = add_program(args.command.get_program(data)?).await?;
@@ -63,6 +64,7 @@ pub(crate) async fn execute_load_image(args: &LoadImageArgs) -> anyhow::Result<(
             .collect(),
         parse_global(&args.global),
         args.map_owner_id,
+        args.share_maps,
     )?;
 
     let program = add_program(args.command.get_program(data)?).await?;
@@ -79,6 +81,8 @@ impl LoadCommands {
                 iface,
                 priority,
                 proceed_on,
+                cache_verdict,
+                rx_queues,
             } => {
                 let proc_on = match XdpProceedOn::from_strings(proceed_on) {
                     Ok(p) => p,
@@ -89,6 +93,8 @@ impl LoadCommands {
                     *priority,
                     iface.to_string(),
                     XdpProceedOn::from_int32s(proc_on.as_action_vec())?,
+                    *cache_verdict,
+                    rx_queues.clone(),
                 )?))
             }
             LoadCommands::Tc {
@@ -86,6 +86,18 @@ impl ProgTable {
             None => table.add_row(vec!["Map Owner ID:", "None"]),
         };
 
+        if data.get_share_maps()? {
+            table.add_row(vec!["Share Maps:", "true"]);
+        }
+        table.add_row(vec![
+            "Map Memory:",
+            &format!(
+                "{} bytes ({} bytes share)",
+                data.get_map_bytes()?,
+                data.get_map_bytes_share()?
+            ),
+        ]);
+
         let map_used_by = data.get_maps_used_by()?;
         if map_used_by.is_empty() {
             table.add_row(vec!["Maps Used By:", "None"]);
@@ -113,6 +125,13 @@ impl ProgTable {
                     },
                 ]);
                 table.add_row(vec!["Proceed On:", &format!("{}", p.get_proceed_on()?)]);
+                if p.get_cache_verdict()? {
+                    table.add_row(vec!["Cache Verdict:", "true"]);
+                }
+                let rx_queues = p.get_rx_queues()?;
+                if !rx_queues.is_empty() {
+                    table.add_row(vec!["RX Queues:", &format!("{rx_queues:?}")]);
+                }
             }
             Program::Tc(p) => {
                 table.add_row(vec!["Priority:", &p.get_priority()?.to_string()]);
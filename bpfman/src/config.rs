@@ -1,19 +1,28 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::{collections::HashMap, str::FromStr};
+use std::{collections::HashMap, str::FromStr, time::Duration};
 
 use aya::programs::XdpFlags;
 use serde::{Deserialize, Serialize};
 
 use crate::errors::ParseError;
 
+/// Default lifetime of the verdicts cached by an XDP dispatcher.
+pub(crate) const DEFAULT_VERDICT_CACHE_TTL_MS: u64 = 1000;
+/// Default number of flows, per CPU, an XDP dispatcher caches verdicts for.
+pub(crate) const DEFAULT_VERDICT_CACHE_ENTRIES: u32 = 16384;
+/// Default number of seconds a successful image signature verification is
+/// trusted for.
+pub(crate) const DEFAULT_VERIFICATION_CACHE_TTL_SECS: u64 = 3600;
+
 #[derive(Debug, Deserialize, Default, Clone)]
 pub(crate) struct Config {
     interfaces: Option<HashMap<String, InterfaceConfig>>,
     #[serde(default)]
     signing: Option<SigningConfig>,
     database: Option<DatabaseConfig>,
+    map_memory: Option<MapMemoryConfig>,
 }
 
 impl Config {
@@ -28,10 +37,26 @@ impl Config {
     pub(crate) fn database(&self) -> &Option<DatabaseConfig> {
         &self.database
     }
+
+    pub(crate) fn map_memory(&self) -> &Option<MapMemoryConfig> {
+        &self.map_memory
+    }
 }
 #[derive(Debug, Deserialize, Clone)]
 pub struct SigningConfig {
     pub allow_unsigned: bool,
+    // How long, in seconds, a successful verification of an image digest is
+    // reused for instead of verifying it again. Zero disables the cache.
+    pub verification_cache_ttl_secs: Option<u64>,
+}
+
+impl SigningConfig {
+    pub(crate) fn verification_cache_ttl(&self) -> Duration {
+        Duration::from_secs(
+            self.verification_cache_ttl_secs
+                .unwrap_or(DEFAULT_VERIFICATION_CACHE_TTL_SECS),
+        )
+    }
 }
 
 impl Default for SigningConfig {
@@ -39,6 +64,7 @@ impl Default for SigningConfig {
         Self {
             // Allow unsigned programs by default
             allow_unsigned: true,
+            verification_cache_ttl_secs: None,
         }
     }
 }
@@ -60,6 +86,29 @@ impl Default for DatabaseConfig {
     }
 }
 
+#[derive(Debug, Deserialize, Default, Clone)]
+pub struct MapMemoryConfig {
+    // Most bytes of kernel memory the maps of all the programs bpfman loads
+    // may take. No limit if unset.
+    pub node_budget_bytes: Option<u64>,
+    // Programs whose metadata has the same value for this key are in the same
+    // namespace, and their maps may take at most namespace_budget_bytes.
+    // Programs without the key aren't in any namespace.
+    pub namespace_metadata_key: Option<String>,
+    pub namespace_budget_bytes: Option<u64>,
+}
+
+impl MapMemoryConfig {
+    /// Returns the namespace of a program, given its metadata, if namespaces
+    /// have a budget.
+    pub(crate) fn namespace<'a>(&self, metadata: &'a HashMap<String, String>) -> Option<&'a str> {
+        self.namespace_budget_bytes?;
+        metadata
+            .get(self.namespace_metadata_key.as_ref()?)
+            .map(String::as_str)
+    }
+}
+
 impl FromStr for Config {
     type Err = ParseError;
 
@@ -71,12 +120,60 @@ impl FromStr for Config {
 #[derive(Debug, Deserialize, Copy, Clone)]
 pub(crate) struct InterfaceConfig {
     xdp_mode: XdpMode,
+    // Load the dispatchers on this interface with per-slot stats collection
+    // enabled. Off by default, as it adds per-packet overhead.
+    #[serde(default)]
+    collect_stats: bool,
+    // Use a dispatcher with a single slot while only one XDP program is
+    // attached to this interface.
+    #[serde(default)]
+    single_slot_dispatcher: bool,
+    // Load the smallest XDP dispatcher that fits the programs attached to
+    // this interface, and the variant for chains whose programs all have the
+    // same proceed-on actions where possible.
+    #[serde(default)]
+    specialized_dispatcher: bool,
+    // Number of extra, empty, slots to enable when loading a dispatcher on
+    // this interface. Programs added into a spare slot are attached to the
+    // running dispatcher instead of loading a new one.
+    #[serde(default)]
+    spare_dispatcher_slots: usize,
+    // How long, and for how many flows, the XDP dispatcher on this interface
+    // caches the verdicts of programs loaded with cache_verdict set.
+    verdict_cache_ttl_ms: Option<u64>,
+    verdict_cache_entries: Option<u32>,
 }
 
 impl InterfaceConfig {
     pub(crate) fn xdp_mode(&self) -> &XdpMode {
         &self.xdp_mode
     }
+
+    pub(crate) fn collect_stats(&self) -> bool {
+        self.collect_stats
+    }
+
+    pub(crate) fn single_slot_dispatcher(&self) -> bool {
+        self.single_slot_dispatcher
+    }
+
+    pub(crate) fn specialized_dispatcher(&self) -> bool {
+        self.specialized_dispatcher
+    }
+
+    pub(crate) fn spare_dispatcher_slots(&self) -> usize {
+        self.spare_dispatcher_slots
+    }
+
+    pub(crate) fn verdict_cache_ttl_ms(&self) -> u64 {
+        self.verdict_cache_ttl_ms
+            .unwrap_or(DEFAULT_VERDICT_CACHE_TTL_MS)
+    }
+
+    pub(crate) fn verdict_cache_entries(&self) -> u32 {
+        self.verdict_cache_entries
+            .unwrap_or(DEFAULT_VERDICT_CACHE_ENTRIES)
+    }
 }
 
 #[derive(Debug, Serialize, Deserialize, Copy, Clone, PartialEq, Eq)]
@@ -173,4 +270,61 @@ mod test {
             None => panic!("expected interfaces to be present"),
         }
     }
+
+    #[test]
+    fn test_config_iface_dispatcher_options() {
+        let input = r#"
+        [interfaces]
+          [interfaces.eth0]
+          xdp_mode = "drv"
+          collect_stats = true
+          [interfaces.eth1]
+          xdp_mode = "hw"
+          single_slot_dispatcher = true
+          specialized_dispatcher = true
+          spare_dispatcher_slots = 4
+          verdict_cache_ttl_ms = 250
+        "#;
+        let config: Config = toml::from_str(input).expect("error parsing toml input");
+        match config.interfaces {
+            Some(i) => {
+                assert!(i.get("eth0").unwrap().collect_stats());
+                assert!(!i.get("eth0").unwrap().single_slot_dispatcher());
+                assert!(!i.get("eth1").unwrap().collect_stats());
+                assert!(i.get("eth1").unwrap().single_slot_dispatcher());
+                assert!(!i.get("eth0").unwrap().specialized_dispatcher());
+                assert!(i.get("eth1").unwrap().specialized_dispatcher());
+                assert_eq!(i.get("eth0").unwrap().spare_dispatcher_slots(), 0);
+                assert_eq!(i.get("eth1").unwrap().spare_dispatcher_slots(), 4);
+                assert_eq!(
+                    i.get("eth0").unwrap().verdict_cache_ttl_ms(),
+                    DEFAULT_VERDICT_CACHE_TTL_MS
+                );
+                assert_eq!(i.get("eth1").unwrap().verdict_cache_ttl_ms(), 250);
+                assert_eq!(
+                    i.get("eth1").unwrap().verdict_cache_entries(),
+                    DEFAULT_VERDICT_CACHE_ENTRIES
+                );
+            }
+            None => panic!("expected interfaces to be present"),
+        }
+    }
+
+    #[test]
+    fn test_config_map_memory() {
+        let input = r#"
+        [map_memory]
+        node_budget_bytes = 268435456
+        namespace_metadata_key = "namespace"
+        namespace_budget_bytes = 16777216
+        "#;
+        let config: Config = toml::from_str(input).expect("error parsing toml input");
+        let map_memory = config.map_memory().clone().unwrap();
+        assert_eq!(map_memory.node_budget_bytes, Some(268435456));
+
+        let metadata = HashMap::from([("namespace".to_string(), "tenant-a".to_string())]);
+        assert_eq!(map_memory.namespace(&metadata), Some("tenant-a"));
+        assert_eq!(map_memory.namespace(&HashMap::new()), None);
+        assert_eq!(MapMemoryConfig::default().namespace(&metadata), None);
+    }
 }
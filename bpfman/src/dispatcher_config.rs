@@ -7,25 +7,47 @@
 // pub (crate) const XDP_DISPATCHER_RETVAL: u32 = 31;
 pub(crate) const MAX_DISPATCHER_ACTIONS: usize = 10;
 
+// Number of slots of the extended dispatchers, which are built from the same
+// source with a larger MAX_DISPATCHER_ACTIONS (see bpf/dispatcher_slots.h) and
+// are only used once an interface has more than MAX_DISPATCHER_ACTIONS
+// programs.
+pub(crate) const EXTENDED_DISPATCHER_ACTIONS: usize = 64;
+
+// Number of slots of the single slot XDP dispatcher, which can be used instead
+// of the standard one when an interface only has one program.
+pub(crate) const SINGLE_SLOT_DISPATCHER_ACTIONS: usize = 1;
+
+// Slot counts the XDP dispatcher is built with, smallest first. Interfaces
+// configured with specialized_dispatcher use the smallest one that fits. These
+// must match the variants built by xtask (see xtask/src/build_ebpf.rs).
+pub(crate) const XDP_DISPATCHER_SLOT_COUNTS: &[usize] = &[
+    SINGLE_SLOT_DISPATCHER_ACTIONS,
+    2,
+    4,
+    8,
+    MAX_DISPATCHER_ACTIONS,
+    EXTENDED_DISPATCHER_ACTIONS,
+];
+
 #[derive(Copy, Clone, Debug)]
 #[repr(C)]
-pub(crate) struct XdpDispatcherConfig {
+pub(crate) struct XdpDispatcherConfig<const N: usize = MAX_DISPATCHER_ACTIONS> {
     pub magic: u8,
     pub dispatcher_version: u8,
     pub num_progs_enabled: u8,
     pub is_xdp_frags: u8,
-    pub chain_call_actions: [u32; MAX_DISPATCHER_ACTIONS],
-    pub run_prios: [u32; MAX_DISPATCHER_ACTIONS],
-    pub program_flags: [u32; MAX_DISPATCHER_ACTIONS],
+    pub chain_call_actions: [u32; N],
+    pub run_prios: [u32; N],
+    pub program_flags: [u32; N],
 }
 
-impl XdpDispatcherConfig {
+impl<const N: usize> XdpDispatcherConfig<N> {
     pub(crate) fn new(
         num_progs_enabled: u8,
         is_xdp_frags: u8,
-        chain_call_actions: [u32; MAX_DISPATCHER_ACTIONS],
-        run_prios: [u32; MAX_DISPATCHER_ACTIONS],
-        program_flags: [u32; MAX_DISPATCHER_ACTIONS],
+        chain_call_actions: [u32; N],
+        run_prios: [u32; N],
+        program_flags: [u32; N],
     ) -> Self {
         Self {
             magic: 236u8,
@@ -39,7 +61,35 @@ impl XdpDispatcherConfig {
     }
 }
 
-unsafe impl aya::Pod for XdpDispatcherConfig {}
+unsafe impl<const N: usize> aya::Pod for XdpDispatcherConfig<N> {}
+
+// Dispatcher Stats Defines (see bpf/dispatcher_stats.h)
+pub(crate) const DISPATCHER_FLAG_STATS: u32 = 1 << 0;
+pub(crate) const DISPATCHER_FLAG_VERDICT_CACHE: u32 = 1 << 1;
+pub(crate) const DISPATCHER_MAX_VERDICTS: usize = 16;
+pub(crate) const DISPATCHER_LATENCY_BUCKETS: usize = 24;
+pub(crate) const XDP_DISPATCHER_STATS_MAP: &str = "xdp_disp_stats";
+pub(crate) const TC_DISPATCHER_STATS_MAP: &str = "tc_disp_stats";
+
+// XDP verdict cache, see bpf/xdp_dispatcher_v2.bpf.c
+pub(crate) const XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT: u32 = 1 << 0;
+pub(crate) const XDP_VERDICT_CACHE_MAP: &str = "xdp_verdict_cache";
+pub(crate) const XDP_VERDICT_CACHE_TTL: &str = "verdict_cache_ttl_ns";
+
+// XDP RX queue scoping, see bpf/xdp_dispatcher_v2.bpf.c
+pub(crate) const XDP_DISPATCHER_PROG_FLAG_RX_QUEUES: u32 = 1 << 1;
+pub(crate) const XDP_SLOT_RX_QUEUES: &str = "slot_rx_queues";
+
+#[derive(Copy, Clone, Debug, Default)]
+#[repr(C)]
+pub(crate) struct DispatcherSlotStatsRaw {
+    pub count: u64,
+    pub run_time_ns: u64,
+    pub verdicts: [u64; DISPATCHER_MAX_VERDICTS],
+    pub latency: [u64; DISPATCHER_LATENCY_BUCKETS],
+}
+
+unsafe impl aya::Pod for DispatcherSlotStatsRaw {}
 
 // TC Defines
 // pub (crate) const TC_METADATA_SECTION: &str = "tc_metadata";
@@ -49,10 +99,10 @@ pub(crate) const TC_MAX_DISPATCHER_ACTIONS: usize = 10;
 
 #[derive(Copy, Clone, Debug)]
 #[repr(C)]
-pub(crate) struct TcDispatcherConfig {
+pub(crate) struct TcDispatcherConfig<const N: usize = TC_MAX_DISPATCHER_ACTIONS> {
     pub num_progs_enabled: u8,
-    pub chain_call_actions: [u32; TC_MAX_DISPATCHER_ACTIONS],
-    pub run_prios: [u32; TC_MAX_DISPATCHER_ACTIONS],
+    pub chain_call_actions: [u32; N],
+    pub run_prios: [u32; N],
 }
 
-unsafe impl aya::Pod for TcDispatcherConfig {}
+unsafe impl<const N: usize> aya::Pod for TcDispatcherConfig<N> {}
@@ -63,6 +63,13 @@ pub enum BpfmanError {
     BtfError(#[from] aya::BtfError),
     #[error("Failed to acquire database lock, please try again later")]
     DatabaseLockError,
+    #[error("The maps of the program need {needed} bytes, over the map memory budget of {scope}: {used} of {budget} bytes are in use")]
+    MapMemoryBudgetExceeded {
+        scope: String,
+        needed: u64,
+        used: u64,
+        budget: u64,
+    },
 }
 
 #[derive(Error, Debug)]
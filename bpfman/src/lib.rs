@@ -2,35 +2,43 @@
 // Copyright Authors of bpfman
 
 use std::{
-    collections::HashMap,
+    collections::{HashMap, HashSet},
     fs::{create_dir_all, remove_dir_all},
     path::{Path, PathBuf},
+    sync::{Arc, Weak},
 };
 
 use aya::{
     programs::{
-        fentry::FEntryLink, fexit::FExitLink, kprobe::KProbeLink, links::FdLink, loaded_programs,
-        trace_point::TracePointLink, uprobe::UProbeLink, FEntry, FExit, KProbe, TracePoint, UProbe,
+        fentry::FEntryLink, fexit::FExitLink, kprobe::KProbeLink, links::FdLink, loaded_links,
+        loaded_programs, trace_point::TracePointLink, uprobe::UProbeLink, FEntry, FExit, KProbe,
+        TracePoint, UProbe,
     },
     BpfLoader, Btf,
 };
+use lazy_static::lazy_static;
 use log::{debug, info, warn};
 use sled::{Config as SledConfig, Db};
-use tokio::time::{sleep, Duration};
+use tokio::{
+    sync::Mutex,
+    time::{sleep, Duration},
+};
 use utils::initialize_bpfman;
 
 use crate::{
-    config::Config,
+    config::{Config, InterfaceConfig},
     directories::*,
+    dispatcher_config::EXTENDED_DISPATCHER_ACTIONS,
     errors::BpfmanError,
     multiprog::{
-        Dispatcher, DispatcherId, DispatcherInfo, TC_DISPATCHER_PREFIX, XDP_DISPATCHER_PREFIX,
+        lock_dispatcher, record_xdp_section, Dispatcher, DispatcherId, DispatcherInfo,
+        TcDispatcher, XdpDispatcher, TC_DISPATCHER_PREFIX, XDP_DISPATCHER_PREFIX,
     },
     oci_utils::image_manager::ImageManager,
     types::{
-        BytecodeImage, Direction, ListFilter,
+        BytecodeImage, Direction, DispatcherSlotStats, ListFilter,
         ProbeType::{self, *},
-        Program, ProgramData, ProgramType, PROGRAM_PREFIX,
+        Program, ProgramData, ProgramType,
     },
     utils::{
         bytes_to_string, bytes_to_u32, get_error_msg_from_stderr, get_ifindex, open_config_file,
@@ -41,16 +49,34 @@ use crate::{
 mod config;
 mod dispatcher_config;
 pub mod errors;
+mod map_memory;
+mod map_pool;
 mod multiprog;
 mod oci_utils;
+mod recovery;
+mod registry;
 mod static_program;
 pub mod types;
 pub mod utils;
 
+pub use map_memory::map_bytes;
+
 const MAPS_MODE: u32 = 0o0660;
 const MAP_PREFIX: &str = "map_";
 const MAPS_USED_BY_PREFIX: &str = "map_used_by_";
 
+lazy_static! {
+    // The database of the calls in flight. sled only lets a process open a
+    // database once, so calls made at the same time, e.g. by bpfman-rpc,
+    // share it rather than each waiting for the previous one to close it. It
+    // is closed once the last of them returns.
+    static ref SHARED_DB: Mutex<Weak<Db>> = Mutex::new(Weak::new());
+
+    // Held while updating which programs use a map, as the maps_used_by list
+    // of a map is read, modified and written back.
+    static ref MAPS_LOCK: std::sync::Mutex<()> = std::sync::Mutex::new(());
+}
+
 pub(crate) mod directories {
     // The following directories are used by bpfman. They should be created by bpfman service
     // via the bpfman.service settings. They will be manually created in the case where bpfman
@@ -79,6 +105,8 @@ pub(crate) mod directories {
     // StateDirectory: /var/lib/bpfman/
     pub(crate) const STDIR_MODE: u32 = 0o6770;
     pub(crate) const STDIR: &str = "/var/lib/bpfman";
+    // Bytecode extracted from images, see oci_utils::bytecode_store.
+    pub(crate) const STDIR_BYTECODE: &str = "/var/lib/bpfman/bytecode";
     #[cfg(not(test))]
     pub(crate) const STDIR_DB: &str = "/var/lib/bpfman/db";
 }
@@ -96,10 +124,54 @@ pub(crate) fn get_db_config() -> SledConfig {
 /// Loads an ebpf program.
 pub async fn add_program(mut program: Program) -> Result<Program, BpfmanError> {
     let (config, root_db) = &setup().await?;
-    let mut image_manager = init_image_manager().await;
+    let mut image_manager = Mutex::new(init_image_manager().await);
     // This is only required in the add_program api
     program.get_data_mut().load(root_db)?;
 
+    // The reservation is held until the program is recorded, or failed to
+    // load.
+    let prepared = prepare_program(root_db, config, &mut image_manager, &mut program).await;
+    let (map_owner_id, pool, _reservation) = match prepared {
+        Ok(prepared) => prepared,
+        Err(e) => {
+            // Don't leave the tree of the program behind.
+            let _ = program.delete(root_db);
+            return Err(e);
+        }
+    };
+
+    let result = match program {
+        Program::Xdp(_) | Program::Tc(_) => {
+            add_multi_attach_program(root_db, &mut program, &image_manager, config).await
+        }
+        Program::Tracepoint(_)
+        | Program::Kprobe(_)
+        | Program::Uprobe(_)
+        | Program::Fentry(_)
+        | Program::Fexit(_) => add_single_attach_program(root_db, &mut program),
+        Program::Unsupported(_) => panic!("Cannot add unsupported program"),
+    };
+
+    finish_add_program(root_db, program, map_owner_id, pool.as_ref(), result)
+}
+
+// Gets a program that add_program() just stored in the database ready to be
+// loaded, and registers it. Returns the map owner of the program, the lock of
+// the map pool it should own the maps of, if any, and its map memory
+// reservation.
+async fn prepare_program(
+    root_db: &Db,
+    config: &Config,
+    image_manager: &mut Mutex<ImageManager>,
+    program: &mut Program,
+) -> Result<
+    (
+        Option<u32>,
+        Option<map_pool::PoolGuard>,
+        Option<map_memory::MapBudgetReservation>,
+    ),
+    BpfmanError,
+> {
     let map_owner_id = program.get_data().get_map_owner_id()?;
     // Set map_pin_path if we're using another program's maps
     if let Some(map_owner_id) = map_owner_id {
@@ -109,23 +181,159 @@ pub async fn add_program(mut program: Program) -> Result<Program, BpfmanError> {
 
     program
         .get_data_mut()
-        .set_program_bytes(root_db, &mut image_manager)
+        .set_program_bytes(root_db, image_manager.get_mut())
         .await?;
+    let (map_owner_id, pool) = join_map_pool(root_db, program, map_owner_id).await?;
+    let reservation = match config.map_memory() {
+        Some(map_memory) => {
+            map_memory::check_map_budget(root_db, map_memory, program.get_data_mut(), 1)?
+        }
+        None => None,
+    };
 
-    let result = match program {
-        Program::Xdp(_) | Program::Tc(_) => {
-            program.set_if_index(get_ifindex(&program.if_name().unwrap())?)?;
+    if let Program::Xdp(_) | Program::Tc(_) = program {
+        program.set_if_index(get_ifindex(&program.if_name().unwrap())?)?;
+    }
+    program.register(root_db)?;
+    Ok((map_owner_id, pool, reservation))
+}
+
+/// Loads an XDP or TC program and attaches a copy of it to each of the given
+/// interfaces, ignoring the interface set in the program. The bytecode is only
+/// fetched once and the interfaces are handled in parallel. Returns the
+/// result for each interface, in the order they were given.
+pub async fn add_program_to_interfaces(
+    mut program: Program,
+    ifaces: Vec<String>,
+) -> Result<Vec<(String, Result<Program, BpfmanError>)>, BpfmanError> {
+    if !matches!(program, Program::Xdp(_) | Program::Tc(_)) {
+        return Err(BpfmanError::Error(format!(
+            "{} programs can't be attached to interfaces",
+            program.kind()
+        )));
+    }
+
+    let (config, root_db) = setup().await?;
+    let mut image_manager = init_image_manager().await;
+
+    let map_owner_id = program.get_data().get_map_owner_id()?;
+    // Set map_pin_path if we're using another program's maps
+    if let Some(map_owner_id) = map_owner_id {
+        let map_pin_path = is_map_owner_id_valid(&root_db, map_owner_id)?;
+        program.get_data_mut().set_map_pin_path(&map_pin_path)?;
+    }
 
-            add_multi_attach_program(root_db, &mut program, &mut image_manager, config).await
+    // Every copy of the program takes its bytecode from here.
+    program
+        .get_data_mut()
+        .set_program_bytes(&root_db, &mut image_manager)
+        .await?;
+    let (map_owner_id, pool) = join_map_pool(&root_db, &mut program, map_owner_id).await?;
+    // Held until all the copies are recorded, or failed to load.
+    let _reservation = match config.map_memory() {
+        Some(map_memory) => {
+            // Every copy creates the maps it doesn't share.
+            let copies = ifaces.iter().collect::<HashSet<_>>().len() as u64;
+            map_memory::check_map_budget(&root_db, map_memory, program.get_data_mut(), copies)?
         }
-        Program::Tracepoint(_)
-        | Program::Kprobe(_)
-        | Program::Uprobe(_)
-        | Program::Fentry(_)
-        | Program::Fexit(_) => add_single_attach_program(root_db, &mut program),
-        Program::Unsupported(_) => panic!("Cannot add unsupported program"),
+        None => None,
     };
 
+    let config = Arc::new(config);
+    let image_manager = Arc::new(Mutex::new(image_manager));
+    let mut seen = HashSet::new();
+    let mut tasks = Vec::with_capacity(ifaces.len());
+    for iface in ifaces {
+        if !seen.insert(iface.clone()) {
+            let e = BpfmanError::Error(format!("interface {iface} is listed more than once"));
+            tasks.push((iface, Err(e)));
+            continue;
+        }
+        let mut copy = match program.copy_for_iface(&iface) {
+            Ok(copy) => copy,
+            Err(e) => {
+                tasks.push((iface, Err(e)));
+                continue;
+            }
+        };
+        let (root_db, config, image_manager) =
+            (root_db.clone(), config.clone(), image_manager.clone());
+        let task = tokio::spawn(async move {
+            let result = attach_program_copy(&root_db, &config, &image_manager, &mut copy).await;
+            (copy, result)
+        });
+        tasks.push((iface, Ok(task)));
+    }
+
+    // Recording the programs updates the maps they share, so it is done one
+    // at a time once all of them are attached.
+    let mut results = Vec::with_capacity(tasks.len());
+    for (iface, task) in tasks {
+        let result = match task {
+            Ok(task) => match task.await {
+                Ok((copy, result)) => {
+                    finish_add_program(&root_db, copy, map_owner_id, pool.as_ref(), result)
+                }
+                Err(e) => Err(BpfmanError::Error(format!(
+                    "attaching to interface {iface} failed: {e}"
+                ))),
+            },
+            Err(e) => Err(e),
+        };
+        results.push((iface, result));
+    }
+    Ok(results)
+}
+
+// Loads and attaches a copy of a program made by add_program_to_interfaces().
+async fn attach_program_copy(
+    root_db: &Db,
+    config: &Config,
+    image_manager: &Mutex<ImageManager>,
+    program: &mut Program,
+) -> Result<u32, BpfmanError> {
+    program.get_data_mut().load(root_db)?;
+    program.set_if_index(get_ifindex(&program.if_name()?)?)?;
+    program.register(root_db)?;
+    add_multi_attach_program(root_db, program, image_manager, config).await
+}
+
+// Points a program loaded with share_maps, and without a map_owner_id, at the
+// maps of the shared map pool of its bytecode. Returns the map owner the
+// program ends up with, and the lock of the pool it should own the maps of if
+// there was none, to be held until it is recorded as the owner.
+async fn join_map_pool(
+    root_db: &Db,
+    program: &mut Program,
+    map_owner_id: Option<u32>,
+) -> Result<(Option<u32>, Option<map_pool::PoolGuard>), BpfmanError> {
+    let data = program.get_data_mut();
+    if map_owner_id.is_some() || !data.get_share_maps()? {
+        return Ok((map_owner_id, None));
+    }
+
+    let key = map_pool::pool_key(&data.get_program_bytes()?);
+    let pool = map_pool::lock_pool(&key).await;
+    match map_pool::pool_owner(root_db, &key)? {
+        Some(owner) => {
+            debug!("Using the maps of program {owner} from the shared map pool");
+            data.set_map_owner_id(owner)?;
+            data.set_map_pin_path(&calc_map_pin_path(owner))?;
+            Ok((Some(owner), None))
+        }
+        None => Ok((None, Some(pool))),
+    }
+}
+
+// Records a program once it is loaded and attached, or cleans up after it if
+// that failed.
+fn finish_add_program(
+    root_db: &Db,
+    mut program: Program,
+    map_owner_id: Option<u32>,
+    pool: Option<&map_pool::PoolGuard>,
+    result: Result<u32, BpfmanError>,
+) -> Result<Program, BpfmanError> {
     match result {
         Ok(id) => {
             info!(
@@ -137,10 +345,19 @@ pub async fn add_program(mut program: Program) -> Result<Program, BpfmanError> {
             // Now that program is successfully loaded, update the id, maps hash table,
             // and allow access to all maps by bpfman group members.
             save_map(root_db, &mut program, id, map_owner_id)?;
+            if let Some(pool) = pool {
+                map_pool::set_pool_owner(root_db, pool.key(), id)?;
+            }
+
+            let data = program.get_data_mut();
+            let map_bytes = map_memory::maps_bytes(&data.get_kernel_map_ids()?);
+            data.set_map_bytes(map_bytes)?;
 
             // Swap the db tree to be persisted with the unique program ID generated
             // by the kernel.
             program.get_data_mut().swap_tree(root_db, id)?;
+            // Account the program's share of its maps, now that it is known.
+            program.register(root_db)?;
 
             Ok(program)
         }
@@ -187,6 +404,7 @@ pub async fn remove_program(id: u32) -> Result<(), BpfmanError> {
             let if_name = prog.if_name().unwrap();
             let direction = prog.direction()?;
 
+            let _dispatcher_guard = lock_dispatcher(&did).await;
             prog.delete(root_db)
                 .map_err(BpfmanError::BpfmanProgramDeleteError)?;
 
@@ -223,12 +441,32 @@ pub async fn list_programs(filter: ListFilter) -> Result<Vec<Program>, BpfmanErr
 
     debug!("BpfManager::list_programs()");
 
-    // Get an iterator for the bpfman load programs, a hash map indexed by program id.
-    let mut bpfman_progs: HashMap<u32, Program> = get_programs_iter(root_db).collect();
+    // Get the bpfman loaded programs, a hash map indexed by program id. When
+    // filtering on a program type, only the programs of that type are built,
+    // and the ids of the others are skipped below.
+    let kind = filter
+        .program_type
+        .and_then(|t| ProgramType::try_from(t).ok());
+    let (mut bpfman_progs, others): (HashMap<u32, Program>, HashSet<u32>) = match kind {
+        Some(kind) => {
+            let (programs, others) = registry::with_registry(root_db, |r| {
+                let others = r
+                    .programs()
+                    .into_iter()
+                    .filter(|(id, _)| r.is_other_kind(*id, kind))
+                    .map(|(id, _)| id)
+                    .collect();
+                (r.programs_of_kind(kind), others)
+            })?;
+            (programs_from_db(root_db, programs).collect(), others)
+        }
+        None => (get_programs_iter(root_db).collect(), HashSet::new()),
+    };
 
     // Call Aya to get ALL the loaded eBPF programs, and loop through each one.
     Ok(loaded_programs()
         .filter_map(|p| p.ok())
+        .filter(|p| !others.contains(&p.id()))
         .map(|prog| {
             let prog_id = prog.id();
 
@@ -305,6 +543,67 @@ pub async fn pull_bytecode(image: BytecodeImage) -> anyhow::Result<()> {
     Ok(())
 }
 
+/// Pulls several bytecode images like `pull_bytecode`, up to eight of them at
+/// the same time, and returns the result of pulling each, in order.
+pub async fn pull_bytecodes(
+    images: Vec<BytecodeImage>,
+) -> anyhow::Result<Vec<Result<(), BpfmanError>>> {
+    let (_, root_db) = &setup().await?;
+    let image_manager = &mut init_image_manager().await;
+
+    Ok(image_manager
+        .get_images(root_db, &images)
+        .await
+        .into_iter()
+        .map(|result| result.map(|_| ()).map_err(BpfmanError::from))
+        .collect())
+}
+
+/// Loads the program registry left by earlier bpfman processes, rebuilding it
+/// in parallel if needed, and removes the bytecode no program or cached image
+/// uses anymore from the bytecode store. This is all that has to happen
+/// before requests are served.
+pub async fn recover_state() -> Result<(), BpfmanError> {
+    let (_, root_db) = setup().await?;
+    tokio::task::spawn_blocking(move || {
+        recovery::load_registry(&root_db)?;
+        recovery::sweep_bytecode(&root_db).map(|_| ())
+    })
+    .await
+    .map_err(|e| BpfmanError::Error(format!("state recovery failed: {e}")))?
+}
+
+/// Checks map owners, programs and dispatchers left by earlier bpfman
+/// processes against what is pinned, in parallel, logging how long each phase
+/// took and any inconsistency found. Nothing is repaired, so this can run
+/// while requests are served.
+pub async fn check_state() -> Result<(), BpfmanError> {
+    let (_, root_db) = setup().await?;
+    tokio::task::spawn_blocking(move || recovery::check(&root_db).map(|_| ()))
+        .await
+        .map_err(|e| BpfmanError::Error(format!("state check failed: {e}")))?
+}
+
+/// Returns the per-slot statistics of every dispatcher that was loaded with
+/// stats collection enabled (see the `collect_stats` interface option).
+///
+/// The statistics are read directly from the pinned stats maps, so unlike the
+/// other calls this does not need to open the bpfman database and can be used
+/// by external consumers such as the bpf-metrics-exporter.
+pub fn list_dispatcher_stats() -> Result<Vec<DispatcherSlotStats>, BpfmanError> {
+    // The newest link of each program, used to tell which program is
+    // attached to each slot.
+    let mut links = HashMap::new();
+    for link in loaded_links().flatten() {
+        let newest = links.entry(link.prog_id).or_insert(link.id);
+        *newest = (*newest).max(link.id);
+    }
+
+    let mut stats = XdpDispatcher::list_stats(&links)?;
+    stats.extend(TcDispatcher::list_stats(&links)?);
+    Ok(stats)
+}
+
 pub(crate) async fn init_database(sled_config: SledConfig) -> Result<Db, BpfmanError> {
     let database_config = open_config_file().database().to_owned().unwrap_or_default();
     for _ in 0..=database_config.max_retries {
@@ -327,8 +626,8 @@ pub(crate) async fn init_database(sled_config: SledConfig) -> Result<Db, BpfmanE
 // explicitly control when bpfman blocks for network calls to both sigstore's
 // cosign tuf registries and container registries.
 pub(crate) async fn init_image_manager() -> ImageManager {
-    let config = open_config_file();
-    ImageManager::new(config.signing().as_ref().map_or(true, |s| s.allow_unsigned))
+    let signing = open_config_file().signing().clone().unwrap_or_default();
+    ImageManager::new(signing.allow_unsigned, signing.verification_cache_ttl())
         .await
         .expect("failed to initialize image manager")
 }
@@ -367,17 +666,30 @@ fn num_attached_programs(did: &DispatcherId, root_db: &Db) -> usize {
 }
 
 fn get(root_db: &Db, id: &u32) -> Option<Program> {
-    let prog_tree: sled::IVec = (PROGRAM_PREFIX.to_string() + &id.to_string())
-        .as_bytes()
-        .into();
-    if root_db.tree_names().contains(&prog_tree) {
+    registry::with_registry(root_db, |r| r.program_tree(*id))
+        .expect("unable to read program registry")
+        .map(|name| {
+            let tree = root_db
+                .open_tree(name)
+                .expect("unable to open database tree");
+            Program::new_from_db(*id, tree).expect("Failed to build program from database")
+        })
+}
+
+// Builds the programs with the given ids and trees.
+fn programs_from_db<'a>(
+    root_db: &'a Db,
+    programs: Vec<(u32, String)>,
+) -> impl Iterator<Item = (u32, Program)> + 'a {
+    programs.into_iter().map(|(id, name)| {
         let tree = root_db
-            .open_tree(prog_tree)
+            .open_tree(name)
             .expect("unable to open database tree");
-        Some(Program::new_from_db(*id, tree).expect("Failed to build program from database"))
-    } else {
-        None
-    }
+        (
+            id,
+            Program::new_from_db(id, tree).expect("Failed to build program from database"),
+        )
+    })
 }
 
 fn filter(
@@ -386,25 +698,11 @@ fn filter(
     if_index: Option<u32>,
     direction: Option<Direction>,
 ) -> impl Iterator<Item = Program> + '_ {
-    root_db
-        .tree_names()
-        .into_iter()
-        .filter(|p| bytes_to_string(p).contains(PROGRAM_PREFIX))
-        .map(|p| {
-            let id = bytes_to_string(&p)
-                .split('_')
-                .last()
-                .unwrap()
-                .parse::<u32>()
-                .unwrap();
-            let tree = root_db.open_tree(p).expect("unable to open database tree");
-            Program::new_from_db(id, tree).expect("Failed to build program from database")
-        })
-        .filter(move |p| {
-            p.kind() == program_type
-                && p.if_index().unwrap() == if_index
-                && p.direction().unwrap() == direction
-        })
+    let programs = registry::with_registry(root_db, |r| {
+        r.programs_attached_to(program_type, if_index, direction)
+    })
+    .expect("unable to read program registry");
+    programs_from_db(root_db, programs).map(|(_, p)| p)
 }
 
 // Adds a new program and sets the positions of programs that are to be attached via a dispatcher.
@@ -457,35 +755,30 @@ fn set_program_positions(
 }
 
 fn get_programs_iter(root_db: &Db) -> impl Iterator<Item = (u32, Program)> + '_ {
-    root_db
-        .tree_names()
-        .into_iter()
-        .filter(|p| bytes_to_string(p).contains(PROGRAM_PREFIX))
-        .map(|p| {
-            let id = bytes_to_string(&p)
-                .split('_')
-                .last()
-                .unwrap()
-                .parse::<u32>()
-                .unwrap();
-            let tree = root_db.open_tree(p).expect("unable to open database tree");
-            (
-                id,
-                Program::new_from_db(id, tree).expect("Failed to build program from database"),
-            )
-        })
+    let programs = registry::with_registry(root_db, |r| r.programs())
+        .expect("unable to read program registry");
+    programs_from_db(root_db, programs)
 }
 
-async fn setup() -> Result<(Config, Db), BpfmanError> {
+async fn setup() -> Result<(Config, Arc<Db>), BpfmanError> {
     initialize_bpfman()?;
 
-    Ok((open_config_file(), init_database(get_db_config()).await?))
+    let mut shared = SHARED_DB.lock().await;
+    let root_db = match shared.upgrade() {
+        Some(root_db) => root_db,
+        None => {
+            let root_db = Arc::new(init_database(get_db_config()).await?);
+            *shared = Arc::downgrade(&root_db);
+            root_db
+        }
+    };
+    Ok((open_config_file(), root_db))
 }
 
 async fn add_multi_attach_program(
     root_db: &Db,
     program: &mut Program,
-    image_manager: &mut ImageManager,
+    image_manager: &Mutex<ImageManager>,
     config: &Config,
 ) -> Result<u32, BpfmanError> {
     debug!("BpfManager::add_multi_attach_program()");
@@ -494,22 +787,31 @@ async fn add_multi_attach_program(
     // This load is just to verify the BPF Function Name is valid.
     // The actual load is performed in the XDP or TC logic.
     // don't pin maps here.
+    let program_bytes = program.get_data().get_program_bytes()?;
     let mut ext_loader = BpfLoader::new()
         .allow_unsupported_maps()
         .extension(name)
-        .load(&program.get_data().get_program_bytes()?)?;
+        .load(&program_bytes)?;
 
     match ext_loader.program_mut(name) {
         Some(_) => Ok(()),
         None => Err(BpfmanError::BpfFunctionNameNotValid(name.to_owned())),
     }?;
 
+    if let Program::Xdp(p) = program {
+        record_xdp_section(p, &program_bytes)?;
+    }
+
     let did = program
         .dispatcher_id()?
         .ok_or(BpfmanError::DispatcherNotRequired)?;
 
+    // Programs attached through other dispatchers, i.e. to other interfaces
+    // or directions, are added at the same time.
+    let _dispatcher_guard = lock_dispatcher(&did).await;
+
     let next_available_id = num_attached_programs(&did, root_db);
-    if next_available_id >= 10 {
+    if next_available_id >= EXTENDED_DISPATCHER_ACTIONS {
         return Err(BpfmanError::TooManyPrograms);
     }
 
@@ -525,7 +827,7 @@ async fn add_multi_attach_program(
     let mut programs: Vec<Program> =
         filter(root_db, program_type, if_index, direction).collect::<Vec<Program>>();
 
-    let old_dispatcher = get_dispatcher(&did, root_db);
+    let mut old_dispatcher = get_dispatcher(&did, root_db);
 
     let if_config = if let Some(ref i) = config.interfaces() {
         i.get(&if_name)
@@ -538,12 +840,12 @@ async fn add_multi_attach_program(
         1
     };
 
-    Dispatcher::new(
+    update_or_replace_dispatcher(
         root_db,
         if_config,
         &mut programs,
         next_revision,
-        old_dispatcher,
+        &mut old_dispatcher,
         image_manager,
     )
     .await
@@ -889,7 +1191,7 @@ async fn remove_multi_attach_program(
     direction: Option<Direction>,
 ) -> Result<(), BpfmanError> {
     debug!("BpfManager::remove_multi_attach_program()");
-    let mut image_manager = init_image_manager().await;
+    let image_manager = Mutex::new(init_image_manager().await);
 
     let next_available_id = num_attached_programs(&did, root_db) - 1;
     debug!("next_available_id = {next_available_id}");
@@ -920,13 +1222,42 @@ async fn remove_multi_attach_program(
     };
     debug!("next_revision = {next_revision}");
 
-    Dispatcher::new(
+    update_or_replace_dispatcher(
         root_db,
         if_config,
         &mut programs,
         next_revision,
-        old_dispatcher,
-        &mut image_manager,
+        &mut old_dispatcher,
+        &image_manager,
+    )
+    .await
+}
+
+// Applies a change to the programs of a dispatcher. The running dispatcher is
+// updated in place when only some of its slots change, otherwise a new
+// dispatcher revision is loaded to replace it.
+async fn update_or_replace_dispatcher(
+    root_db: &Db,
+    if_config: Option<&InterfaceConfig>,
+    programs: &mut [Program],
+    next_revision: u32,
+    old_dispatcher: &mut Option<Dispatcher>,
+    image_manager: &Mutex<ImageManager>,
+) -> Result<(), BpfmanError> {
+    if let Some(old) = old_dispatcher {
+        if old.update(if_config, programs)? {
+            debug!("dispatcher updated in place");
+            return Ok(());
+        }
+    }
+
+    Dispatcher::new(
+        root_db,
+        if_config,
+        programs,
+        next_revision,
+        old_dispatcher.take(),
+        image_manager,
     )
     .await?;
 
@@ -977,6 +1308,7 @@ fn save_map(
     map_owner_id: Option<u32>,
 ) -> Result<(), BpfmanError> {
     let data = program.get_data_mut();
+    let _maps_guard = MAPS_LOCK.lock().unwrap();
 
     match map_owner_id {
         Some(m) => {
@@ -992,6 +1324,7 @@ fn save_map(
                 for used_by_id in used_by.iter() {
                     if let Some(mut program) = get(root_db, used_by_id) {
                         program.get_data_mut().set_maps_used_by(used_by.clone())?;
+                        program.register(root_db)?;
                     }
                 }
             } else {
@@ -1045,6 +1378,7 @@ fn delete_map(root_db: &Db, id: u32, map_owner_id: Option<u32>) -> Result<(), Bp
         Some(i) => i,
         None => id,
     };
+    let _maps_guard = MAPS_LOCK.lock().unwrap();
 
     if let Some(map) = get_map(index, root_db) {
         let mut used_by = get_maps_used_by(map.clone())?;
@@ -1062,6 +1396,7 @@ fn delete_map(root_db: &Db, id: u32, map_owner_id: Option<u32>) -> Result<(), Bp
             root_db
                 .drop_tree(MAP_PREFIX.to_string() + &index.to_string())
                 .expect("unable to drop maps tree");
+            map_pool::remove_pool_owner(root_db, index)?;
             remove_dir_all(path)
                 .map_err(|e| BpfmanError::Error(format!("can't delete map dir: {e}")))?;
         } else {
@@ -1069,6 +1404,7 @@ fn delete_map(root_db: &Db, id: u32, map_owner_id: Option<u32>) -> Result<(), Bp
             for id in used_by.iter() {
                 if let Some(mut program) = get(root_db, id) {
                     program.get_data_mut().set_maps_used_by(used_by.clone())?;
+                    program.register(root_db)?;
                 }
             }
         }
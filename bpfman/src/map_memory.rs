@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Accounting of the kernel memory taken by the maps of the programs bpfman
+//! loads.
+//!
+//! The memory of a map is estimated from its type, key and value sizes and
+//! maximum number of entries, the way the kernel sizes its allocations: per-CPU
+//! maps hold a value for every possible CPU, so they grow with the node, and
+//! hash maps also pay for their keys and a per entry header. Programs sharing
+//! maps, through map_owner_id or the shared map pool, are each accounted an
+//! equal share of them.
+//!
+//! The memory a program's maps will take is projected from its bytecode
+//! before it is loaded, and checked against the budgets in the [map_memory]
+//! section of the configuration, so that a program that doesn't fit fails to
+//! load before the kernel allocates anything for it. Once it is loaded, the
+//! memory of the maps it actually uses is recorded from their map info, and
+//! its share of it is kept in the registry, along with the running totals of
+//! the node and of each namespace. Until then, the projected memory stays
+//! reserved, so that programs loaded at the same time can't all fit in the
+//! same room.
+//!
+//! Only the maps of the programs themselves are accounted: the maps of the
+//! dispatchers, such as the per-CPU verdict cache of the XDP dispatcher, are
+//! not charged to any budget.
+
+use std::{collections::HashMap, path::Path, sync::Mutex};
+
+use aya::{maps::MapInfo, util::nr_cpus};
+use aya_obj::{maps::PinningType, Object};
+use lazy_static::lazy_static;
+use log::debug;
+use sled::Db;
+
+use crate::{config::MapMemoryConfig, errors::BpfmanError, registry, types::ProgramData};
+
+const BPF_MAP_TYPE_HASH: u32 = 1;
+const BPF_MAP_TYPE_ARRAY: u32 = 2;
+const BPF_MAP_TYPE_PROG_ARRAY: u32 = 3;
+const BPF_MAP_TYPE_PERF_EVENT_ARRAY: u32 = 4;
+const BPF_MAP_TYPE_PERCPU_HASH: u32 = 5;
+const BPF_MAP_TYPE_PERCPU_ARRAY: u32 = 6;
+const BPF_MAP_TYPE_CGROUP_ARRAY: u32 = 8;
+const BPF_MAP_TYPE_LRU_HASH: u32 = 9;
+const BPF_MAP_TYPE_LRU_PERCPU_HASH: u32 = 10;
+const BPF_MAP_TYPE_ARRAY_OF_MAPS: u32 = 12;
+const BPF_MAP_TYPE_HASH_OF_MAPS: u32 = 13;
+const BPF_MAP_TYPE_RINGBUF: u32 = 27;
+
+// The header of a hash map entry, struct htab_elem, on 64 bit kernels.
+const HTAB_ELEM_HEADER: u64 = 48;
+
+lazy_static! {
+    // The map memory reserved for the programs being loaded.
+    static ref RESERVED: Mutex<Reserved> = Mutex::new(Reserved::default());
+}
+
+#[derive(Default)]
+struct Reserved {
+    node: u64,
+    by_namespace: HashMap<String, u64>,
+}
+
+/// Map memory reserved for programs being loaded, released when it is
+/// dropped, once the programs are in the registry or failed to load.
+pub(crate) struct MapBudgetReservation {
+    bytes: u64,
+    namespace: Option<String>,
+}
+
+impl MapBudgetReservation {
+    // Reserves `bytes`, with `reserved` locked.
+    fn new(reserved: &mut Reserved, bytes: u64, namespace: Option<&str>) -> Self {
+        reserved.node += bytes;
+        if let Some(namespace) = namespace {
+            *reserved
+                .by_namespace
+                .entry(namespace.to_string())
+                .or_default() += bytes;
+        }
+        Self {
+            bytes,
+            namespace: namespace.map(String::from),
+        }
+    }
+}
+
+impl Drop for MapBudgetReservation {
+    fn drop(&mut self) {
+        let mut reserved = RESERVED.lock().unwrap();
+        reserved.node = reserved.node.saturating_sub(self.bytes);
+        if let Some(namespace) = &self.namespace {
+            if let Some(bytes) = reserved.by_namespace.get_mut(namespace) {
+                *bytes = bytes.saturating_sub(self.bytes);
+                if *bytes == 0 {
+                    reserved.by_namespace.remove(namespace);
+                }
+            }
+        }
+    }
+}
+
+fn round_up_8(n: u32) -> u64 {
+    (u64::from(n) + 7) & !7
+}
+
+/// Returns the estimated bytes of kernel memory taken by a map, on a node with
+/// `nr_cpus` possible CPUs. Also used by the bpf-metrics-exporter, so that it
+/// exports the same estimates the budgets are enforced with.
+pub fn map_bytes(
+    map_type: u32,
+    key_size: u32,
+    value_size: u32,
+    max_entries: u32,
+    nr_cpus: u64,
+) -> u64 {
+    let entries = u64::from(max_entries);
+    let (key, value) = (round_up_8(key_size), round_up_8(value_size));
+    match map_type {
+        BPF_MAP_TYPE_ARRAY
+        | BPF_MAP_TYPE_PROG_ARRAY
+        | BPF_MAP_TYPE_PERF_EVENT_ARRAY
+        | BPF_MAP_TYPE_CGROUP_ARRAY
+        | BPF_MAP_TYPE_ARRAY_OF_MAPS => entries * value,
+        BPF_MAP_TYPE_PERCPU_ARRAY => entries * value * nr_cpus,
+        BPF_MAP_TYPE_HASH | BPF_MAP_TYPE_LRU_HASH | BPF_MAP_TYPE_HASH_OF_MAPS => {
+            entries * (HTAB_ELEM_HEADER + key + value)
+        }
+        // The entries hold a pointer to their per-CPU values.
+        BPF_MAP_TYPE_PERCPU_HASH | BPF_MAP_TYPE_LRU_PERCPU_HASH => {
+            entries * (HTAB_ELEM_HEADER + key + 8 + value * nr_cpus)
+        }
+        // The size of a ring buffer is its number of entries.
+        BPF_MAP_TYPE_RINGBUF => entries,
+        _ => entries * (key + value),
+    }
+}
+
+/// Returns the estimated bytes of kernel memory taken by the maps with the
+/// given ids. Maps that can't be found, e.g. because they were just unloaded,
+/// are left out.
+pub(crate) fn maps_bytes(map_ids: &[u32]) -> u64 {
+    let nr_cpus = nr_cpus().unwrap_or(1) as u64;
+    map_ids
+        .iter()
+        .filter_map(|id| match MapInfo::from_id(*id) {
+            Ok(info) => Some(map_bytes(
+                info.map_type(),
+                info.key_size(),
+                info.value_size(),
+                info.max_entries(),
+                nr_cpus,
+            )),
+            Err(e) => {
+                debug!("unable to get info of map {id}: {e}");
+                None
+            }
+        })
+        .sum()
+}
+
+/// Returns the estimated bytes of kernel memory the maps of `bytecode` will
+/// take once it is loaded. Maps pinned by name that already exist in
+/// `map_pin_path` are reused rather than created, so they are left out.
+pub(crate) fn projected_bytes(
+    bytecode: &[u8],
+    map_pin_path: Option<&Path>,
+) -> Result<u64, BpfmanError> {
+    let obj = Object::parse(bytecode).map_err(|e| {
+        BpfmanError::Error(format!("unable to parse the maps of the bytecode: {e}"))
+    })?;
+    let nr_cpus = nr_cpus().unwrap_or(1) as u64;
+    Ok(obj
+        .maps
+        .iter()
+        .filter(|(name, map)| {
+            !(matches!(map.pinning(), PinningType::ByName)
+                && map_pin_path.is_some_and(|p| p.join(name).exists()))
+        })
+        .map(|(_, map)| {
+            map_bytes(
+                map.map_type(),
+                map.key_size(),
+                map.value_size(),
+                map.max_entries(),
+                nr_cpus,
+            )
+        })
+        .sum())
+}
+
+fn within_budget(scope: String, needed: u64, used: u64, budget: u64) -> Result<(), BpfmanError> {
+    if used.saturating_add(needed) > budget {
+        return Err(BpfmanError::MapMemoryBudgetExceeded {
+            scope,
+            needed,
+            used,
+            budget,
+        });
+    }
+    Ok(())
+}
+
+/// Checks that loading `copies` copies of a program keeps the maps of the
+/// programs bpfman loads within the node budget, and the budget of the
+/// program's namespace, and reserves the memory they need. The reservation
+/// must be held until the copies are recorded as loaded, or failed to load.
+/// The namespace is recorded in the program, for the registry to account its
+/// maps to.
+pub(crate) fn check_map_budget(
+    root_db: &Db,
+    config: &MapMemoryConfig,
+    data: &mut ProgramData,
+    copies: u64,
+) -> Result<Option<MapBudgetReservation>, BpfmanError> {
+    let metadata = data.get_metadata()?;
+    let namespace = config.namespace(&metadata);
+    if let Some(namespace) = namespace {
+        data.set_map_namespace(namespace)?;
+    }
+    if config.node_budget_bytes.is_none() && namespace.is_none() {
+        return Ok(None);
+    }
+
+    let map_pin_path = data.get_map_pin_path()?;
+    let needed = projected_bytes(&data.get_program_bytes()?, map_pin_path.as_deref())? * copies;
+
+    // Checking and reserving happen with the reservations locked, so that
+    // programs checked at the same time count each other.
+    let mut reserved = RESERVED.lock().unwrap();
+    let (node_used, namespace_used) =
+        registry::with_registry(root_db, |r| r.map_bytes_in_use(namespace))?;
+    let node_used = node_used + reserved.node;
+    let namespace_used = namespace_used
+        + namespace
+            .and_then(|n| reserved.by_namespace.get(n))
+            .copied()
+            .unwrap_or(0);
+    debug!("Program maps need {needed} bytes, {node_used} bytes are in use on the node");
+
+    if let Some(budget) = config.node_budget_bytes {
+        within_budget("the node".to_string(), needed, node_used, budget)?;
+    }
+    if let (Some(namespace), Some(budget)) = (namespace, config.namespace_budget_bytes) {
+        within_budget(
+            format!("namespace {namespace}"),
+            needed,
+            namespace_used,
+            budget,
+        )?;
+    }
+    Ok(Some(MapBudgetReservation::new(
+        &mut reserved,
+        needed,
+        namespace,
+    )))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_map_bytes() {
+        // The examples' stats maps: a per-CPU array of one 16 byte entry per
+        // XDP action.
+        assert_eq!(map_bytes(BPF_MAP_TYPE_ARRAY, 4, 16, 5, 256), 80);
+        assert_eq!(map_bytes(BPF_MAP_TYPE_PERCPU_ARRAY, 4, 16, 5, 256), 20480);
+
+        assert_eq!(map_bytes(BPF_MAP_TYPE_HASH, 4, 12, 10, 4), 720);
+        assert_eq!(map_bytes(BPF_MAP_TYPE_PERCPU_HASH, 4, 12, 10, 4), 1280);
+        assert_eq!(map_bytes(BPF_MAP_TYPE_RINGBUF, 0, 0, 4096, 4), 4096);
+    }
+
+    #[test]
+    fn test_within_budget() {
+        assert!(within_budget("the node".to_string(), 20480, 0, 20480).is_ok());
+        assert!(matches!(
+            within_budget("namespace tenant-a".to_string(), 20480, 4096, 20480),
+            Err(BpfmanError::MapMemoryBudgetExceeded {
+                needed: 20480,
+                used: 4096,
+                ..
+            })
+        ));
+    }
+
+    #[test]
+    fn test_map_budget_reservation() {
+        let reservation =
+            MapBudgetReservation::new(&mut RESERVED.lock().unwrap(), 4096, Some("tenant-c"));
+        assert_eq!(
+            RESERVED.lock().unwrap().by_namespace.get("tenant-c"),
+            Some(&4096)
+        );
+
+        drop(reservation);
+        assert!(!RESERVED
+            .lock()
+            .unwrap()
+            .by_namespace
+            .contains_key("tenant-c"));
+    }
+}
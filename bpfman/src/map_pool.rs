@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! The shared map pool.
+//!
+//! Programs loaded with share_maps use the maps of a program loaded earlier
+//! from the same bytecode, as if they were loaded with its id as map_owner_id,
+//! instead of creating maps of their own. The many instances of a program,
+//! e.g. one per pod, then share a single set of pinned maps rather than each
+//! having a copy, which matters most for per-CPU maps on nodes with many CPUs.
+//! Instances that need entries of their own key them by an instance id set
+//! in their global data.
+//!
+//! The pool maps the SHA256 digest of a bytecode to the id of the program that
+//! owns its maps. The first program loaded from a bytecode with share_maps
+//! becomes the owner, and the entry goes away with the maps, once the last
+//! program using them is unloaded. A pool is locked from when a program finds
+//! it has no owner until that program is recorded as its owner, so that
+//! programs loaded at the same time from the same bytecode don't each create
+//! maps of their own.
+
+use std::{
+    collections::HashMap,
+    sync::{Arc, Mutex},
+};
+
+use lazy_static::lazy_static;
+use sled::Db;
+use tokio::sync::OwnedMutexGuard;
+
+use crate::{
+    errors::BpfmanError,
+    oci_utils::bytecode_store::{sha256_hex, Bytecode},
+    utils::{bytes_to_string, bytes_to_u32},
+    MAP_PREFIX,
+};
+
+const MAP_POOL_TREE: &str = "map_pool";
+
+lazy_static! {
+    // The locks of the pools being joined, by pool key.
+    static ref POOL_LOCKS: Mutex<HashMap<String, Arc<tokio::sync::Mutex<()>>>> =
+        Mutex::new(HashMap::new());
+}
+
+/// The lock of a pool, held until the program that locked it is recorded as
+/// the owner of the pool, or fails to load.
+pub(crate) struct PoolGuard {
+    key: String,
+    guard: Option<OwnedMutexGuard<()>>,
+}
+
+impl PoolGuard {
+    pub(crate) fn key(&self) -> &str {
+        &self.key
+    }
+}
+
+impl Drop for PoolGuard {
+    fn drop(&mut self) {
+        self.guard.take();
+        // Forget the lock once nobody holds or waits for it.
+        let mut locks = POOL_LOCKS.lock().unwrap();
+        if locks
+            .get(&self.key)
+            .is_some_and(|l| Arc::strong_count(l) == 1)
+        {
+            locks.remove(&self.key);
+        }
+    }
+}
+
+/// Locks the pool with the given key, waiting for the program holding it, if
+/// any, to be recorded as its owner or to fail to load.
+pub(crate) async fn lock_pool(key: &str) -> PoolGuard {
+    let lock = POOL_LOCKS
+        .lock()
+        .unwrap()
+        .entry(key.to_string())
+        .or_default()
+        .clone();
+    PoolGuard {
+        key: key.to_string(),
+        guard: Some(lock.lock_owned().await),
+    }
+}
+
+fn pool_tree(root_db: &Db) -> sled::Tree {
+    root_db
+        .open_tree(MAP_POOL_TREE)
+        .expect("unable to open map pool tree")
+}
+
+fn db_error(what: &str, e: sled::Error) -> BpfmanError {
+    BpfmanError::DatabaseError(what.to_string(), e.to_string())
+}
+
+/// Returns the key of the pool of the given bytecode.
+pub(crate) fn pool_key(bytecode: &Bytecode) -> String {
+    match bytecode.digest() {
+        Some(digest) => digest.to_string(),
+        None => sha256_hex(bytecode),
+    }
+}
+
+/// Returns the id of the program owning the maps of a pool, if the pool has
+/// maps.
+pub(crate) fn pool_owner(root_db: &Db, key: &str) -> Result<Option<u32>, BpfmanError> {
+    let Some(owner) = pool_tree(root_db)
+        .get(key)
+        .map_err(|e| db_error("Unable to get map pool entry", e))?
+        .map(|v| bytes_to_u32(v.to_vec()))
+    else {
+        return Ok(None);
+    };
+    // The maps may have been left behind by an earlier bpfman process.
+    let tree = format!("{MAP_PREFIX}{owner}");
+    let has_maps = root_db
+        .tree_names()
+        .iter()
+        .any(|n| bytes_to_string(n) == tree);
+    Ok(has_maps.then_some(owner))
+}
+
+/// Makes `owner` the owner of the maps of a pool, unless the pool already has
+/// one.
+pub(crate) fn set_pool_owner(root_db: &Db, key: &str, owner: u32) -> Result<(), BpfmanError> {
+    if pool_owner(root_db, key)?.is_some() {
+        return Ok(());
+    }
+    pool_tree(root_db)
+        .insert(key, &owner.to_ne_bytes())
+        .map(|_| ())
+        .map_err(|e| db_error("Unable to insert map pool entry", e))
+}
+
+/// Removes the pools whose maps are owned by `owner`, once its maps are gone.
+pub(crate) fn remove_pool_owner(root_db: &Db, owner: u32) -> Result<(), BpfmanError> {
+    let tree = pool_tree(root_db);
+    for entry in tree.iter() {
+        let (key, value) = entry.map_err(|e| db_error("Unable to read map pool", e))?;
+        if bytes_to_u32(value.to_vec()) == owner {
+            tree.remove(key)
+                .map_err(|e| db_error("Unable to remove map pool entry", e))?;
+        }
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{get_db_config, init_database};
+
+    #[tokio::test]
+    async fn test_map_pool() {
+        let root_db = init_database(get_db_config())
+            .await
+            .expect("Unable to open root database for unit test");
+        let key = pool_key(&Bytecode::Owned(b"\x7fELF xdp_stats".as_slice().into()));
+
+        // The owner only counts while its maps are stored.
+        set_pool_owner(&root_db, &key, 7).unwrap();
+        assert_eq!(pool_owner(&root_db, &key).unwrap(), None);
+        root_db.open_tree("map_7").unwrap();
+        assert_eq!(pool_owner(&root_db, &key).unwrap(), Some(7));
+
+        // The first owner is kept.
+        root_db.open_tree("map_8").unwrap();
+        set_pool_owner(&root_db, &key, 8).unwrap();
+        assert_eq!(pool_owner(&root_db, &key).unwrap(), Some(7));
+
+        remove_pool_owner(&root_db, 7).unwrap();
+        assert!(pool_tree(&root_db).get(&key).unwrap().is_none());
+    }
+
+    #[tokio::test]
+    async fn test_lock_pool() {
+        let guard = lock_pool("digest").await;
+        let waiter = tokio::spawn(async { lock_pool("digest").await.key().to_string() });
+        tokio::task::yield_now().await;
+        assert!(!waiter.is_finished());
+
+        drop(guard);
+        assert_eq!(waiter.await.unwrap(), "digest");
+        assert!(!POOL_LOCKS.lock().unwrap().contains_key("digest"));
+    }
+}
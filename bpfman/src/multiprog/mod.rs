@@ -4,22 +4,52 @@
 mod tc;
 mod xdp;
 
+use std::{
+    collections::HashMap,
+    fs,
+    path::{Path, PathBuf},
+    sync::Arc,
+};
+
+use aya::maps::{Map, MapData, PerCpuArray};
+use lazy_static::lazy_static;
 use log::debug;
 use sled::Db;
 pub use tc::TcDispatcher;
+use tokio::sync::{Mutex, OwnedMutexGuard};
+pub(crate) use xdp::record_xdp_section;
 pub use xdp::XdpDispatcher;
 
 use crate::{
-    config::{InterfaceConfig, XdpMode},
+    config::InterfaceConfig,
+    dispatcher_config::DispatcherSlotStatsRaw,
     errors::BpfmanError,
     oci_utils::image_manager::ImageManager,
     types::{Direction, Program, ProgramType},
-    utils::bytes_to_string,
+    utils::{bytes_to_string, bytes_to_u32, bytes_to_usize, sled_get_option, sled_insert},
 };
 
 pub(crate) const TC_DISPATCHER_PREFIX: &str = "tc_dispatcher_";
 pub(crate) const XDP_DISPATCHER_PREFIX: &str = "xdp_dispatcher_";
 
+/// Name of the file, inside a dispatcher's pin directory, that the per-slot
+/// stats map is pinned to.
+pub(crate) const DISPATCHER_STATS_PIN: &str = "stats";
+
+/// Name of the file, inside an XDP dispatcher's pin directory, that the
+/// verdict cache map is pinned to.
+pub(crate) const VERDICT_CACHE_PIN: &str = "verdict_cache";
+
+/// Name of the file, inside a dispatcher's pin directory, that the dispatcher
+/// program itself is pinned to so that later updates can attach to it.
+pub(crate) const DISPATCHER_PROGRAM_PIN: &str = "dispatcher";
+
+/// These constants define the keys of the slot layout in a dispatcher's SLED
+/// DB tree.
+const ENABLED_SLOTS: &str = "enabled_slots";
+const SLOT_ACTIONS_PREFIX: &str = "slot_actions_";
+const SLOT_PROGRAM_PREFIX: &str = "slot_program_";
+
 #[derive(Debug)]
 pub(crate) enum Dispatcher {
     Xdp(XdpDispatcher),
@@ -33,7 +63,7 @@ impl Dispatcher {
         programs: &mut [Program],
         revision: u32,
         old_dispatcher: Option<Dispatcher>,
-        image_manager: &mut ImageManager,
+        image_manager: &Mutex<ImageManager>,
     ) -> Result<Dispatcher, BpfmanError> {
         debug!("Dispatcher::new()");
         let p = programs
@@ -44,15 +74,10 @@ impl Dispatcher {
             .ok_or_else(|| BpfmanError::Error("missing ifindex".to_string()))?;
         let if_name = p.if_name()?;
         let direction = p.direction()?;
-        let xdp_mode = if let Some(c) = config {
-            c.xdp_mode()
-        } else {
-            &XdpMode::Skb
-        };
         let d = match p.kind() {
             ProgramType::Xdp => {
                 let mut x =
-                    XdpDispatcher::new(root_db, xdp_mode, if_index, if_name.to_string(), revision)?;
+                    XdpDispatcher::new(root_db, config, if_index, if_name.to_string(), revision)?;
 
                 x.load(root_db, programs, old_dispatcher, image_manager)
                     .await?;
@@ -61,6 +86,7 @@ impl Dispatcher {
             ProgramType::Tc => {
                 let mut t = TcDispatcher::new(
                     root_db,
+                    config,
                     direction.expect("missing direction"),
                     if_index,
                     if_name.to_string(),
@@ -76,6 +102,21 @@ impl Dispatcher {
         Ok(d)
     }
 
+    /// Tries to update the dispatcher in place for the given programs, see
+    /// [`plan_slot_updates`]. Returns false if a new dispatcher revision has
+    /// to be loaded instead.
+    pub(crate) fn update(
+        &mut self,
+        config: Option<&InterfaceConfig>,
+        programs: &mut [Program],
+    ) -> Result<bool, BpfmanError> {
+        debug!("Dispatcher::update()");
+        match self {
+            Dispatcher::Xdp(d) => d.update(config, programs),
+            Dispatcher::Tc(d) => d.update(config, programs),
+        }
+    }
+
     pub(crate) fn new_from_db(db_tree: sled::Tree) -> Dispatcher {
         if bytes_to_string(&db_tree.name()).contains("xdp") {
             Dispatcher::Xdp(XdpDispatcher::new_from_db(db_tree))
@@ -104,6 +145,20 @@ impl Dispatcher {
         current.wrapping_add(1)
     }
 
+    pub(crate) fn pin_dir(&self) -> Result<PathBuf, BpfmanError> {
+        match self {
+            Dispatcher::Xdp(d) => d.pin_dir(),
+            Dispatcher::Tc(d) => d.pin_dir(),
+        }
+    }
+
+    pub(crate) fn slot_layout(&self) -> Result<Option<SlotLayout>, BpfmanError> {
+        match self {
+            Dispatcher::Xdp(d) => d.slot_layout(),
+            Dispatcher::Tc(d) => d.slot_layout(),
+        }
+    }
+
     pub(crate) fn num_extensions(&self) -> usize {
         match self {
             Dispatcher::Xdp(d) => d
@@ -116,6 +171,133 @@ impl Dispatcher {
     }
 }
 
+/// The slots of a loaded dispatcher: the chain call actions each enabled slot
+/// was loaded with and the id of the program currently attached to it, if
+/// any. Slots past the last program are spare slots and run the stub.
+#[derive(Debug, Clone, PartialEq)]
+pub(crate) struct SlotLayout {
+    pub(crate) actions: Vec<u32>,
+    pub(crate) programs: Vec<Option<u32>>,
+}
+
+impl SlotLayout {
+    pub(crate) fn store(&self, db_tree: &sled::Tree) -> Result<(), BpfmanError> {
+        sled_insert(db_tree, ENABLED_SLOTS, &self.actions.len().to_ne_bytes())?;
+        for (slot, actions) in self.actions.iter().enumerate() {
+            sled_insert(
+                db_tree,
+                &format!("{SLOT_ACTIONS_PREFIX}{slot}"),
+                &actions.to_ne_bytes(),
+            )?;
+        }
+        for (slot, id) in self.programs.iter().enumerate() {
+            set_slot_program(db_tree, slot, *id)?;
+        }
+        Ok(())
+    }
+
+    /// Returns the slot layout stored for a dispatcher, or None for
+    /// dispatchers loaded before the layout was recorded.
+    pub(crate) fn load(db_tree: &sled::Tree) -> Result<Option<Self>, BpfmanError> {
+        let Some(enabled) = sled_get_option(db_tree, ENABLED_SLOTS)?.map(bytes_to_usize) else {
+            return Ok(None);
+        };
+        let mut layout = SlotLayout {
+            actions: Vec::with_capacity(enabled),
+            programs: Vec::with_capacity(enabled),
+        };
+        for slot in 0..enabled {
+            let Some(actions) = sled_get_option(db_tree, &format!("{SLOT_ACTIONS_PREFIX}{slot}"))?
+            else {
+                return Ok(None);
+            };
+            layout.actions.push(bytes_to_u32(actions));
+            layout.programs.push(
+                sled_get_option(db_tree, &format!("{SLOT_PROGRAM_PREFIX}{slot}"))?
+                    .map(bytes_to_u32)
+                    .filter(|id| *id != 0),
+            );
+        }
+        Ok(Some(layout))
+    }
+}
+
+/// Records the program attached to a dispatcher slot. Program ids are never 0,
+/// so 0 marks an empty slot.
+pub(crate) fn set_slot_program(
+    db_tree: &sled::Tree,
+    slot: usize,
+    id: Option<u32>,
+) -> Result<(), BpfmanError> {
+    sled_insert(
+        db_tree,
+        &format!("{SLOT_PROGRAM_PREFIX}{slot}"),
+        &id.unwrap_or(0).to_ne_bytes(),
+    )
+}
+
+/// A change to a single slot of a loaded dispatcher.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum SlotUpdate {
+    /// Attach the program at this position to the empty slot.
+    Attach(usize),
+    /// Detach the program with the given id, which is no longer wanted, from
+    /// the slot.
+    Detach(usize, u32),
+}
+
+/// Works out whether a loaded dispatcher can be brought to the `desired`
+/// programs, given in position order as (id, chain call actions) with no id
+/// for programs that haven't been loaded yet, by only touching the slots that
+/// change. Returns None when a new dispatcher has to be loaded instead.
+///
+/// The chain call actions are frozen when a dispatcher is loaded, so this is
+/// only possible when every program that stays keeps its slot, every new
+/// program lands in an empty slot loaded with matching actions and every slot
+/// past the last program lets the stub's `retval` fall through. The last
+/// program's actions only have to match up to the `fallthrough` verdict,
+/// which is what the dispatcher returns once it runs out of programs anyway.
+pub(crate) fn plan_slot_updates(
+    layout: &SlotLayout,
+    desired: &[(Option<u32>, u32)],
+    fallthrough: u32,
+    retval: u32,
+) -> Option<Vec<SlotUpdate>> {
+    let num_programs = desired.len();
+    if num_programs == 0 || num_programs > layout.actions.len() {
+        return None;
+    }
+
+    let mut updates = vec![];
+    for (slot, (actions, current)) in layout.actions.iter().zip(&layout.programs).enumerate() {
+        let Some((id, mask)) = desired.get(slot) else {
+            if actions & retval == 0 {
+                return None;
+            }
+            if let Some(current) = current {
+                updates.push(SlotUpdate::Detach(slot, *current));
+            }
+            continue;
+        };
+
+        let compatible = if slot + 1 < num_programs {
+            actions == mask
+        } else {
+            (actions ^ mask) & !fallthrough == 0
+        };
+        if !compatible {
+            return None;
+        }
+
+        match (current, id) {
+            (Some(current), Some(id)) if current == id => {}
+            (None, None) => updates.push(SlotUpdate::Attach(slot)),
+            _ => return None,
+        }
+    }
+    Some(updates)
+}
+
 #[derive(Debug, Clone, Hash, Eq, PartialEq)]
 pub(crate) enum DispatcherId {
     Xdp(DispatcherInfo),
@@ -124,3 +306,220 @@ pub(crate) enum DispatcherId {
 
 #[derive(Debug, Clone, Hash, Eq, PartialEq)]
 pub(crate) struct DispatcherInfo(pub u32, pub Option<Direction>);
+
+lazy_static! {
+    // One lock per dispatcher, so that programs attached to different
+    // interfaces, or directions, are added and removed concurrently.
+    static ref DISPATCHER_LOCKS: std::sync::Mutex<HashMap<DispatcherId, Arc<Mutex<()>>>> =
+        std::sync::Mutex::new(HashMap::new());
+}
+
+/// Waits for the programs of the dispatcher `did` to be left alone by other
+/// calls. The returned guard must be held while the dispatcher, and the
+/// positions of its programs, are updated.
+pub(crate) async fn lock_dispatcher(did: &DispatcherId) -> OwnedMutexGuard<()> {
+    let lock = {
+        let mut locks = DISPATCHER_LOCKS.lock().unwrap();
+        // Forget the locks nobody holds or waits for.
+        locks.retain(|_, l| Arc::strong_count(l) > 1);
+        locks.entry(did.clone()).or_default().clone()
+    };
+    lock.lock_owned().await
+}
+
+/// Walks the pin directory of a dispatcher type and returns the
+/// (if_index, revision, stats map path) of every dispatcher that has a pinned
+/// stats map. Dispatcher directories are named `dispatcher_{if_index}_{revision}`.
+pub(crate) fn find_dispatcher_stats_pins(
+    base: &str,
+) -> Result<Vec<(u32, u32, std::path::PathBuf)>, BpfmanError> {
+    let mut pins = vec![];
+    let entries = match fs::read_dir(base) {
+        Ok(entries) => entries,
+        Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(pins),
+        Err(e) => {
+            return Err(BpfmanError::Error(format!(
+                "unable to read dispatcher directory {base}: {e}"
+            )))
+        }
+    };
+
+    for entry in entries.flatten() {
+        let name = entry.file_name().to_string_lossy().to_string();
+        let Some(suffix) = name.strip_prefix("dispatcher_") else {
+            continue;
+        };
+        let Some((if_index, revision)) = suffix.split_once('_') else {
+            continue;
+        };
+        let (Ok(if_index), Ok(revision)) = (if_index.parse::<u32>(), revision.parse::<u32>())
+        else {
+            continue;
+        };
+        let path = entry.path().join(DISPATCHER_STATS_PIN);
+        if path.exists() {
+            pins.push((if_index, revision, path));
+        }
+    }
+    Ok(pins)
+}
+
+/// Reads a pinned dispatcher stats map and returns the stats of each slot,
+/// summed across all CPUs.
+pub(crate) fn read_dispatcher_stats(
+    path: &Path,
+) -> Result<Vec<(u32, DispatcherSlotStatsRaw)>, BpfmanError> {
+    let map_data = MapData::from_pin(path).map_err(|e| {
+        BpfmanError::Error(format!(
+            "unable to open dispatcher stats map {}: {e}",
+            path.display()
+        ))
+    })?;
+    let stats: PerCpuArray<_, DispatcherSlotStatsRaw> = Map::PerCpuArray(map_data)
+        .try_into()
+        .map_err(|e| BpfmanError::Error(format!("invalid dispatcher stats map: {e}")))?;
+
+    let mut result = vec![];
+    for slot in 0..stats.len() {
+        let values = stats
+            .get(&slot, 0)
+            .map_err(|e| BpfmanError::Error(format!("unable to read slot {slot} stats: {e}")))?;
+        let mut total = DispatcherSlotStatsRaw::default();
+        for v in values.iter() {
+            total.count += v.count;
+            total.run_time_ns += v.run_time_ns;
+            for (t, c) in total.verdicts.iter_mut().zip(v.verdicts.iter()) {
+                *t += c;
+            }
+            for (t, c) in total.latency.iter_mut().zip(v.latency.iter()) {
+                *t += c;
+            }
+        }
+        result.push((slot, total));
+    }
+    Ok(result)
+}
+
+/// Returns the ids of the programs attached to the dispatcher whose pin
+/// directory is `dir`, indexed by slot. `links` maps the id of each loaded
+/// program to the id of its newest link.
+///
+/// The slots in use are always the first ones and programs are only attached
+/// after those already there, each with a new link, both when a revision is
+/// loaded and when it is updated in place (see `plan_slot_updates`). Link ids
+/// only grow, so ordering the extension links pinned in the directory by link
+/// id gives their slots without reading the database.
+pub(crate) fn find_dispatcher_slot_programs(dir: &Path, links: &HashMap<u32, u32>) -> Vec<u32> {
+    let Ok(entries) = fs::read_dir(dir) else {
+        return vec![];
+    };
+
+    let mut programs: Vec<(u32, u32)> = entries
+        .flatten()
+        .filter_map(|entry| {
+            let name = entry.file_name();
+            let prog_id = name.to_str()?.strip_prefix("link_")?.parse::<u32>().ok()?;
+            Some((*links.get(&prog_id)?, prog_id))
+        })
+        .collect();
+    programs.sort_unstable();
+    programs.into_iter().map(|(_, prog_id)| prog_id).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use std::time::Duration;
+
+    use super::*;
+
+    const PASS: u32 = 1 << 2;
+    const DROP: u32 = 1 << 1;
+    const RETVAL: u32 = 1 << 31;
+
+    fn layout(actions: &[u32], programs: &[Option<u32>]) -> SlotLayout {
+        SlotLayout {
+            actions: actions.to_vec(),
+            programs: programs.to_vec(),
+        }
+    }
+
+    #[test]
+    fn test_plan_slot_updates() {
+        let proceed = PASS | RETVAL;
+        let spare = RETVAL;
+
+        // Appending into a spare slot only attaches the new program.
+        let l = layout(&[proceed, spare, spare], &[Some(1), None, None]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(Some(1), proceed), (None, proceed)], PASS, RETVAL),
+            Some(vec![SlotUpdate::Attach(1)])
+        );
+
+        // Removing the last program only detaches it.
+        let l = layout(&[proceed, proceed], &[Some(1), Some(2)]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(Some(1), proceed)], PASS, RETVAL),
+            Some(vec![SlotUpdate::Detach(1, 2)])
+        );
+
+        // No spare slot left.
+        let l = layout(&[proceed], &[Some(1)]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(Some(1), proceed), (None, proceed)], PASS, RETVAL),
+            None
+        );
+
+        // Inserting in front of an existing program moves it.
+        let l = layout(&[proceed, spare], &[Some(1), None]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(None, proceed), (Some(1), proceed)], PASS, RETVAL),
+            None
+        );
+
+        // The previous last program now has to proceed to the new one.
+        let l = layout(&[RETVAL, spare], &[Some(1), None]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(Some(1), proceed), (None, proceed)], PASS, RETVAL),
+            None
+        );
+
+        // A removed slot whose actions don't proceed on the stub's return
+        // value would leak that value to the kernel.
+        let l = layout(&[proceed, DROP], &[Some(1), Some(2)]);
+        assert_eq!(
+            plan_slot_updates(&l, &[(Some(1), proceed)], PASS, RETVAL),
+            None
+        );
+    }
+
+    #[test]
+    fn test_find_dispatcher_slot_programs() {
+        let dir = std::env::temp_dir().join(format!("bpfman-slots-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        for name in ["link_7", "link_3", "link_9", "stats", "dispatcher"] {
+            fs::write(dir.join(name), b"").unwrap();
+        }
+
+        // Program 9 is no longer loaded.
+        let links = HashMap::from([(7, 20), (3, 21), (12, 5)]);
+        assert_eq!(find_dispatcher_slot_programs(&dir, &links), vec![7, 3]);
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[tokio::test]
+    async fn test_lock_dispatcher() {
+        // Interface indexes no other test uses.
+        let ingress = DispatcherId::Tc(DispatcherInfo(9001, Some(Direction::Ingress)));
+        let egress = DispatcherId::Tc(DispatcherInfo(9001, Some(Direction::Egress)));
+
+        let _guard = lock_dispatcher(&ingress).await;
+        // Another direction of the same interface isn't held up.
+        drop(lock_dispatcher(&egress).await);
+        assert!(
+            tokio::time::timeout(Duration::from_millis(50), lock_dispatcher(&ingress))
+                .await
+                .is_err()
+        );
+    }
+}
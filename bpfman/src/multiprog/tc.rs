@@ -1,42 +1,64 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::{fs, mem};
+use std::{
+    collections::HashMap,
+    fs, mem,
+    path::{Path, PathBuf},
+};
 
 use aya::{
     programs::{
         links::FdLink,
         tc::{self, SchedClassifierLink, TcOptions},
-        Extension, Link, SchedClassifier, TcAttachType,
+        Extension, Link, ProgramFd, ProgramInfo, SchedClassifier, TcAttachType,
     },
     Bpf, BpfLoader,
 };
 use futures::stream::TryStreamExt;
-use log::debug;
+use log::{debug, warn};
 use netlink_packet_route::tc::TcAttribute;
 use sled::Db;
+use tokio::sync::Mutex;
 
 use crate::{
-    calc_map_pin_path, create_map_pin_path,
+    calc_map_pin_path,
+    config::InterfaceConfig,
+    create_map_pin_path,
     directories::*,
-    dispatcher_config::TcDispatcherConfig,
+    dispatcher_config::{
+        TcDispatcherConfig, DISPATCHER_FLAG_STATS, EXTENDED_DISPATCHER_ACTIONS,
+        TC_DISPATCHER_STATS_MAP, TC_MAX_DISPATCHER_ACTIONS,
+    },
     errors::BpfmanError,
-    multiprog::{Dispatcher, TC_DISPATCHER_PREFIX},
+    multiprog::{
+        find_dispatcher_slot_programs, find_dispatcher_stats_pins, plan_slot_updates,
+        read_dispatcher_stats, set_slot_program, Dispatcher, SlotLayout, SlotUpdate,
+        DISPATCHER_PROGRAM_PIN, DISPATCHER_STATS_PIN, TC_DISPATCHER_PREFIX,
+    },
     oci_utils::image_manager::ImageManager,
     types::{
         BytecodeImage, Direction,
         Direction::{Egress, Ingress},
-        ImagePullPolicy, Program, TcProgram,
+        DispatcherSlotStats, ImagePullPolicy, Program, ProgramType, TcProceedOnEntry, TcProgram,
     },
     utils::{
-        bytes_to_string, bytes_to_u16, bytes_to_u32, bytes_to_usize, should_map_be_pinned,
-        sled_get, sled_get_option, sled_insert,
+        bytes_to_bool, bytes_to_string, bytes_to_u16, bytes_to_u32, bytes_to_usize,
+        should_map_be_pinned, sled_get, sled_get_option, sled_insert,
     },
 };
 
 const DEFAULT_PRIORITY: u32 = 50; // Default priority for user programs in the dispatcher
 const TC_DISPATCHER_PRIORITY: u16 = 50; // Default TC priority for TC Dispatcher
 
+const TC_DISPATCHER_IMAGE: &str = "quay.io/bpfman/tc-dispatcher:v1";
+
+/// Chain call actions of a spare slot: the stub's return value falls through
+/// to the next slot.
+const SPARE_SLOT_ACTIONS: u32 = 1 << (TcProceedOnEntry::DispatcherReturn as i32 + 1);
+/// The verdict the dispatcher returns once it runs out of programs.
+const FALLTHROUGH_ACTIONS: u32 = 1 << (TcProceedOnEntry::Ok as i32 + 1);
+
 /// These constants define the key of SLED DB
 const REVISION: &str = "revision";
 const IF_INDEX: &str = "if_index";
@@ -46,6 +68,8 @@ const DIRECTION: &str = "direction";
 const NUM_EXTENSIONS: &str = "num_extension";
 const PROGRAM_NAME: &str = "program_name";
 const HANDLE: &str = "handle";
+const COLLECT_STATS: &str = "collect_stats";
+const SPARE_SLOTS: &str = "spare_slots";
 
 #[derive(Debug)]
 pub struct TcDispatcher {
@@ -56,6 +80,7 @@ pub struct TcDispatcher {
 impl TcDispatcher {
     pub(crate) fn new(
         root_db: &Db,
+        config: Option<&InterfaceConfig>,
         direction: Direction,
         if_index: u32,
         if_name: String,
@@ -78,6 +103,8 @@ impl TcDispatcher {
         dp.set_direction(direction)?;
         dp.set_revision(revision)?;
         dp.set_priority(TC_DISPATCHER_PRIORITY)?;
+        dp.set_collect_stats(config.map(|c| c.collect_stats()).unwrap_or(false))?;
+        dp.set_spare_slots(config.map(|c| c.spare_dispatcher_slots()).unwrap_or(0))?;
         Ok(dp)
     }
 
@@ -94,7 +121,7 @@ impl TcDispatcher {
         root_db: &Db,
         programs: &mut [Program],
         old_dispatcher: Option<Dispatcher>,
-        image_manager: &mut ImageManager,
+        image_manager: &Mutex<ImageManager>,
     ) -> Result<(), BpfmanError> {
         let if_index = self.get_ifindex()?;
         let revision = self.get_revision()?;
@@ -108,40 +135,54 @@ impl TcDispatcher {
                 _ => panic!("All programs should be of type TC"),
             })
             .collect();
-        let mut chain_call_actions = [0; 10];
-        for v in extensions.iter() {
-            chain_call_actions[v.get_current_position()?.unwrap()] = v.get_proceed_on()?.mask()
-        }
-
-        let config = TcDispatcherConfig {
-            num_progs_enabled: extensions.len() as u8,
-            chain_call_actions,
-            run_prios: [DEFAULT_PRIORITY; 10],
-        };
 
-        debug!("tc dispatcher config: {:?}", config);
+        let slots = dispatcher_slots(extensions.len());
+        let enabled = slots.min(extensions.len() + self.get_spare_slots()?);
         let image = BytecodeImage::new(
-            "quay.io/bpfman/tc-dispatcher:v1".to_string(),
+            tc_dispatcher_image(slots),
             ImagePullPolicy::IfNotPresent as i32,
             None,
             None,
         );
 
-        let (path, bpf_function_name) = image_manager
-            .get_image(
-                root_db,
-                &image.image_url,
-                image.image_pull_policy.clone(),
-                image.username.clone(),
-                image.password.clone(),
+        let (program_bytes, bpf_function_name) = {
+            let mut image_manager = image_manager.lock().await;
+            let (path, bpf_function_name) = image_manager
+                .get_image(
+                    root_db,
+                    &image.image_url,
+                    image.image_pull_policy.clone(),
+                    image.username.clone(),
+                    image.password.clone(),
+                )
+                .await?;
+            (
+                image_manager.get_bytecode_from_image_store(root_db, path)?,
+                bpf_function_name,
             )
-            .await?;
+        };
 
-        let program_bytes = image_manager.get_bytecode_from_image_store(root_db, path)?;
+        let collect_stats = self.get_collect_stats()?;
+        let dispatcher_flags = if collect_stats {
+            DISPATCHER_FLAG_STATS
+        } else {
+            0
+        };
 
-        let mut loader = BpfLoader::new()
-            .set_global("CONFIG", &config, true)
-            .load(&program_bytes)?;
+        let mut loader = match slots {
+            TC_MAX_DISPATCHER_ACTIONS => load_tc_dispatcher::<TC_MAX_DISPATCHER_ACTIONS>(
+                &program_bytes,
+                &extensions,
+                enabled,
+                dispatcher_flags,
+            )?,
+            _ => load_tc_dispatcher::<EXTENDED_DISPATCHER_ACTIONS>(
+                &program_bytes,
+                &extensions,
+                enabled,
+                dispatcher_flags,
+            )?,
+        };
 
         let dispatcher: &mut SchedClassifier =
             loader.program_mut(&bpf_function_name).unwrap().try_into()?;
@@ -153,17 +194,127 @@ impl TcDispatcher {
             Egress => RTDIR_FS_TC_EGRESS,
         };
         let path = format!("{base}/dispatcher_{if_index}_{revision}");
-        fs::create_dir_all(path).unwrap();
+        fs::create_dir_all(&path).unwrap();
+
+        // Keep the dispatcher program around so later updates can attach
+        // extensions to it without loading a new dispatcher.
+        dispatcher
+            .pin(format!("{path}/{DISPATCHER_PROGRAM_PIN}"))
+            .map_err(BpfmanError::UnableToPinProgram)?;
+
+        if collect_stats {
+            match loader.map_mut(TC_DISPATCHER_STATS_MAP) {
+                Some(map) => map
+                    .pin(format!("{path}/{DISPATCHER_STATS_PIN}"))
+                    .map_err(BpfmanError::UnableToPinMap)?,
+                None => warn!(
+                    "tc dispatcher image does not support stats collection, ignoring collect_stats for if_index {if_index}"
+                ),
+            }
+        }
 
         self.loader = Some(loader);
         self.set_num_extensions(extensions.len())?;
         self.set_program_name(&bpf_function_name)?;
 
         self.attach_extensions(&mut extensions)?;
+        slot_layout(&extensions, enabled)?.store(&self.db_tree)?;
         self.attach(root_db, old_dispatcher).await?;
         Ok(())
     }
 
+    /// Tries to bring the running dispatcher to the given programs by only
+    /// attaching and detaching the slots that change. Returns false, without
+    /// changing anything, if a new dispatcher has to be loaded instead.
+    pub(crate) fn update(
+        &mut self,
+        config: Option<&InterfaceConfig>,
+        programs: &mut [Program],
+    ) -> Result<bool, BpfmanError> {
+        let if_index = self.get_ifindex()?;
+        let revision = self.get_revision()?;
+        let direction = self.get_direction()?;
+
+        let Some(layout) = SlotLayout::load(&self.db_tree)? else {
+            return Ok(false);
+        };
+
+        // Changing dispatcher options requires a new dispatcher.
+        if config.map(|c| c.collect_stats()).unwrap_or(false) != self.get_collect_stats()?
+            || config.map(|c| c.spare_dispatcher_slots()).unwrap_or(0) != self.get_spare_slots()?
+        {
+            return Ok(false);
+        }
+
+        let mut extensions: Vec<&mut TcProgram> = programs
+            .iter_mut()
+            .map(|v| match v {
+                Program::Tc(p) => p,
+                _ => panic!("All programs should be of type TC"),
+            })
+            .collect();
+
+        extensions.sort_by(|a, b| {
+            a.get_current_position()
+                .unwrap()
+                .cmp(&b.get_current_position().unwrap())
+        });
+
+        if dispatcher_slots(extensions.len()) != dispatcher_slots(self.get_num_extensions()?) {
+            return Ok(false);
+        }
+
+        let mut desired = Vec::with_capacity(extensions.len());
+        for v in extensions.iter() {
+            let id = if v.get_attached()? {
+                Some(v.get_data().get_id()?)
+            } else {
+                None
+            };
+            desired.push((id, v.get_proceed_on()?.mask()));
+        }
+
+        let Some(updates) =
+            plan_slot_updates(&layout, &desired, FALLTHROUGH_ACTIONS, SPARE_SLOT_ACTIONS)
+        else {
+            return Ok(false);
+        };
+
+        let base = match direction {
+            Ingress => RTDIR_FS_TC_INGRESS,
+            Egress => RTDIR_FS_TC_EGRESS,
+        };
+        let path = format!("{base}/dispatcher_{if_index}_{revision}");
+        let dispatcher_pin = format!("{path}/{DISPATCHER_PROGRAM_PIN}");
+        if !Path::new(&dispatcher_pin).exists() {
+            return Ok(false);
+        }
+        let dispatcher_fd = ProgramInfo::from_pin(&dispatcher_pin)?.fd()?;
+
+        debug!(
+            "TcDispatcher::update() for if_index {}, revision {}: {:?}",
+            if_index, revision, updates
+        );
+        for update in updates {
+            match update {
+                SlotUpdate::Detach(slot, id) => {
+                    // The pinned link is the last reference to it, so removing
+                    // the pin detaches the program and the slot runs the stub.
+                    fs::remove_file(format!("{path}/link_{id}"))
+                        .map_err(|e| BpfmanError::Error(format!("unable to detach {id}: {e}")))?;
+                    set_slot_program(&self.db_tree, slot, None)?;
+                }
+                SlotUpdate::Attach(slot) => {
+                    let v = &mut extensions[slot];
+                    self.attach_extension(&dispatcher_fd, slot, v)?;
+                    set_slot_program(&self.db_tree, slot, Some(v.get_data().get_id()?))?;
+                }
+            }
+        }
+        self.set_num_extensions(extensions.len())?;
+        Ok(true)
+    }
+
     /// has_qdisc returns true if the qdisc_name is found on the if_index.
     async fn has_qdisc(qdisc_name: String, if_index: i32) -> Result<bool, anyhow::Error> {
         let (connection, handle, _) = rtnetlink::new_connection().unwrap();
@@ -269,7 +420,6 @@ impl TcDispatcher {
     fn attach_extensions(&mut self, extensions: &mut [&mut TcProgram]) -> Result<(), BpfmanError> {
         let if_index = self.get_ifindex()?;
         let revision = self.get_revision()?;
-        let direction = self.get_direction()?;
         let program_name = self.get_program_name()?;
 
         debug!(
@@ -283,6 +433,7 @@ impl TcDispatcher {
             .program_mut(program_name.as_str())
             .unwrap()
             .try_into()?;
+        let dispatcher_fd = dispatcher.fd()?.try_clone()?;
 
         extensions.sort_by(|a, b| {
             a.get_current_position()
@@ -291,89 +442,102 @@ impl TcDispatcher {
         });
 
         for (i, v) in extensions.iter_mut().enumerate() {
-            if v.get_attached()? {
-                let id = v.data.get_id()?;
-                debug!("program {id} was already attached loading from pin");
-                let mut ext = Extension::from_pin(format!("{RTDIR_FS}/prog_{id}"))?;
-                let target_fn = format!("prog{i}");
-                let new_link_id = ext
-                    .attach_to_program(dispatcher.fd().unwrap(), &target_fn)
-                    .unwrap();
-                let new_link: FdLink = ext.take_link(new_link_id)?.into();
-                let base = match direction {
-                    Direction::Ingress => RTDIR_FS_TC_INGRESS,
-                    Direction::Egress => RTDIR_FS_TC_EGRESS,
-                };
-                let path = format!("{base}/dispatcher_{if_index}_{}/link_{id}", revision);
-                new_link.pin(path).map_err(BpfmanError::UnableToPinLink)?;
-            } else {
-                let name = &v.data.get_name()?;
-                let global_data = &v.data.get_global_data()?;
+            self.attach_extension(&dispatcher_fd, i, v)?;
+        }
+        Ok(())
+    }
+
+    /// Attaches a program to slot `i` of the dispatcher, loading it first if
+    /// it isn't loaded yet.
+    fn attach_extension(
+        &self,
+        dispatcher_fd: &ProgramFd,
+        i: usize,
+        v: &mut TcProgram,
+    ) -> Result<(), BpfmanError> {
+        let if_index = self.get_ifindex()?;
+        let revision = self.get_revision()?;
+        let direction = self.get_direction()?;
+        if v.get_attached()? {
+            let id = v.data.get_id()?;
+            debug!("program {id} was already attached loading from pin");
+            let mut ext = Extension::from_pin(format!("{RTDIR_FS}/prog_{id}"))?;
+            let target_fn = format!("prog{i}");
+            let new_link_id = ext.attach_to_program(dispatcher_fd, &target_fn).unwrap();
+            let new_link: FdLink = ext.take_link(new_link_id)?.into();
+            let base = match direction {
+                Direction::Ingress => RTDIR_FS_TC_INGRESS,
+                Direction::Egress => RTDIR_FS_TC_EGRESS,
+            };
+            let path = format!("{base}/dispatcher_{if_index}_{}/link_{id}", revision);
+            new_link.pin(path).map_err(BpfmanError::UnableToPinLink)?;
+        } else {
+            let name = &v.data.get_name()?;
+            let global_data = &v.data.get_global_data()?;
 
-                let mut bpf = BpfLoader::new();
+            let mut bpf = BpfLoader::new();
 
-                bpf.allow_unsupported_maps().extension(name);
+            bpf.allow_unsupported_maps().extension(name);
 
-                for (name, value) in global_data {
-                    bpf.set_global(name, value.as_slice(), true);
-                }
+            for (name, value) in global_data {
+                bpf.set_global(name, value.as_slice(), true);
+            }
 
-                // If map_pin_path is set already it means we need to use a pin
-                // path which should already exist on the system.
-                if let Some(map_pin_path) = v.data.get_map_pin_path()? {
-                    debug!("tc program {name} is using maps from {:?}", map_pin_path);
-                    bpf.map_pin_path(map_pin_path);
-                }
+            // If map_pin_path is set already it means we need to use a pin
+            // path which should already exist on the system.
+            if let Some(map_pin_path) = v.data.get_map_pin_path()? {
+                debug!("tc program {name} is using maps from {:?}", map_pin_path);
+                bpf.map_pin_path(map_pin_path);
+            }
 
-                let mut loader = bpf
-                    .load(&v.get_data().get_program_bytes()?)
-                    .map_err(BpfmanError::BpfLoadError)?;
+            let mut loader = bpf
+                .load(&v.get_data().get_program_bytes()?)
+                .map_err(BpfmanError::BpfLoadError)?;
 
-                let ext: &mut Extension = loader
-                    .program_mut(name)
-                    .ok_or_else(|| BpfmanError::BpfFunctionNameNotValid(name.to_string()))?
-                    .try_into()?;
+            let ext: &mut Extension = loader
+                .program_mut(name)
+                .ok_or_else(|| BpfmanError::BpfFunctionNameNotValid(name.to_string()))?
+                .try_into()?;
 
-                let target_fn = format!("prog{i}");
+            let target_fn = format!("prog{i}");
 
-                ext.load(dispatcher.fd()?.try_clone()?, &target_fn)?;
-                v.data.set_kernel_info(&ext.info()?)?;
+            ext.load(dispatcher_fd.try_clone()?, &target_fn)?;
+            v.data.set_kernel_info(&ext.info()?)?;
 
-                let id = v.get_data().get_id()?;
+            let id = v.get_data().get_id()?;
 
-                ext.pin(format!("{RTDIR_FS}/prog_{id}"))
-                    .map_err(BpfmanError::UnableToPinProgram)?;
-                let new_link_id = ext.attach()?;
-                let new_link = ext.take_link(new_link_id)?;
-                let fd_link: FdLink = new_link.into();
-                let base = match direction {
-                    Direction::Ingress => RTDIR_FS_TC_INGRESS,
-                    Direction::Egress => RTDIR_FS_TC_EGRESS,
-                };
-                fd_link
-                    .pin(format!(
-                        "{base}/dispatcher_{if_index}_{}/link_{id}",
-                        revision,
-                    ))
-                    .map_err(BpfmanError::UnableToPinLink)?;
-
-                // If this program is the map(s) owner pin all maps (except for .rodata and .bss) by name.
-                if v.data.get_map_pin_path()?.is_none() {
-                    let map_pin_path = calc_map_pin_path(id);
-                    v.data.set_map_pin_path(&map_pin_path.clone())?;
-                    create_map_pin_path(&map_pin_path)?;
-
-                    for (name, map) in loader.maps_mut() {
-                        if !should_map_be_pinned(name) {
-                            continue;
-                        }
-                        debug!(
-                            "Pinning map: {name} to path: {}",
-                            map_pin_path.join(name).display()
-                        );
-                        map.pin(map_pin_path.join(name))
-                            .map_err(BpfmanError::UnableToPinMap)?;
+            ext.pin(format!("{RTDIR_FS}/prog_{id}"))
+                .map_err(BpfmanError::UnableToPinProgram)?;
+            let new_link_id = ext.attach()?;
+            let new_link = ext.take_link(new_link_id)?;
+            let fd_link: FdLink = new_link.into();
+            let base = match direction {
+                Direction::Ingress => RTDIR_FS_TC_INGRESS,
+                Direction::Egress => RTDIR_FS_TC_EGRESS,
+            };
+            fd_link
+                .pin(format!(
+                    "{base}/dispatcher_{if_index}_{}/link_{id}",
+                    revision,
+                ))
+                .map_err(BpfmanError::UnableToPinLink)?;
+
+            // If this program is the map(s) owner pin all maps (except for .rodata and .bss) by name.
+            if v.data.get_map_pin_path()?.is_none() {
+                let map_pin_path = calc_map_pin_path(id);
+                v.data.set_map_pin_path(&map_pin_path.clone())?;
+                create_map_pin_path(&map_pin_path)?;
+
+                for (name, map) in loader.maps_mut() {
+                    if !should_map_be_pinned(name) {
+                        continue;
                     }
+                    debug!(
+                        "Pinning map: {name} to path: {}",
+                        map_pin_path.join(name).display()
+                    );
+                    map.pin(map_pin_path.join(name))
+                        .map_err(BpfmanError::UnableToPinMap)?;
                 }
             }
         }
@@ -438,6 +602,56 @@ impl TcDispatcher {
         Ok(())
     }
 
+    /// Returns the per-slot stats of every TC dispatcher that was loaded with
+    /// stats collection enabled, for both directions. This only relies on the
+    /// pinned stats maps, so it doesn't require access to the database.
+    pub(crate) fn list_stats(
+        links: &HashMap<u32, u32>,
+    ) -> Result<Vec<DispatcherSlotStats>, BpfmanError> {
+        let mut result = vec![];
+        for (base, direction) in [(RTDIR_FS_TC_INGRESS, Ingress), (RTDIR_FS_TC_EGRESS, Egress)] {
+            for (if_index, revision, path) in find_dispatcher_stats_pins(base)? {
+                let programs = path
+                    .parent()
+                    .map(|dir| find_dispatcher_slot_programs(dir, links))
+                    .unwrap_or_default();
+                for (slot, stats) in read_dispatcher_stats(&path)? {
+                    result.push(DispatcherSlotStats {
+                        kind: ProgramType::Tc,
+                        if_index,
+                        direction: Some(direction),
+                        revision,
+                        slot,
+                        prog_id: programs.get(slot as usize).copied(),
+                        count: stats.count,
+                        run_time_ns: stats.run_time_ns,
+                        verdicts: stats.verdicts.to_vec(),
+                        latency: stats.latency.to_vec(),
+                    });
+                }
+            }
+        }
+        Ok(result)
+    }
+
+    /// Returns the directory the dispatcher program and the links of its
+    /// extensions are pinned in.
+    pub(crate) fn pin_dir(&self) -> Result<PathBuf, BpfmanError> {
+        let base = match self.get_direction()? {
+            Direction::Ingress => RTDIR_FS_TC_INGRESS,
+            Direction::Egress => RTDIR_FS_TC_EGRESS,
+        };
+        Ok(PathBuf::from(format!(
+            "{base}/dispatcher_{}_{}",
+            self.get_ifindex()?,
+            self.get_revision()?
+        )))
+    }
+
+    pub(crate) fn slot_layout(&self) -> Result<Option<SlotLayout>, BpfmanError> {
+        SlotLayout::load(&self.db_tree)
+    }
+
     pub(crate) fn set_revision(&mut self, revision: u32) -> Result<(), BpfmanError> {
         sled_insert(&self.db_tree, REVISION, &revision.to_ne_bytes())
     }
@@ -503,4 +717,96 @@ impl TcDispatcher {
     pub(crate) fn get_handle(&self) -> Result<Option<u32>, BpfmanError> {
         sled_get_option(&self.db_tree, HANDLE).map(|v| v.map(bytes_to_u32))
     }
+
+    pub(crate) fn set_collect_stats(&mut self, collect_stats: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            COLLECT_STATS,
+            &(collect_stats as i8).to_ne_bytes(),
+        )
+    }
+
+    pub(crate) fn get_collect_stats(&self) -> Result<bool, BpfmanError> {
+        sled_get(&self.db_tree, COLLECT_STATS).map(bytes_to_bool)
+    }
+
+    pub(crate) fn set_spare_slots(&mut self, spare_slots: usize) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, SPARE_SLOTS, &spare_slots.to_ne_bytes())
+    }
+
+    pub(crate) fn get_spare_slots(&self) -> Result<usize, BpfmanError> {
+        sled_get(&self.db_tree, SPARE_SLOTS).map(bytes_to_usize)
+    }
+}
+
+/// Returns the number of slots of the dispatcher to load for the given number
+/// of programs. The extended dispatcher is only used once the standard
+/// dispatcher runs out of slots.
+fn dispatcher_slots(num_programs: usize) -> usize {
+    if num_programs > TC_MAX_DISPATCHER_ACTIONS {
+        EXTENDED_DISPATCHER_ACTIONS
+    } else {
+        TC_MAX_DISPATCHER_ACTIONS
+    }
+}
+
+/// Returns the image of the TC dispatcher with the given number of slots.
+fn tc_dispatcher_image(slots: usize) -> String {
+    if slots == TC_MAX_DISPATCHER_ACTIONS {
+        TC_DISPATCHER_IMAGE.to_string()
+    } else {
+        format!("{TC_DISPATCHER_IMAGE}-{slots}")
+    }
+}
+
+/// Loads the TC dispatcher bytecode as a dispatcher with `N` slots configured
+/// for the given extensions, with `enabled` slots enabled.
+fn load_tc_dispatcher<const N: usize>(
+    program_bytes: &[u8],
+    extensions: &[&mut TcProgram],
+    enabled: usize,
+    dispatcher_flags: u32,
+) -> Result<Bpf, BpfmanError> {
+    let config = tc_dispatcher_config::<N>(extensions, enabled)?;
+    debug!("tc dispatcher config: {:?}", config);
+
+    // Older dispatcher images do not define `dispatcher_flags`, so don't
+    // require it to exist.
+    Ok(BpfLoader::new()
+        .set_global("CONFIG", &config, true)
+        .set_global("dispatcher_flags", &dispatcher_flags, false)
+        .load(program_bytes)?)
+}
+
+/// Builds the configuration of a TC dispatcher with `N` slots for the given
+/// extensions. Enabled slots past the last extension are spare slots.
+fn tc_dispatcher_config<const N: usize>(
+    extensions: &[&mut TcProgram],
+    enabled: usize,
+) -> Result<TcDispatcherConfig<N>, BpfmanError> {
+    let mut chain_call_actions = [0; N];
+    chain_call_actions[extensions.len()..enabled].fill(SPARE_SLOT_ACTIONS);
+    for v in extensions.iter() {
+        chain_call_actions[v.get_current_position()?.unwrap()] = v.get_proceed_on()?.mask()
+    }
+
+    Ok(TcDispatcherConfig {
+        num_progs_enabled: enabled as u8,
+        chain_call_actions,
+        run_prios: [DEFAULT_PRIORITY; N],
+    })
+}
+
+/// Returns the slot layout of a dispatcher just loaded for the given
+/// extensions, which must be sorted by position, with `enabled` slots enabled.
+fn slot_layout(extensions: &[&mut TcProgram], enabled: usize) -> Result<SlotLayout, BpfmanError> {
+    let mut layout = SlotLayout {
+        actions: vec![SPARE_SLOT_ACTIONS; enabled],
+        programs: vec![None; enabled],
+    };
+    for (slot, v) in extensions.iter().enumerate() {
+        layout.actions[slot] = v.get_proceed_on()?.mask();
+        layout.programs[slot] = Some(v.get_data().get_id()?);
+    }
+    Ok(layout)
 }
@@ -1,35 +1,68 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::{fs, path::PathBuf};
+use std::{
+    collections::HashMap,
+    fs,
+    path::{Path, PathBuf},
+};
 
 use aya::{
     programs::{
         links::{FdLink, PinnedLink},
-        Extension, Xdp,
+        Extension, ProgramFd, ProgramInfo, Xdp,
     },
     Bpf, BpfLoader,
 };
-use log::debug;
+use log::{debug, warn};
 use sled::Db;
+use tokio::sync::Mutex;
 
 use crate::{
     calc_map_pin_path,
-    config::XdpMode,
+    config::{
+        InterfaceConfig, XdpMode, DEFAULT_VERDICT_CACHE_ENTRIES, DEFAULT_VERDICT_CACHE_TTL_MS,
+    },
     create_map_pin_path,
     directories::*,
-    dispatcher_config::XdpDispatcherConfig,
+    dispatcher_config::{
+        XdpDispatcherConfig, DISPATCHER_FLAG_STATS, DISPATCHER_FLAG_VERDICT_CACHE,
+        EXTENDED_DISPATCHER_ACTIONS, MAX_DISPATCHER_ACTIONS, SINGLE_SLOT_DISPATCHER_ACTIONS,
+        XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT, XDP_DISPATCHER_PROG_FLAG_RX_QUEUES,
+        XDP_DISPATCHER_SLOT_COUNTS, XDP_DISPATCHER_STATS_MAP, XDP_SLOT_RX_QUEUES,
+        XDP_VERDICT_CACHE_MAP, XDP_VERDICT_CACHE_TTL,
+    },
     errors::BpfmanError,
-    multiprog::{Dispatcher, XDP_DISPATCHER_PREFIX},
+    multiprog::{
+        find_dispatcher_slot_programs, find_dispatcher_stats_pins, plan_slot_updates,
+        read_dispatcher_stats, set_slot_program, Dispatcher, SlotLayout, SlotUpdate,
+        DISPATCHER_PROGRAM_PIN, DISPATCHER_STATS_PIN, VERDICT_CACHE_PIN, XDP_DISPATCHER_PREFIX,
+    },
     oci_utils::image_manager::ImageManager,
-    types::{BytecodeImage, ImagePullPolicy, Program, XdpProgram},
+    types::{
+        BytecodeImage, DispatcherSlotStats, ImagePullPolicy, Program, ProgramType,
+        XdpProceedOnEntry, XdpProgram,
+    },
     utils::{
-        bytes_to_string, bytes_to_u32, bytes_to_usize, should_map_be_pinned, sled_get, sled_insert,
+        bpf_function_section, bytes_to_bool, bytes_to_string, bytes_to_u32, bytes_to_u64,
+        bytes_to_usize, should_map_be_pinned, sled_get, sled_get_option, sled_insert,
     },
 };
 
 pub(crate) const DEFAULT_PRIORITY: u32 = 50;
 
+const XDP_DISPATCHER_IMAGE: &str = "quay.io/bpfman/xdp-dispatcher:v2";
+/// Suffix of the dispatcher program that is loaded with BPF_F_XDP_HAS_FRAGS.
+const XDP_DISPATCHER_FRAGS_SUFFIX: &str = "_frags";
+/// Section prefix of XDP programs that support multi-buffer packets.
+const XDP_FRAGS_SECTION: &str = "xdp.frags";
+
+/// Chain call actions of a spare slot: the stub's return value falls through
+/// to the next slot.
+const SPARE_SLOT_ACTIONS: u32 = 1 << XdpProceedOnEntry::DispatcherReturn as u32;
+/// The verdict the dispatcher returns once it runs out of programs.
+const FALLTHROUGH_ACTIONS: u32 = 1 << XdpProceedOnEntry::Pass as u32;
+
 /// These constants define the key of SLED DB
 const REVISION: &str = "revision";
 const IF_INDEX: &str = "if_index";
@@ -37,6 +70,16 @@ const IF_NAME: &str = "if_name";
 const MODE: &str = "mode";
 const NUM_EXTENSIONS: &str = "num_extension";
 const PROGRAM_NAME: &str = "program_name";
+const COLLECT_STATS: &str = "collect_stats";
+const SINGLE_SLOT: &str = "single_slot";
+const SPECIALIZED: &str = "specialized";
+const SPARE_SLOTS: &str = "spare_slots";
+const FRAGS: &str = "frags";
+const FRAGS_UNAVAILABLE: &str = "frags_unavailable";
+const VERDICT_CACHE: &str = "verdict_cache";
+const RX_QUEUES: &str = "rx_queues";
+const VERDICT_CACHE_TTL_MS: &str = "verdict_cache_ttl_ms";
+const VERDICT_CACHE_ENTRIES: &str = "verdict_cache_entries";
 
 #[derive(Debug)]
 pub struct XdpDispatcher {
@@ -47,7 +90,7 @@ pub struct XdpDispatcher {
 impl XdpDispatcher {
     pub(crate) fn new(
         root_db: &Db,
-        mode: &XdpMode,
+        config: Option<&InterfaceConfig>,
         if_index: u32,
         if_name: String,
         revision: u32,
@@ -66,7 +109,21 @@ impl XdpDispatcher {
 
         dp.set_ifindex(if_index)?;
         dp.set_ifname(&if_name)?;
-        dp.set_mode(mode)?;
+        dp.set_mode(config.map(|c| c.xdp_mode()).unwrap_or(&XdpMode::Skb))?;
+        dp.set_collect_stats(config.map(|c| c.collect_stats()).unwrap_or(false))?;
+        dp.set_single_slot(config.map(|c| c.single_slot_dispatcher()).unwrap_or(false))?;
+        dp.set_specialized(config.map(|c| c.specialized_dispatcher()).unwrap_or(false))?;
+        dp.set_spare_slots(config.map(|c| c.spare_dispatcher_slots()).unwrap_or(0))?;
+        dp.set_verdict_cache_ttl_ms(
+            config
+                .map(|c| c.verdict_cache_ttl_ms())
+                .unwrap_or(DEFAULT_VERDICT_CACHE_TTL_MS),
+        )?;
+        dp.set_verdict_cache_entries(
+            config
+                .map(|c| c.verdict_cache_entries())
+                .unwrap_or(DEFAULT_VERDICT_CACHE_ENTRIES),
+        )?;
         dp.set_revision(revision)?;
         Ok(dp)
     }
@@ -84,7 +141,23 @@ impl XdpDispatcher {
         root_db: &Db,
         programs: &mut [Program],
         old_dispatcher: Option<Dispatcher>,
-        image_manager: &mut ImageManager,
+        image_manager: &Mutex<ImageManager>,
+    ) -> Result<(), BpfmanError> {
+        if let Err(e) = self.load_and_attach(root_db, programs, image_manager).await {
+            self.cleanup_failed_load(root_db);
+            return Err(e);
+        }
+        if let Some(mut old) = old_dispatcher {
+            old.delete(root_db, false)?;
+        }
+        Ok(())
+    }
+
+    async fn load_and_attach(
+        &mut self,
+        root_db: &Db,
+        programs: &mut [Program],
+        image_manager: &Mutex<ImageManager>,
     ) -> Result<(), BpfmanError> {
         let if_index = self.get_ifindex()?;
         let revision = self.get_revision()?;
@@ -97,65 +170,284 @@ impl XdpDispatcher {
             })
             .collect();
 
-        let mut chain_call_actions = [0; 10];
         extensions.sort_by(|a, b| {
             a.get_current_position()
                 .unwrap()
                 .cmp(&b.get_current_position().unwrap())
         });
-        for p in extensions.iter() {
-            chain_call_actions[p.get_current_position()?.unwrap()] = p.get_proceed_on()?.mask();
-        }
-
-        let config = XdpDispatcherConfig::new(
-            extensions.len() as u8,
-            0x0,
-            chain_call_actions,
-            [DEFAULT_PRIORITY; 10],
-            [0; 10],
-        );
 
-        debug!("xdp dispatcher config: {:?}", config);
+        let slots = self.dispatcher_slots(extensions.len())?;
+        let enabled = slots.min(extensions.len() + self.get_spare_slots()?);
+        let uniform_actions = if self.get_specialized()? && slots > SINGLE_SLOT_DISPATCHER_ACTIONS {
+            uniform_actions(&extensions, enabled)?
+        } else {
+            None
+        };
         let image = BytecodeImage::new(
-            "quay.io/bpfman/xdp-dispatcher:v2".to_string(),
+            xdp_dispatcher_image(slots, uniform_actions.is_some()),
             ImagePullPolicy::IfNotPresent as i32,
             None,
             None,
         );
 
-        let (path, bpf_function_name) = image_manager
-            .get_image(
-                root_db,
-                &image.image_url.clone(),
-                image.image_pull_policy.clone(),
-                image.username.clone(),
-                image.password.clone(),
+        let (program_bytes, bpf_function_name) = {
+            let mut image_manager = image_manager.lock().await;
+            let (path, bpf_function_name) = image_manager
+                .get_image(
+                    root_db,
+                    &image.image_url.clone(),
+                    image.image_pull_policy.clone(),
+                    image.username.clone(),
+                    image.password.clone(),
+                )
+                .await?;
+            (
+                image_manager.get_bytecode_from_image_store(root_db, path)?,
+                bpf_function_name,
             )
-            .await?;
+        };
 
-        let program_bytes = image_manager.get_bytecode_from_image_store(root_db, path)?;
+        let frags = frags_supported(&mut extensions)?;
 
-        let mut loader = BpfLoader::new()
-            .set_global("conf", &config, true)
-            .load(&program_bytes)?;
+        let collect_stats = self.get_collect_stats()?;
+        let verdict_cache = verdict_cache_used(&extensions)?;
+        let mut dispatcher_flags = 0;
+        if collect_stats {
+            dispatcher_flags |= DISPATCHER_FLAG_STATS;
+        }
+        if verdict_cache {
+            dispatcher_flags |= DISPATCHER_FLAG_VERDICT_CACHE;
+        }
 
-        let dispatcher: &mut Xdp = loader.program_mut(&bpf_function_name).unwrap().try_into()?;
+        let mut options = XdpDispatcherOptions {
+            enabled,
+            spare_actions: uniform_actions.unwrap_or(SPARE_SLOT_ACTIONS),
+            frags,
+            dispatcher_flags,
+            verdict_cache_ttl_ns: self.get_verdict_cache_ttl_ms()? * 1_000_000,
+            // The cache map is preallocated per CPU, so keep it minimal when
+            // it isn't used.
+            verdict_cache_entries: if verdict_cache {
+                self.get_verdict_cache_entries()?
+            } else {
+                1
+            },
+        };
+        let (bytes, exts) = (&program_bytes, &extensions);
+        let load = |opts: &XdpDispatcherOptions| match slots {
+            SINGLE_SLOT_DISPATCHER_ACTIONS => {
+                load_xdp_dispatcher::<SINGLE_SLOT_DISPATCHER_ACTIONS>(bytes, exts, opts)
+            }
+            2 => load_xdp_dispatcher::<2>(bytes, exts, opts),
+            4 => load_xdp_dispatcher::<4>(bytes, exts, opts),
+            8 => load_xdp_dispatcher::<8>(bytes, exts, opts),
+            MAX_DISPATCHER_ACTIONS => {
+                load_xdp_dispatcher::<MAX_DISPATCHER_ACTIONS>(bytes, exts, opts)
+            }
+            _ => load_xdp_dispatcher::<EXTENDED_DISPATCHER_ACTIONS>(bytes, exts, opts),
+        };
+        let mut loader = load(&options)?;
+
+        let frags_name = format!("{bpf_function_name}{XDP_DISPATCHER_FRAGS_SUFFIX}");
+        if options.frags && loader.program(&frags_name).is_none() {
+            // Images pulled before frags support was added only have the
+            // classic dispatcher.
+            warn!(
+                "xdp dispatcher image {} has no {frags_name} program, loading it without frags support for if_index {if_index}",
+                image.image_url
+            );
+            options.frags = false;
+            loader = load(&options)?;
+        }
+        let frags = options.frags;
+        let frags_unavailable = frags != frags_supported(&mut extensions)?;
+        let program_name = if frags { frags_name } else { bpf_function_name };
+
+        let dispatcher: &mut Xdp = loader
+            .program_mut(&program_name)
+            .ok_or_else(|| {
+                BpfmanError::Error(format!(
+                    "xdp dispatcher image {} has no {program_name} program",
+                    image.image_url
+                ))
+            })?
+            .try_into()?;
 
         dispatcher.load()?;
 
         let path = format!("{RTDIR_FS_XDP}/dispatcher_{if_index}_{revision}");
-        fs::create_dir_all(path).unwrap();
+        fs::create_dir_all(&path).unwrap();
+
+        // Keep the dispatcher program around so later updates can attach
+        // extensions to it without loading a new dispatcher.
+        dispatcher
+            .pin(format!("{path}/{DISPATCHER_PROGRAM_PIN}"))
+            .map_err(BpfmanError::UnableToPinProgram)?;
+
+        if collect_stats {
+            match loader.map_mut(XDP_DISPATCHER_STATS_MAP) {
+                Some(map) => map
+                    .pin(format!("{path}/{DISPATCHER_STATS_PIN}"))
+                    .map_err(BpfmanError::UnableToPinMap)?,
+                None => warn!(
+                    "xdp dispatcher image does not support stats collection, ignoring collect_stats for if_index {if_index}"
+                ),
+            }
+        }
+
+        if verdict_cache {
+            match loader.map_mut(XDP_VERDICT_CACHE_MAP) {
+                Some(map) => map
+                    .pin(format!("{path}/{VERDICT_CACHE_PIN}"))
+                    .map_err(BpfmanError::UnableToPinMap)?,
+                None => warn!(
+                    "xdp dispatcher image does not support verdict caching, ignoring cache_verdict for if_index {if_index}"
+                ),
+            }
+        }
 
         self.loader = Some(loader);
         self.set_num_extensions(extensions.len())?;
-        self.set_program_name(&bpf_function_name)?;
+        self.set_program_name(&program_name)?;
+        self.set_frags(frags)?;
+        self.set_frags_unavailable(frags_unavailable)?;
+        self.set_verdict_cache(verdict_cache)?;
+        self.set_rx_queues(rx_queues_used(&extensions)?)?;
 
         self.attach_extensions(&mut extensions)?;
-        self.attach()?;
-        if let Some(mut old) = old_dispatcher {
-            old.delete(root_db, false)?;
+        slot_layout(&extensions, enabled, options.spare_actions)?.store(&self.db_tree)?;
+        self.attach()
+    }
+
+    /// Removes what a failed load left behind. The running dispatcher, if
+    /// any, is left untouched and keeps its extensions attached, as they are
+    /// only linked to this one through pins in its directory.
+    fn cleanup_failed_load(&mut self, root_db: &Db) {
+        self.loader = None;
+        if let Ok(path) = self.pin_dir() {
+            if path.exists() {
+                if let Err(e) = fs::remove_dir_all(&path) {
+                    warn!("unable to cleanup {}: {e}", path.display());
+                }
+            }
         }
-        Ok(())
+        if let Err(e) = root_db.drop_tree(self.db_tree.name()) {
+            warn!(
+                "unable to drop xdp dispatcher tree {:?}: {e}",
+                self.db_tree.name()
+            );
+        }
+    }
+
+    /// Tries to bring the running dispatcher to the given programs by only
+    /// attaching and detaching the slots that change. Returns false, without
+    /// changing anything, if a new dispatcher has to be loaded instead.
+    pub(crate) fn update(
+        &mut self,
+        config: Option<&InterfaceConfig>,
+        programs: &mut [Program],
+    ) -> Result<bool, BpfmanError> {
+        let if_index = self.get_ifindex()?;
+        let revision = self.get_revision()?;
+
+        let Some(layout) = SlotLayout::load(&self.db_tree)? else {
+            return Ok(false);
+        };
+
+        // Changing dispatcher options requires a new dispatcher.
+        if config.map(|c| c.collect_stats()).unwrap_or(false) != self.get_collect_stats()?
+            || config.map(|c| c.single_slot_dispatcher()).unwrap_or(false)
+                != self.get_single_slot()?
+            || config.map(|c| c.specialized_dispatcher()).unwrap_or(false)
+                != self.get_specialized()?
+            || config.map(|c| c.spare_dispatcher_slots()).unwrap_or(0) != self.get_spare_slots()?
+            || config
+                .map(|c| c.verdict_cache_ttl_ms())
+                .unwrap_or(DEFAULT_VERDICT_CACHE_TTL_MS)
+                != self.get_verdict_cache_ttl_ms()?
+            || config
+                .map(|c| c.verdict_cache_entries())
+                .unwrap_or(DEFAULT_VERDICT_CACHE_ENTRIES)
+                != self.get_verdict_cache_entries()?
+        {
+            return Ok(false);
+        }
+
+        let mut extensions: Vec<&mut XdpProgram> = programs
+            .iter_mut()
+            .map(|v| match v {
+                Program::Xdp(p) => p,
+                _ => panic!("All programs should be of type XDP"),
+            })
+            .collect();
+
+        extensions.sort_by(|a, b| {
+            a.get_current_position()
+                .unwrap()
+                .cmp(&b.get_current_position().unwrap())
+        });
+
+        // Specialized dispatchers are kept as long as the programs fit, which
+        // plan_slot_updates checks, and shrunk when a new one is loaded.
+        if (!self.get_specialized()?
+            && self.dispatcher_slots(extensions.len())?
+                != self.dispatcher_slots(self.get_num_extensions()?)?)
+            || (frags_supported(&mut extensions)? && !self.get_frags_unavailable()?)
+                != self.get_frags()?
+            // Program flags and RX queue masks are frozen once loaded.
+            || verdict_cache_used(&extensions)?
+            || self.get_verdict_cache()?
+            || rx_queues_used(&extensions)?
+            || self.get_rx_queues()?
+        {
+            return Ok(false);
+        }
+
+        let mut desired = Vec::with_capacity(extensions.len());
+        for v in extensions.iter() {
+            let id = if v.get_attached()? {
+                Some(v.get_data().get_id()?)
+            } else {
+                None
+            };
+            desired.push((id, v.get_proceed_on()?.mask()));
+        }
+
+        let Some(updates) =
+            plan_slot_updates(&layout, &desired, FALLTHROUGH_ACTIONS, SPARE_SLOT_ACTIONS)
+        else {
+            return Ok(false);
+        };
+
+        let path = format!("{RTDIR_FS_XDP}/dispatcher_{if_index}_{revision}");
+        let dispatcher_pin = format!("{path}/{DISPATCHER_PROGRAM_PIN}");
+        if !Path::new(&dispatcher_pin).exists() {
+            return Ok(false);
+        }
+        let dispatcher_fd = ProgramInfo::from_pin(&dispatcher_pin)?.fd()?;
+
+        debug!(
+            "XdpDispatcher::update() for if_index {}, revision {}: {:?}",
+            if_index, revision, updates
+        );
+        for update in updates {
+            match update {
+                SlotUpdate::Detach(slot, id) => {
+                    // The pinned link is the last reference to it, so removing
+                    // the pin detaches the program and the slot runs the stub.
+                    fs::remove_file(format!("{path}/link_{id}"))
+                        .map_err(|e| BpfmanError::Error(format!("unable to detach {id}: {e}")))?;
+                    set_slot_program(&self.db_tree, slot, None)?;
+                }
+                SlotUpdate::Attach(slot) => {
+                    let v = &mut extensions[slot];
+                    self.attach_extension(&dispatcher_fd, slot, v)?;
+                    set_slot_program(&self.db_tree, slot, Some(v.get_data().get_id()?))?;
+                }
+            }
+        }
+        self.set_num_extensions(extensions.len())?;
+        Ok(true)
     }
 
     pub(crate) fn attach(&mut self) -> Result<(), BpfmanError> {
@@ -179,10 +471,25 @@ impl XdpDispatcher {
 
         let path = PathBuf::from(format!("{RTDIR_FS_XDP}/dispatcher_{if_index}_link"));
         if path.exists() {
-            let pinned_link: FdLink = PinnedLink::from_pin(path).unwrap().into();
-            dispatcher
-                .attach_to_link(pinned_link.try_into().unwrap())
-                .unwrap();
+            // Replaces the running dispatcher, which the driver can refuse,
+            // e.g. when the new one doesn't support frags on a jumbo MTU.
+            let pinned_link: FdLink = PinnedLink::from_pin(path)
+                .map_err(|e| {
+                    BpfmanError::Error(format!(
+                        "unable to open dispatcher link on interface {iface}: {e}"
+                    ))
+                })?
+                .into();
+            let link = pinned_link.try_into().map_err(|e| {
+                BpfmanError::Error(format!(
+                    "XdpLink conversion failed on interface {iface}: {e}"
+                ))
+            })?;
+            dispatcher.attach_to_link(link).map_err(|e| {
+                BpfmanError::Error(format!(
+                    "dispatcher link update failed on interface {iface}: {e}"
+                ))
+            })?;
         } else {
             let flags = mode.as_flags();
             let link = dispatcher.attach(&iface, flags).map_err(|e| {
@@ -219,89 +526,102 @@ impl XdpDispatcher {
             .program_mut(program_name.as_str())
             .unwrap()
             .try_into()?;
+        let dispatcher_fd = dispatcher.fd()?.try_clone()?;
         extensions.sort_by(|a, b| {
             a.get_current_position()
                 .unwrap()
                 .cmp(&b.get_current_position().unwrap())
         });
         for (i, v) in extensions.iter_mut().enumerate() {
-            if v.get_attached()? {
-                let id = v.get_data().get_id()?;
-                let mut ext = Extension::from_pin(format!("{RTDIR_FS}/prog_{id}"))?;
-                let target_fn = format!("prog{i}");
-                let new_link_id = ext
-                    .attach_to_program(dispatcher.fd().unwrap(), &target_fn)
-                    .unwrap();
-                let new_link: FdLink = ext.take_link(new_link_id)?.into();
-                let path = format!(
-                    "{RTDIR_FS_XDP}/dispatcher_{if_index}_{}/link_{id}",
-                    revision
-                );
-                new_link.pin(path).map_err(BpfmanError::UnableToPinLink)?;
-            } else {
-                let name = &v.get_data().get_name()?;
-                let global_data = &v.get_data().get_global_data()?;
+            self.attach_extension(&dispatcher_fd, i, v)?;
+        }
+        Ok(())
+    }
 
-                let mut bpf = BpfLoader::new();
+    /// Attaches a program to slot `i` of the dispatcher, loading it first if
+    /// it isn't loaded yet.
+    fn attach_extension(
+        &self,
+        dispatcher_fd: &ProgramFd,
+        i: usize,
+        v: &mut XdpProgram,
+    ) -> Result<(), BpfmanError> {
+        let if_index = self.get_ifindex()?;
+        let revision = self.get_revision()?;
+        if v.get_attached()? {
+            let id = v.get_data().get_id()?;
+            let mut ext = Extension::from_pin(format!("{RTDIR_FS}/prog_{id}"))?;
+            let target_fn = format!("prog{i}");
+            let new_link_id = ext.attach_to_program(dispatcher_fd, &target_fn)?;
+            let new_link: FdLink = ext.take_link(new_link_id)?.into();
+            let path = format!(
+                "{RTDIR_FS_XDP}/dispatcher_{if_index}_{}/link_{id}",
+                revision
+            );
+            new_link.pin(path).map_err(BpfmanError::UnableToPinLink)?;
+        } else {
+            let name = &v.get_data().get_name()?;
+            let global_data = &v.get_data().get_global_data()?;
 
-                bpf.allow_unsupported_maps().extension(name);
+            let mut bpf = BpfLoader::new();
 
-                for (name, value) in global_data {
-                    bpf.set_global(name, value.as_slice(), true);
-                }
+            bpf.allow_unsupported_maps().extension(name);
 
-                // If map_pin_path is set already it means we need to use a pin
-                // path which should already exist on the system.
-                if let Some(map_pin_path) = v.get_data().get_map_pin_path()? {
-                    debug!("xdp program {name} is using maps from {:?}", map_pin_path);
-                    bpf.map_pin_path(map_pin_path);
-                }
+            for (name, value) in global_data {
+                bpf.set_global(name, value.as_slice(), true);
+            }
 
-                let mut loader = bpf
-                    .load(&v.get_data().get_program_bytes()?)
-                    .map_err(BpfmanError::BpfLoadError)?;
+            // If map_pin_path is set already it means we need to use a pin
+            // path which should already exist on the system.
+            if let Some(map_pin_path) = v.get_data().get_map_pin_path()? {
+                debug!("xdp program {name} is using maps from {:?}", map_pin_path);
+                bpf.map_pin_path(map_pin_path);
+            }
 
-                let ext: &mut Extension = loader
-                    .program_mut(name)
-                    .ok_or_else(|| BpfmanError::BpfFunctionNameNotValid(name.to_string()))?
-                    .try_into()?;
+            let mut loader = bpf
+                .load(&v.get_data().get_program_bytes()?)
+                .map_err(BpfmanError::BpfLoadError)?;
 
-                let target_fn = format!("prog{i}");
+            let ext: &mut Extension = loader
+                .program_mut(name)
+                .ok_or_else(|| BpfmanError::BpfFunctionNameNotValid(name.to_string()))?
+                .try_into()?;
 
-                ext.load(dispatcher.fd()?.try_clone()?, &target_fn)?;
-                v.get_data_mut().set_kernel_info(&ext.info()?)?;
+            let target_fn = format!("prog{i}");
 
-                let id = v.get_data().get_id()?;
+            ext.load(dispatcher_fd.try_clone()?, &target_fn)?;
+            v.get_data_mut().set_kernel_info(&ext.info()?)?;
 
-                ext.pin(format!("{RTDIR_FS}/prog_{id}"))
-                    .map_err(BpfmanError::UnableToPinProgram)?;
-                let new_link_id = ext.attach()?;
-                let new_link = ext.take_link(new_link_id)?;
-                let fd_link: FdLink = new_link.into();
-                fd_link
-                    .pin(format!(
-                        "{RTDIR_FS_XDP}/dispatcher_{if_index}_{}/link_{id}",
-                        revision,
-                    ))
-                    .map_err(BpfmanError::UnableToPinLink)?;
-
-                // If this program is the map(s) owner pin all maps (except for .rodata and .bss) by name.
-                if v.get_data().get_map_pin_path()?.is_none() {
-                    let map_pin_path = calc_map_pin_path(id);
-                    v.get_data_mut().set_map_pin_path(&map_pin_path)?;
-                    create_map_pin_path(&map_pin_path)?;
-
-                    for (name, map) in loader.maps_mut() {
-                        if !should_map_be_pinned(name) {
-                            continue;
-                        }
-                        debug!(
-                            "Pinning map: {name} to path: {}",
-                            map_pin_path.join(name).display()
-                        );
-                        map.pin(map_pin_path.join(name))
-                            .map_err(BpfmanError::UnableToPinMap)?;
+            let id = v.get_data().get_id()?;
+
+            ext.pin(format!("{RTDIR_FS}/prog_{id}"))
+                .map_err(BpfmanError::UnableToPinProgram)?;
+            let new_link_id = ext.attach()?;
+            let new_link = ext.take_link(new_link_id)?;
+            let fd_link: FdLink = new_link.into();
+            fd_link
+                .pin(format!(
+                    "{RTDIR_FS_XDP}/dispatcher_{if_index}_{}/link_{id}",
+                    revision,
+                ))
+                .map_err(BpfmanError::UnableToPinLink)?;
+
+            // If this program is the map(s) owner pin all maps (except for .rodata and .bss) by name.
+            if v.get_data().get_map_pin_path()?.is_none() {
+                let map_pin_path = calc_map_pin_path(id);
+                v.get_data_mut().set_map_pin_path(&map_pin_path)?;
+                create_map_pin_path(&map_pin_path)?;
+
+                for (name, map) in loader.maps_mut() {
+                    if !should_map_be_pinned(name) {
+                        continue;
                     }
+                    debug!(
+                        "Pinning map: {name} to path: {}",
+                        map_pin_path.join(name).display()
+                    );
+                    map.pin(map_pin_path.join(name))
+                        .map_err(BpfmanError::UnableToPinMap)?;
                 }
             }
         }
@@ -336,6 +656,70 @@ impl XdpDispatcher {
         Ok(())
     }
 
+    /// Returns the number of slots of the dispatcher to load for the given
+    /// number of programs.
+    ///
+    /// The standard, libxdp compatible, dispatcher is used unless the
+    /// interface is configured to use a specialized dispatcher, which is the
+    /// smallest one with enough slots for the programs and spare slots, or a
+    /// single slot dispatcher and there is only one program, or there are too
+    /// many programs for it.
+    fn dispatcher_slots(&self, num_programs: usize) -> Result<usize, BpfmanError> {
+        Ok(if self.get_specialized()? {
+            tightest_slot_count(num_programs + self.get_spare_slots()?)
+        } else if num_programs == 1 && self.get_single_slot()? {
+            SINGLE_SLOT_DISPATCHER_ACTIONS
+        } else if num_programs <= MAX_DISPATCHER_ACTIONS {
+            MAX_DISPATCHER_ACTIONS
+        } else {
+            EXTENDED_DISPATCHER_ACTIONS
+        })
+    }
+
+    /// Returns the per-slot stats of every XDP dispatcher that was loaded with
+    /// stats collection enabled. This only relies on the pinned stats maps, so
+    /// it doesn't require access to the database.
+    pub(crate) fn list_stats(
+        links: &HashMap<u32, u32>,
+    ) -> Result<Vec<DispatcherSlotStats>, BpfmanError> {
+        let mut result = vec![];
+        for (if_index, revision, path) in find_dispatcher_stats_pins(RTDIR_FS_XDP)? {
+            let programs = path
+                .parent()
+                .map(|dir| find_dispatcher_slot_programs(dir, links))
+                .unwrap_or_default();
+            for (slot, stats) in read_dispatcher_stats(&path)? {
+                result.push(DispatcherSlotStats {
+                    kind: ProgramType::Xdp,
+                    if_index,
+                    direction: None,
+                    revision,
+                    slot,
+                    prog_id: programs.get(slot as usize).copied(),
+                    count: stats.count,
+                    run_time_ns: stats.run_time_ns,
+                    verdicts: stats.verdicts.to_vec(),
+                    latency: stats.latency.to_vec(),
+                });
+            }
+        }
+        Ok(result)
+    }
+
+    /// Returns the directory the dispatcher program and the links of its
+    /// extensions are pinned in.
+    pub(crate) fn pin_dir(&self) -> Result<PathBuf, BpfmanError> {
+        Ok(PathBuf::from(format!(
+            "{RTDIR_FS_XDP}/dispatcher_{}_{}",
+            self.get_ifindex()?,
+            self.get_revision()?
+        )))
+    }
+
+    pub(crate) fn slot_layout(&self) -> Result<Option<SlotLayout>, BpfmanError> {
+        SlotLayout::load(&self.db_tree)
+    }
+
     pub(crate) fn set_revision(&mut self, revision: u32) -> Result<(), BpfmanError> {
         sled_insert(&self.db_tree, REVISION, &revision.to_ne_bytes())
     }
@@ -385,4 +769,413 @@ impl XdpDispatcher {
     pub(crate) fn get_program_name(&self) -> Result<String, BpfmanError> {
         sled_get(&self.db_tree, PROGRAM_NAME).map(|v| bytes_to_string(&v))
     }
+
+    pub(crate) fn set_collect_stats(&mut self, collect_stats: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            COLLECT_STATS,
+            &(collect_stats as i8).to_ne_bytes(),
+        )
+    }
+
+    pub(crate) fn get_collect_stats(&self) -> Result<bool, BpfmanError> {
+        sled_get(&self.db_tree, COLLECT_STATS).map(bytes_to_bool)
+    }
+
+    pub(crate) fn set_single_slot(&mut self, single_slot: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            SINGLE_SLOT,
+            &(single_slot as i8).to_ne_bytes(),
+        )
+    }
+
+    pub(crate) fn get_single_slot(&self) -> Result<bool, BpfmanError> {
+        sled_get(&self.db_tree, SINGLE_SLOT).map(bytes_to_bool)
+    }
+
+    pub(crate) fn set_specialized(&mut self, specialized: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            SPECIALIZED,
+            &(specialized as i8).to_ne_bytes(),
+        )
+    }
+
+    pub(crate) fn get_specialized(&self) -> Result<bool, BpfmanError> {
+        // Dispatchers loaded before specialized dispatchers existed don't
+        // have the key.
+        Ok(sled_get_option(&self.db_tree, SPECIALIZED)?
+            .map(bytes_to_bool)
+            .unwrap_or(false))
+    }
+
+    pub(crate) fn set_spare_slots(&mut self, spare_slots: usize) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, SPARE_SLOTS, &spare_slots.to_ne_bytes())
+    }
+
+    pub(crate) fn get_spare_slots(&self) -> Result<usize, BpfmanError> {
+        sled_get(&self.db_tree, SPARE_SLOTS).map(bytes_to_usize)
+    }
+
+    pub(crate) fn set_frags(&mut self, frags: bool) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, FRAGS, &(frags as i8).to_ne_bytes())
+    }
+
+    pub(crate) fn get_frags(&self) -> Result<bool, BpfmanError> {
+        sled_get(&self.db_tree, FRAGS).map(bytes_to_bool)
+    }
+
+    pub(crate) fn set_frags_unavailable(&mut self, unavailable: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            FRAGS_UNAVAILABLE,
+            &(unavailable as i8).to_ne_bytes(),
+        )
+    }
+
+    /// Returns whether the dispatcher image has no frags support, so the
+    /// dispatcher was loaded without it although its programs support frags.
+    pub(crate) fn get_frags_unavailable(&self) -> Result<bool, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, FRAGS_UNAVAILABLE)?
+            .map(bytes_to_bool)
+            .unwrap_or(false))
+    }
+
+    pub(crate) fn set_verdict_cache(&mut self, verdict_cache: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.db_tree,
+            VERDICT_CACHE,
+            &(verdict_cache as i8).to_ne_bytes(),
+        )
+    }
+
+    pub(crate) fn get_verdict_cache(&self) -> Result<bool, BpfmanError> {
+        sled_get(&self.db_tree, VERDICT_CACHE).map(bytes_to_bool)
+    }
+
+    pub(crate) fn set_rx_queues(&mut self, rx_queues: bool) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, RX_QUEUES, &(rx_queues as i8).to_ne_bytes())
+    }
+
+    /// Returns whether some of the dispatcher's slots are limited to some RX
+    /// queues.
+    pub(crate) fn get_rx_queues(&self) -> Result<bool, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, RX_QUEUES)?
+            .map(bytes_to_bool)
+            .unwrap_or(false))
+    }
+
+    pub(crate) fn set_verdict_cache_ttl_ms(&mut self, ttl_ms: u64) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, VERDICT_CACHE_TTL_MS, &ttl_ms.to_ne_bytes())
+    }
+
+    pub(crate) fn get_verdict_cache_ttl_ms(&self) -> Result<u64, BpfmanError> {
+        sled_get(&self.db_tree, VERDICT_CACHE_TTL_MS).map(bytes_to_u64)
+    }
+
+    pub(crate) fn set_verdict_cache_entries(&mut self, entries: u32) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, VERDICT_CACHE_ENTRIES, &entries.to_ne_bytes())
+    }
+
+    pub(crate) fn get_verdict_cache_entries(&self) -> Result<u32, BpfmanError> {
+        sled_get(&self.db_tree, VERDICT_CACHE_ENTRIES).map(bytes_to_u32)
+    }
+}
+
+/// Returns the image of the XDP dispatcher with the given number of slots, and
+/// that applies the chain call actions of slot 0 to every slot if
+/// `uniform_actions` is set.
+fn xdp_dispatcher_image(slots: usize, uniform_actions: bool) -> String {
+    let mut image = XDP_DISPATCHER_IMAGE.to_string();
+    if slots != MAX_DISPATCHER_ACTIONS {
+        image.push_str(&format!("-{slots}"));
+    }
+    if uniform_actions {
+        image.push_str("-uniform");
+    }
+    image
+}
+
+/// Returns the smallest number of slots the XDP dispatcher is built with that
+/// is at least `needed`.
+fn tightest_slot_count(needed: usize) -> usize {
+    XDP_DISPATCHER_SLOT_COUNTS
+        .iter()
+        .copied()
+        .find(|slots| *slots >= needed)
+        .unwrap_or(EXTENDED_DISPATCHER_ACTIONS)
+}
+
+/// Returns the chain call actions of the given extensions, which must be
+/// sorted by position, if they all have the same ones and those can also be
+/// used for the spare slots among the `enabled` slots, which only requires
+/// them to let the stub's retval fall through. A dispatcher that loads these
+/// actions once for every slot can then be used.
+fn uniform_actions(
+    extensions: &[&mut XdpProgram],
+    enabled: usize,
+) -> Result<Option<u32>, BpfmanError> {
+    let Some(first) = extensions.first() else {
+        return Ok(None);
+    };
+    let actions = first.get_proceed_on()?.mask();
+    for p in extensions.iter().skip(1) {
+        if p.get_proceed_on()?.mask() != actions {
+            return Ok(None);
+        }
+    }
+    if enabled > extensions.len() && actions & SPARE_SLOT_ACTIONS == 0 {
+        return Ok(None);
+    }
+    Ok(Some(actions))
+}
+
+/// Load time options of an XDP dispatcher.
+struct XdpDispatcherOptions {
+    /// Number of slots to enable.
+    enabled: usize,
+    /// Chain call actions of the enabled slots past the last extension.
+    spare_actions: u32,
+    /// Whether to load the dispatcher with XDP frags support.
+    frags: bool,
+    dispatcher_flags: u32,
+    verdict_cache_ttl_ns: u64,
+    verdict_cache_entries: u32,
+}
+
+/// Loads the XDP dispatcher bytecode as a dispatcher with `N` slots configured
+/// for the given extensions.
+fn load_xdp_dispatcher<const N: usize>(
+    program_bytes: &[u8],
+    extensions: &[&mut XdpProgram],
+    options: &XdpDispatcherOptions,
+) -> Result<Bpf, BpfmanError> {
+    let config = xdp_dispatcher_config::<N>(extensions, options)?;
+    let rx_queues = xdp_slot_rx_queues::<N>(extensions)?;
+    debug!("xdp dispatcher config: {:?}", config);
+
+    // Older dispatcher images do not define `dispatcher_flags`, the verdict
+    // cache or the RX queue masks, so don't require them to exist.
+    Ok(BpfLoader::new()
+        .set_global("conf", &config, true)
+        .set_global("dispatcher_flags", &options.dispatcher_flags, false)
+        .set_global(XDP_SLOT_RX_QUEUES, &rx_queues, false)
+        .set_global(XDP_VERDICT_CACHE_TTL, &options.verdict_cache_ttl_ns, false)
+        .set_max_entries(XDP_VERDICT_CACHE_MAP, options.verdict_cache_entries)
+        .load(program_bytes)?)
+}
+
+/// Builds the configuration of an XDP dispatcher with `N` slots for the given
+/// extensions, which must be sorted by position. Enabled slots past the last
+/// extension are spare slots.
+fn xdp_dispatcher_config<const N: usize>(
+    extensions: &[&mut XdpProgram],
+    options: &XdpDispatcherOptions,
+) -> Result<XdpDispatcherConfig<N>, BpfmanError> {
+    let mut chain_call_actions = [0; N];
+    let mut program_flags = [0; N];
+    chain_call_actions[extensions.len()..options.enabled].fill(options.spare_actions);
+    for p in extensions.iter() {
+        let slot = p.get_current_position()?.unwrap();
+        chain_call_actions[slot] = p.get_proceed_on()?.mask();
+        if p.get_cache_verdict()? {
+            program_flags[slot] |= XDP_DISPATCHER_PROG_FLAG_CACHE_VERDICT;
+        }
+        if p.get_rx_queue_mask()? != 0 {
+            program_flags[slot] |= XDP_DISPATCHER_PROG_FLAG_RX_QUEUES;
+        }
+    }
+
+    Ok(XdpDispatcherConfig::new(
+        options.enabled as u8,
+        options.frags as u8,
+        chain_call_actions,
+        [DEFAULT_PRIORITY; N],
+        program_flags,
+    ))
+}
+
+/// Returns the RX queue masks of the slots of an XDP dispatcher with `N` slots
+/// for the given extensions. Slots that run on every queue have no mask.
+fn xdp_slot_rx_queues<const N: usize>(
+    extensions: &[&mut XdpProgram],
+) -> Result<[u64; N], BpfmanError> {
+    let mut masks = [0; N];
+    for p in extensions.iter() {
+        masks[p.get_current_position()?.unwrap()] = p.get_rx_queue_mask()?;
+    }
+    Ok(masks)
+}
+
+/// Returns whether any of the given extensions is limited to some RX queues.
+fn rx_queues_used(extensions: &[&mut XdpProgram]) -> Result<bool, BpfmanError> {
+    for p in extensions.iter() {
+        if p.get_rx_queue_mask()? != 0 {
+            return Ok(true);
+        }
+    }
+    Ok(false)
+}
+
+/// Returns whether any of the given extensions publishes its verdicts to the
+/// dispatcher's verdict cache.
+fn verdict_cache_used(extensions: &[&mut XdpProgram]) -> Result<bool, BpfmanError> {
+    for p in extensions.iter() {
+        if p.get_cache_verdict()? {
+            return Ok(true);
+        }
+    }
+    Ok(false)
+}
+
+/// Records the ELF section of the program's eBPF function in `bytecode`, and
+/// whether it handles multi-buffer packets, so that dispatcher updates don't
+/// have to parse the bytecode again.
+pub(crate) fn record_xdp_section(p: &mut XdpProgram, bytecode: &[u8]) -> Result<(), BpfmanError> {
+    let section = bpf_function_section(bytecode, &p.get_data().get_name()?)?;
+    p.set_frags(section.starts_with(XDP_FRAGS_SECTION))?;
+    p.set_section(&section)
+}
+
+/// Returns whether the dispatcher for the given extensions can be loaded with
+/// XDP frags support, which is only the case if every one of them declares
+/// that it handles multi-buffer packets by using an "xdp.frags" section.
+fn frags_supported(extensions: &mut [&mut XdpProgram]) -> Result<bool, BpfmanError> {
+    for p in extensions.iter_mut() {
+        // Programs added before sections were recorded are parsed once.
+        let frags = match p.get_frags()? {
+            Some(frags) => frags,
+            None => {
+                let bytecode = p.get_data().get_program_bytes()?;
+                record_xdp_section(p, &bytecode)?;
+                p.get_frags()?.unwrap_or(false)
+            }
+        };
+        if !frags {
+            debug!(
+                "xdp program {} in section {:?} doesn't support frags",
+                p.get_data().get_name()?,
+                p.get_section()?
+            );
+            return Ok(false);
+        }
+    }
+    Ok(!extensions.is_empty())
+}
+
+/// Returns the slot layout of a dispatcher just loaded for the given
+/// extensions, which must be sorted by position, with `enabled` slots enabled
+/// and `spare_actions` in the slots past the last extension.
+fn slot_layout(
+    extensions: &[&mut XdpProgram],
+    enabled: usize,
+    spare_actions: u32,
+) -> Result<SlotLayout, BpfmanError> {
+    let mut layout = SlotLayout {
+        actions: vec![spare_actions; enabled],
+        programs: vec![None; enabled],
+    };
+    for (slot, p) in extensions.iter().enumerate() {
+        layout.actions[slot] = p.get_proceed_on()?.mask();
+        layout.programs[slot] = Some(p.get_data().get_id()?);
+    }
+    Ok(layout)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::{Location, ProgramData, XdpProceedOn, XDP_MAX_RX_QUEUES};
+
+    #[test]
+    fn test_tightest_slot_count() {
+        assert_eq!(tightest_slot_count(1), SINGLE_SLOT_DISPATCHER_ACTIONS);
+        assert_eq!(tightest_slot_count(3), 4);
+        assert_eq!(tightest_slot_count(8), 8);
+        assert_eq!(tightest_slot_count(9), MAX_DISPATCHER_ACTIONS);
+        assert_eq!(tightest_slot_count(11), EXTENDED_DISPATCHER_ACTIONS);
+    }
+
+    #[test]
+    fn test_xdp_dispatcher_image() {
+        assert_eq!(xdp_dispatcher_image(10, false), XDP_DISPATCHER_IMAGE);
+        assert_eq!(
+            xdp_dispatcher_image(10, true),
+            "quay.io/bpfman/xdp-dispatcher:v2-uniform"
+        );
+        assert_eq!(
+            xdp_dispatcher_image(4, true),
+            "quay.io/bpfman/xdp-dispatcher:v2-4-uniform"
+        );
+        assert_eq!(
+            xdp_dispatcher_image(64, false),
+            "quay.io/bpfman/xdp-dispatcher:v2-64"
+        );
+    }
+
+    fn xdp_program(rx_queues: Vec<u32>) -> Result<XdpProgram, BpfmanError> {
+        let data = ProgramData::new(
+            Location::File("/tmp/pass.o".to_string()),
+            "pass".to_string(),
+            HashMap::new(),
+            HashMap::new(),
+            None,
+            false,
+        )?;
+        XdpProgram::new(
+            data,
+            50,
+            "eth0".to_string(),
+            XdpProceedOn::default(),
+            false,
+            rx_queues,
+        )
+    }
+
+    #[test]
+    fn test_xdp_slot_rx_queues() {
+        assert!(xdp_program(vec![XDP_MAX_RX_QUEUES]).is_err());
+
+        let mut all = xdp_program(vec![]).unwrap();
+        let mut scoped = xdp_program(vec![3, 0]).unwrap();
+        assert_eq!(scoped.get_rx_queues().unwrap(), vec![0, 3]);
+        all.set_current_position(0).unwrap();
+        scoped.set_current_position(1).unwrap();
+
+        let extensions = [&mut all, &mut scoped];
+        assert_eq!(
+            xdp_slot_rx_queues::<4>(&extensions).unwrap(),
+            [0, 0b1001, 0, 0]
+        );
+        assert!(rx_queues_used(&extensions).unwrap());
+
+        let options = XdpDispatcherOptions {
+            enabled: 2,
+            spare_actions: SPARE_SLOT_ACTIONS,
+            frags: false,
+            dispatcher_flags: 0,
+            verdict_cache_ttl_ns: 0,
+            verdict_cache_entries: 1,
+        };
+        let config = xdp_dispatcher_config::<4>(&extensions, &options).unwrap();
+        assert_eq!(
+            config.program_flags,
+            [0, XDP_DISPATCHER_PROG_FLAG_RX_QUEUES, 0, 0]
+        );
+    }
+
+    #[test]
+    fn test_frags_supported_uses_recorded_sections() {
+        // /tmp/pass.o doesn't exist, so this fails if the bytecode is read.
+        let mut frags = xdp_program(vec![]).unwrap();
+        let mut other = xdp_program(vec![]).unwrap();
+        frags.set_frags(true).unwrap();
+        other.set_frags(true).unwrap();
+        assert!(frags_supported(&mut [&mut frags, &mut other]).unwrap());
+
+        other.set_frags(false).unwrap();
+        assert!(!frags_supported(&mut [&mut frags, &mut other]).unwrap());
+        assert!(!frags_supported(&mut []).unwrap());
+    }
 }
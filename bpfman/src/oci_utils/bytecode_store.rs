@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! A content-addressed store of the bytecode extracted from images.
+//!
+//! Every distinct ELF object is kept once, in a file named after its SHA256
+//! digest, however many images or tags it was pulled from, and is memory
+//! mapped when loaded so that programs sharing bytecode share its pages.
+//! Files are written to a temporary file and renamed into place, and are
+//! never modified afterwards. Files that neither a program nor a cached image
+//! refers to anymore, e.g. older versions of a tag that was pulled again, are
+//! removed by `sweep` when bpfman starts.
+
+use std::{
+    collections::{HashMap, HashSet, VecDeque},
+    fs::{self, create_dir_all, File},
+    io::Write,
+    ops::Deref,
+    path::PathBuf,
+    sync::{Arc, Mutex},
+};
+
+use anyhow::anyhow;
+use lazy_static::lazy_static;
+use log::debug;
+use memmap2::Mmap;
+use sha2::{Digest, Sha256};
+use tempfile::NamedTempFile;
+
+use crate::oci_utils::ImageError;
+
+/// Maximum number of mapped bytecode files kept open.
+const BYTECODE_CACHE_CAPACITY: usize = 64;
+
+lazy_static! {
+    /// Mapped bytecode keyed by its digest. ImageManagers are short lived, so
+    /// the cache is process wide and shared by dispatcher rebuilds and user
+    /// program loads alike. Entries were verified when they were mapped.
+    static ref BYTECODE_CACHE: Mutex<BytecodeCache> =
+        Mutex::new(BytecodeCache::new(BYTECODE_CACHE_CAPACITY));
+}
+
+#[cfg(test)]
+fn get_store_path() -> PathBuf {
+    std::env::temp_dir().join("bpfman-bytecode")
+}
+
+#[cfg(not(test))]
+fn get_store_path() -> PathBuf {
+    PathBuf::from(crate::directories::STDIR_BYTECODE)
+}
+
+/// Bytecode of a program, either mapped from the bytecode store or read into
+/// memory, e.g. from a local file. Both are shared, so copies of the bytecode,
+/// such as the ones handed out by the cache, never copy the bytes.
+#[derive(Debug, Clone)]
+pub(crate) enum Bytecode {
+    Mapped { digest: String, map: Arc<Mmap> },
+    Owned(Arc<[u8]>),
+}
+
+impl Bytecode {
+    /// Returns the store digest of mapped bytecode.
+    pub(crate) fn digest(&self) -> Option<&str> {
+        match self {
+            Bytecode::Mapped { digest, .. } => Some(digest),
+            Bytecode::Owned(_) => None,
+        }
+    }
+}
+
+impl Deref for Bytecode {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        match self {
+            Bytecode::Mapped { map, .. } => map,
+            Bytecode::Owned(bytes) => bytes,
+        }
+    }
+}
+
+/// A small bounded map of digest to mapped bytecode. Entries are evicted in
+/// least recently used order once `capacity` is reached.
+struct BytecodeCache {
+    capacity: usize,
+    entries: HashMap<String, Bytecode>,
+    order: VecDeque<String>,
+}
+
+impl BytecodeCache {
+    fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            entries: HashMap::new(),
+            order: VecDeque::new(),
+        }
+    }
+
+    fn get(&mut self, digest: &str) -> Option<Bytecode> {
+        let bytes = self.entries.get(digest)?.clone();
+        self.touch(digest);
+        Some(bytes)
+    }
+
+    fn insert(&mut self, digest: String, bytes: Bytecode) {
+        if self.capacity == 0 {
+            return;
+        }
+        if self.entries.insert(digest.clone(), bytes).is_some() {
+            self.touch(&digest);
+            return;
+        }
+        self.order.push_back(digest);
+        while self.order.len() > self.capacity {
+            if let Some(evicted) = self.order.pop_front() {
+                self.entries.remove(&evicted);
+            }
+        }
+    }
+
+    fn remove(&mut self, digest: &str) {
+        if self.entries.remove(digest).is_some() {
+            self.order.retain(|d| d != digest);
+        }
+    }
+
+    fn touch(&mut self, digest: &str) {
+        if let Some(pos) = self.order.iter().position(|d| d == digest) {
+            if let Some(d) = self.order.remove(pos) {
+                self.order.push_back(d);
+            }
+        }
+    }
+}
+
+pub(crate) fn sha256_hex(bytes: &[u8]) -> String {
+    base16ct::lower::encode_string(&Sha256::digest(bytes))
+}
+
+fn process_failure(what: &str, e: impl std::fmt::Display) -> ImageError {
+    ImageError::ByteCodeImageProcessFailure(anyhow!("{what}: {e}"))
+}
+
+pub(crate) struct BytecodeStore {
+    path: PathBuf,
+}
+
+impl Default for BytecodeStore {
+    fn default() -> Self {
+        Self::new(get_store_path())
+    }
+}
+
+impl BytecodeStore {
+    pub(crate) fn new(path: PathBuf) -> Self {
+        Self { path }
+    }
+
+    /// Stores `bytes`, unless the store already has them, and returns them
+    /// mapped from the store.
+    pub(crate) fn insert(&self, bytes: &[u8]) -> Result<Bytecode, ImageError> {
+        let digest = sha256_hex(bytes);
+        if let Some(bytecode) = BYTECODE_CACHE.lock().unwrap().get(&digest) {
+            return Ok(bytecode);
+        }
+
+        let path = self.path.join(&digest);
+        if !path.exists() {
+            debug!("Adding bytecode {digest} to the bytecode store");
+            create_dir_all(&self.path)
+                .map_err(|e| process_failure("unable to create the bytecode store", e))?;
+            let mut file = NamedTempFile::new_in(&self.path)
+                .map_err(|e| process_failure("unable to create bytecode file", e))?;
+            file.write_all(bytes)
+                .and_then(|_| file.as_file().sync_all())
+                .map_err(|e| process_failure("unable to write bytecode file", e))?;
+            file.persist(&path)
+                .map_err(|e| process_failure("unable to write bytecode file", e))?;
+        }
+
+        // The bytes were just hashed, no need to verify the mapping.
+        self.map(digest, false)
+    }
+
+    /// Returns the bytecode with the given digest, checking that it wasn't
+    /// altered since it was stored the first time it is mapped.
+    pub(crate) fn get(&self, digest: &str) -> Result<Bytecode, ImageError> {
+        if let Some(bytecode) = BYTECODE_CACHE.lock().unwrap().get(digest) {
+            debug!("bytecode {digest} found in cache");
+            return Ok(bytecode);
+        }
+        self.map(digest.to_string(), true)
+    }
+
+    /// Removes the bytecode files whose digest isn't in `referenced`, and
+    /// returns how many were removed. Programs whose bytecode is already
+    /// mapped keep using it. This must not run while bytecode is being added.
+    pub(crate) fn sweep(&self, referenced: &HashSet<String>) -> Result<usize, ImageError> {
+        let dir = match fs::read_dir(&self.path) {
+            Ok(dir) => dir,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(0),
+            Err(e) => return Err(process_failure("unable to read the bytecode store", e)),
+        };
+        let mut removed = 0;
+        for entry in dir.flatten() {
+            let name = entry.file_name().to_string_lossy().into_owned();
+            // Leaves alone anything that isn't a stored file, such as the
+            // temporary file of an interrupted insert.
+            let is_digest =
+                name.len() == 64 && name.bytes().all(|b| matches!(b, b'0'..=b'9' | b'a'..=b'f'));
+            if !is_digest || referenced.contains(&name) {
+                continue;
+            }
+            debug!("Removing unreferenced bytecode {name} from the bytecode store");
+            fs::remove_file(entry.path())
+                .map_err(|e| process_failure(&format!("unable to remove bytecode {name}"), e))?;
+            BYTECODE_CACHE.lock().unwrap().remove(&name);
+            removed += 1;
+        }
+        Ok(removed)
+    }
+
+    fn map(&self, digest: String, verify: bool) -> Result<Bytecode, ImageError> {
+        let file = File::open(self.path.join(&digest))
+            .map_err(|e| process_failure(&format!("unable to open bytecode {digest}"), e))?;
+        // SAFETY: files in the store are never modified once they are in
+        // place, and are only replaced by renaming over them.
+        let map = unsafe { Mmap::map(&file) }
+            .map_err(|e| process_failure(&format!("unable to map bytecode {digest}"), e))?;
+
+        if verify && sha256_hex(&map) != digest {
+            return Err(ImageError::ByteCodeImageProcessFailure(anyhow!(
+                "Bpf Bytecode {digest} has been compromised"
+            )));
+        }
+
+        let bytecode = Bytecode::Mapped {
+            digest: digest.clone(),
+            map: Arc::new(map),
+        };
+        BYTECODE_CACHE
+            .lock()
+            .unwrap()
+            .insert(digest, bytecode.clone());
+        Ok(bytecode)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bytecode_cache_eviction() {
+        let mut cache = BytecodeCache::new(2);
+        cache.insert("a".to_string(), Bytecode::Owned(vec![1].into()));
+        cache.insert("b".to_string(), Bytecode::Owned(vec![2].into()));
+
+        // Using "a" makes "b" the least recently used entry.
+        assert_eq!(&*cache.get("a").unwrap(), &[1]);
+        cache.insert("c".to_string(), Bytecode::Owned(vec![3].into()));
+
+        assert!(cache.get("b").is_none());
+        assert_eq!(&*cache.get("a").unwrap(), &[1]);
+        assert_eq!(&*cache.get("c").unwrap(), &[3]);
+    }
+
+    #[test]
+    fn test_bytecode_store_dedup() {
+        let dir = tempfile::tempdir().unwrap();
+        let store = BytecodeStore::new(dir.path().to_path_buf());
+
+        let first = store.insert(b"\x7fELF one").unwrap();
+        let again = store.insert(b"\x7fELF one").unwrap();
+        let other = store.insert(b"\x7fELF two").unwrap();
+        assert_eq!(first.digest(), again.digest());
+        assert_ne!(first.digest(), other.digest());
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 2);
+
+        assert_eq!(
+            &*store.get(other.digest().unwrap()).unwrap(),
+            b"\x7fELF two"
+        );
+        assert!(store.get(&sha256_hex(b"missing")).is_err());
+    }
+
+    #[test]
+    fn test_bytecode_store_sweep() {
+        let dir = tempfile::tempdir().unwrap();
+        let store = BytecodeStore::new(dir.path().to_path_buf());
+
+        let kept = store.insert(b"\x7fELF kept").unwrap();
+        let unused = store.insert(b"\x7fELF unused").unwrap();
+        std::fs::write(dir.path().join(".tmpXYZ"), b"partial").unwrap();
+
+        let referenced = HashSet::from([kept.digest().unwrap().to_string()]);
+        assert_eq!(store.sweep(&referenced).unwrap(), 1);
+        assert!(store.get(kept.digest().unwrap()).is_ok());
+        assert!(store.get(unused.digest().unwrap()).is_err());
+        assert!(dir.path().join(".tmpXYZ").exists());
+    }
+}
@@ -1,10 +1,16 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::{path::PathBuf, str::FromStr};
+use std::{
+    path::PathBuf,
+    str::FromStr,
+    time::{Duration, SystemTime, UNIX_EPOCH},
+};
 
 use anyhow::{anyhow, bail};
 use log::{debug, info, warn};
+use oci_distribution::Reference;
+use serde::{Deserialize, Serialize};
 use sigstore::{
     cosign::{
         verification_constraint::VerificationConstraintVec, verify_constraints, ClientBuilder,
@@ -13,10 +19,57 @@ use sigstore::{
     errors::SigstoreError::RegistryPullManifestError,
     registry::{Auth, ClientConfig, ClientProtocol, OciReference},
 };
+use sled::{Db, Tree};
+
+/// The database tree recording the image digests that passed verification.
+const VERIFICATION_CACHE_TREE: &str = "cosign_verification_cache";
+/// The key, in the verification cache tree, of the policy the cached results
+/// were obtained under.
+const VERIFICATION_CACHE_POLICY_KEY: &str = "policy";
+
+/// Version of the verification constraints applied to signed images, which
+/// must be bumped whenever they change so that cached results are dropped.
+const VERIFICATION_CONSTRAINTS_VERSION: u32 = 1;
 
 pub struct CosignVerifier {
     pub client: sigstore::cosign::Client<'static>,
     pub allow_unsigned: bool,
+    // How long a successful verification is trusted for, zero disabling the
+    // cache.
+    pub cache_ttl: Duration,
+}
+
+/// The outcome of a successful verification, as cached.
+#[derive(Debug, Serialize, Deserialize, PartialEq)]
+struct CachedVerification {
+    signed: bool,
+    // Seconds since the epoch after which the image is verified again.
+    expires: u64,
+}
+
+fn now_secs() -> u64 {
+    SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .map(|d| d.as_secs())
+        .unwrap_or_default()
+}
+
+// Identifies the verification policy: results obtained under another one are
+// not reused.
+fn policy_fingerprint(allow_unsigned: bool) -> String {
+    format!("constraints={VERIFICATION_CONSTRAINTS_VERSION},allow_unsigned={allow_unsigned}")
+}
+
+// Signatures are stored next to the image in its repository, so results are
+// cached per repository and digest.
+fn cache_key(image: &Reference, digest: &str) -> String {
+    format!("{}/{}@{}", image.registry(), image.repository(), digest)
+}
+
+impl CachedVerification {
+    fn is_valid(&self, now: u64, allow_unsigned: bool) -> bool {
+        now < self.expires && (self.signed || allow_unsigned)
+    }
 }
 
 #[cfg(test)]
@@ -30,7 +83,10 @@ fn get_tuf_path() -> Option<PathBuf> {
 }
 
 impl CosignVerifier {
-    pub(crate) async fn new(allow_unsigned: bool) -> Result<Self, anyhow::Error> {
+    pub(crate) async fn new(
+        allow_unsigned: bool,
+        cache_ttl: Duration,
+    ) -> Result<Self, anyhow::Error> {
         info!("Starting Cosign Verifier, downloading data from Sigstore TUF repository");
 
         let oci_config = ClientConfig {
@@ -53,17 +109,39 @@ impl CosignVerifier {
         Ok(Self {
             client: cosign_client,
             allow_unsigned,
+            cache_ttl,
         })
     }
 
+    /// Verifies the signature of an image, unless the same image digest
+    /// already passed verification in the last `cache_ttl`.
+    ///
+    /// Images referenced by digest are looked up in the cache straight away,
+    /// the others once their tag has been resolved to a digest, which still
+    /// takes a request to the registry but skips fetching and checking the
+    /// signatures. Only successful verifications are cached, and the cache is
+    /// emptied whenever the signing policy changes.
     pub(crate) async fn verify(
         &mut self,
-        image: &str,
+        root_db: &Db,
+        image_url: &str,
         username: Option<&str>,
         password: Option<&str>,
     ) -> Result<(), anyhow::Error> {
         debug!("CosignVerifier::verify()");
-        let image = OciReference::from_str(image)?;
+        let cache = self.open_cache(root_db);
+        let reference = Reference::from_str(image_url).ok();
+
+        if let (Some(cache), Some(reference)) = (&cache, &reference) {
+            if let Some(digest) = reference.digest() {
+                if self.is_cached(cache, &cache_key(reference, digest)) {
+                    debug!("The bytecode image: {} was already verified", image_url);
+                    return Ok(());
+                }
+            }
+        }
+
+        let image = OciReference::from_str(image_url)?;
         let auth = if let (Some(username), Some(password)) = (username, password) {
             Auth::Basic(username.to_string(), password.to_string())
         } else {
@@ -74,10 +152,88 @@ impl CosignVerifier {
         let (cosign_signature_image, source_image_digest) =
             self.client.triangulate(&image, &auth).await?;
 
+        let key = reference.map(|r| cache_key(&r, &source_image_digest));
+        if let (Some(cache), Some(key)) = (&cache, &key) {
+            if self.is_cached(cache, key) {
+                debug!("The bytecode image: {} was already verified", image_url);
+                return Ok(());
+            }
+        }
+
+        let signed = self
+            .verify_signature(&image, &auth, &source_image_digest, &cosign_signature_image)
+            .await?;
+
+        if let (Some(cache), Some(key)) = (&cache, &key) {
+            self.cache_result(cache, key, signed);
+        }
+        Ok(())
+    }
+
+    // Returns the verification cache, after emptying it if it holds results
+    // obtained under another policy, or None if caching is disabled or the
+    // cache can't be used.
+    fn open_cache(&self, root_db: &Db) -> Option<Tree> {
+        if self.cache_ttl.is_zero() {
+            return None;
+        }
+        let cache = root_db
+            .open_tree(VERIFICATION_CACHE_TREE)
+            .map_err(|e| warn!("Unable to open the verification cache: {e}"))
+            .ok()?;
+
+        let policy = policy_fingerprint(self.allow_unsigned);
+        let current = cache.get(VERIFICATION_CACHE_POLICY_KEY).ok()?;
+        if current.as_deref() != Some(policy.as_bytes()) {
+            debug!("Signing policy changed, emptying the verification cache");
+            cache
+                .clear()
+                .and_then(|_| cache.insert(VERIFICATION_CACHE_POLICY_KEY, policy.as_bytes()))
+                .map_err(|e| warn!("Unable to reset the verification cache: {e}"))
+                .ok()?;
+        }
+        Some(cache)
+    }
+
+    fn is_cached(&self, cache: &Tree, key: &str) -> bool {
+        let Ok(Some(value)) = cache.get(key) else {
+            return false;
+        };
+        match serde_json::from_slice::<CachedVerification>(&value) {
+            Ok(cached) if cached.is_valid(now_secs(), self.allow_unsigned) => true,
+            _ => {
+                let _ = cache.remove(key);
+                false
+            }
+        }
+    }
+
+    fn cache_result(&self, cache: &Tree, key: &str, signed: bool) {
+        let cached = CachedVerification {
+            signed,
+            expires: now_secs().saturating_add(self.cache_ttl.as_secs()),
+        };
+        let result = serde_json::to_vec(&cached)
+            .map_err(|e| e.to_string())
+            .and_then(|value| cache.insert(key, value).map_err(|e| e.to_string()));
+        if let Err(e) = result {
+            warn!("Unable to cache the verification of {key}: {e}");
+        }
+    }
+
+    // Checks the signatures of an image, returning whether it is signed, or
+    // an error if it isn't signed and unsigned images aren't allowed.
+    async fn verify_signature(
+        &mut self,
+        image: &OciReference,
+        auth: &Auth,
+        source_image_digest: &str,
+        cosign_signature_image: &OciReference,
+    ) -> Result<bool, anyhow::Error> {
         debug!("Getting trusted layers");
         match self
             .client
-            .trusted_signature_layers(&auth, &source_image_digest, &cosign_signature_image)
+            .trusted_signature_layers(auth, source_image_digest, cosign_signature_image)
             .await
         {
             Ok(trusted_layers) => {
@@ -88,7 +244,7 @@ impl CosignVerifier {
                 let verification_constraints: VerificationConstraintVec = Vec::new();
                 verify_constraints(&trusted_layers, verification_constraints.iter())
                     .map_err(|e| anyhow!("Error verifying constraints: {}", e))?;
-                Ok(())
+                Ok(true)
             }
             Err(e) => match e {
                 RegistryPullManifestError { .. } => {
@@ -96,7 +252,7 @@ impl CosignVerifier {
                         bail!("Error triangulating image: {}", e);
                     } else {
                         warn!("The bytecode image: {} is unsigned", image);
-                        Ok(())
+                        Ok(false)
                     }
                 }
                 _ => {
@@ -127,3 +283,35 @@ async fn fetch_sigstore_tuf_data() -> anyhow::Result<Box<dyn sigstore::trust::Tr
 
     Ok(Box::new(tuf))
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cached_verification_validity() {
+        let signed = CachedVerification {
+            signed: true,
+            expires: 100,
+        };
+        assert!(signed.is_valid(99, false));
+        assert!(!signed.is_valid(100, false));
+
+        // Unsigned images only passed because they were allowed.
+        let unsigned = CachedVerification {
+            signed: false,
+            expires: 100,
+        };
+        assert!(unsigned.is_valid(99, true));
+        assert!(!unsigned.is_valid(99, false));
+    }
+
+    #[test]
+    fn test_cache_key() {
+        let image = Reference::from_str("quay.io/bpfman/xdp-dispatcher:latest").unwrap();
+        assert_eq!(
+            cache_key(&image, "sha256:0123"),
+            "quay.io/bpfman/xdp-dispatcher@sha256:0123"
+        );
+    }
+}
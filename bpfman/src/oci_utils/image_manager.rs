@@ -1,9 +1,16 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
-use std::io::{copy, Read};
+use std::{
+    collections::HashSet,
+    io::{self, Read},
+    pin::Pin,
+    task::{Context, Poll},
+    time::Duration,
+};
 
 use flate2::read::GzDecoder;
+use futures::{stream, StreamExt};
 use log::{debug, trace};
 use oci_distribution::{
     client::{ClientConfig, ClientProtocol},
@@ -17,12 +24,95 @@ use serde_json::Value;
 use sha2::{Digest, Sha256};
 use sled::Db;
 use tar::Archive;
+use tokio::io::AsyncWrite;
 
 use crate::{
-    oci_utils::{cosign::CosignVerifier, ImageError},
-    types::ImagePullPolicy,
+    oci_utils::{
+        bytecode_store::{Bytecode, BytecodeStore},
+        cosign::CosignVerifier,
+        ImageError,
+    },
+    types::{BytecodeImage, ImagePullPolicy},
 };
 
+/// Maximum number of images pulled at the same time by `get_images`.
+const MAX_CONCURRENT_PULLS: usize = 8;
+
+/// The first bytes of a gzip stream, which bytecode layers are.
+const GZIP_MAGIC: [u8; 2] = [0x1f, 0x8b];
+
+/// The layer media types bytecode images are built with.
+const BYTECODE_LAYER_MEDIA_TYPES: [&str; 2] = [
+    manifest::IMAGE_LAYER_GZIP_MEDIA_TYPE,
+    manifest::IMAGE_DOCKER_LAYER_GZIP_MEDIA_TYPE,
+];
+
+/// Collects a blob as it is downloaded and hashes it on the way, so that it
+/// doesn't have to be read again to be verified.
+struct HashingWriter {
+    hasher: Sha256,
+    data: Vec<u8>,
+}
+
+impl HashingWriter {
+    fn with_capacity(capacity: usize) -> Self {
+        Self {
+            hasher: Sha256::new(),
+            data: Vec::with_capacity(capacity),
+        }
+    }
+
+    /// Returns the blob and its digest, in the `sha256:<hex>` form manifests
+    /// use.
+    fn finish(self) -> (Vec<u8>, String) {
+        let digest =
+            "sha256:".to_owned() + &base16ct::lower::encode_string(&self.hasher.finalize());
+        (self.data, digest)
+    }
+}
+
+impl AsyncWrite for HashingWriter {
+    fn poll_write(
+        self: Pin<&mut Self>,
+        _cx: &mut Context<'_>,
+        buf: &[u8],
+    ) -> Poll<io::Result<usize>> {
+        let this = self.get_mut();
+        this.hasher.update(buf);
+        this.data.extend_from_slice(buf);
+        Poll::Ready(Ok(buf.len()))
+    }
+
+    fn poll_flush(self: Pin<&mut Self>, _cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Poll::Ready(Ok(()))
+    }
+
+    fn poll_shutdown(self: Pin<&mut Self>, _cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Poll::Ready(Ok(()))
+    }
+}
+
+/// Extracts the bytecode from a bytecode image layer, which is the first file
+/// of a gzipped tarball. Only as much of the layer as needed to reach the end
+/// of that file is decompressed.
+fn extract_bytecode(layer: &[u8]) -> Result<Vec<u8>, ImageError> {
+    // The data is of OCI media type "application/vnd.oci.image.layer.v1.tar+gzip" or
+    // "application/vnd.docker.image.rootfs.diff.tar.gzip"
+    let unzipped_tarball = GzDecoder::new(layer);
+    let mut archive = Archive::new(unzipped_tarball);
+    let mut entry = archive
+        .entries()
+        .map_err(|_| ImageError::BytecodeImageExtractFailure)?
+        .find_map(|e| e.ok())
+        .ok_or(ImageError::BytecodeImageExtractFailure)?;
+
+    let mut bytes = Vec::with_capacity(entry.size() as usize);
+    entry
+        .read_to_end(&mut bytes)
+        .map_err(|_| ImageError::BytecodeImageExtractFailure)?;
+    Ok(bytes)
+}
+
 #[derive(Deserialize)]
 #[allow(dead_code)]
 // TODO(astoycos) upgrade the oci image spec based on
@@ -41,11 +131,18 @@ pub struct ContainerImageMetadata {
 pub struct ImageManager {
     client: Client,
     cosign_verifier: CosignVerifier,
+    // Images whose signature was already verified by this ImageManager, so
+    // that e.g. batch loads only verify each dispatcher image once.
+    verified_images: HashSet<String>,
+    bytecode_store: BytecodeStore,
 }
 
 impl ImageManager {
-    pub async fn new(allow_unsigned: bool) -> Result<Self, anyhow::Error> {
-        let cosign_verifier = CosignVerifier::new(allow_unsigned).await?;
+    pub async fn new(
+        allow_unsigned: bool,
+        verification_cache_ttl: Duration,
+    ) -> Result<Self, anyhow::Error> {
+        let cosign_verifier = CosignVerifier::new(allow_unsigned, verification_cache_ttl).await?;
         let config = ClientConfig {
             protocol: ClientProtocol::Https,
             ..Default::default()
@@ -54,6 +151,8 @@ impl ImageManager {
         Ok(Self {
             cosign_verifier,
             client,
+            verified_images: HashSet::new(),
+            bytecode_store: BytecodeStore::default(),
         })
     }
 
@@ -68,11 +167,79 @@ impl ImageManager {
         // The reference created here is created using the krustlet oci-distribution
         // crate. It currently contains many defaults more of which can be seen
         // here: https://github.com/krustlet/oci-distribution/blob/main/src/reference.rs#L58
-        let image: Reference = image_url.parse().map_err(ImageError::InvalidImageUrl)?;
-
-        self.cosign_verifier
-            .verify(image_url, username.as_deref(), password.as_deref())
+        self.verify(root_db, image_url, username.as_deref(), password.as_deref())
             .await?;
+        self.fetch_image(root_db, image_url, pull_policy, username, password)
+            .await
+    }
+
+    /// Gets several images like `get_image`, pulling up to
+    /// `MAX_CONCURRENT_PULLS` of them at the same time, and returns the result
+    /// for each, in the order they were given.
+    ///
+    /// The signatures are still verified one image at a time, the verifier
+    /// isn't shared, but pulling dominates the time to get a set of images.
+    pub(crate) async fn get_images(
+        &mut self,
+        root_db: &Db,
+        images: &[BytecodeImage],
+    ) -> Vec<Result<(String, String), ImageError>> {
+        let mut verified = Vec::with_capacity(images.len());
+        for image in images {
+            verified.push(
+                self.verify(
+                    root_db,
+                    &image.image_url,
+                    image.username.as_deref(),
+                    image.password.as_deref(),
+                )
+                .await,
+            );
+        }
+
+        let this = &*self;
+        stream::iter(images.iter().zip(verified))
+            .map(|(image, verified)| async move {
+                verified?;
+                this.fetch_image(
+                    root_db,
+                    &image.image_url,
+                    image.image_pull_policy.clone(),
+                    image.username.clone(),
+                    image.password.clone(),
+                )
+                .await
+            })
+            .buffered(MAX_CONCURRENT_PULLS)
+            .collect()
+            .await
+    }
+
+    async fn verify(
+        &mut self,
+        root_db: &Db,
+        image_url: &str,
+        username: Option<&str>,
+        password: Option<&str>,
+    ) -> Result<(), ImageError> {
+        if !self.verified_images.contains(image_url) {
+            self.cosign_verifier
+                .verify(root_db, image_url, username, password)
+                .await?;
+            self.verified_images.insert(image_url.to_string());
+        }
+        Ok(())
+    }
+
+    async fn fetch_image(
+        &self,
+        root_db: &Db,
+        image_url: &str,
+        pull_policy: ImagePullPolicy,
+        username: Option<String>,
+        password: Option<String>,
+    ) -> Result<(String, String), ImageError> {
+        let image: Reference = image_url.parse().map_err(ImageError::InvalidImageUrl)?;
 
         let image_content_key = get_image_content_key(&image);
 
@@ -120,7 +287,7 @@ impl ImageManager {
     }
 
     pub async fn pull_image(
-        &mut self,
+        &self,
         root_db: &Db,
         image: Reference,
         base_key: &str,
@@ -167,10 +334,13 @@ impl ImageManager {
 
         let image_config_path = base_key.to_string() + config_sha;
 
-        let bytecode_sha = image_manifest.layers[0]
-            .digest
-            .split(':')
-            .collect::<Vec<&str>>()[1];
+        let layer = image_manifest
+            .layers
+            .first()
+            .filter(|l| BYTECODE_LAYER_MEDIA_TYPES.contains(&l.media_type.as_str()))
+            .ok_or(ImageError::BytecodeImageExtractFailure)?;
+
+        let bytecode_sha = layer.digest.split(':').collect::<Vec<&str>>()[1];
 
         let bytecode_path = base_key.to_string() + bytecode_sha;
 
@@ -192,25 +362,29 @@ impl ImageManager {
             ImageError::DatabaseError("failed to flush db".to_string(), e.to_string())
         })?;
 
-        let image_content = self
-            .client
-            .pull(
-                &image,
-                &auth,
-                vec![
-                    manifest::IMAGE_LAYER_GZIP_MEDIA_TYPE,
-                    manifest::IMAGE_DOCKER_LAYER_GZIP_MEDIA_TYPE,
-                ],
-            )
+        // Only the bytecode layer is pulled, and it is hashed as it streams
+        // in. pull_manifest_and_config() already authenticated the client.
+        let mut writer = HashingWriter::with_capacity(layer.size.max(0) as usize);
+        self.client
+            .pull_blob(&image, layer, &mut writer)
             .await
-            .map_err(ImageError::BytecodeImagePullFailure)?
-            .layers
-            .into_iter()
-            .next()
-            .map(|layer| layer.data)
-            .ok_or(ImageError::BytecodeImageExtractFailure)?;
+            .map_err(ImageError::BytecodeImagePullFailure)?;
+        let (image_content, digest) = writer.finish();
+        if digest != layer.digest {
+            return Err(ImageError::ByteCodeImageProcessFailure(anyhow::anyhow!(
+                "bytecode layer of {image} has digest {digest}, expected {}",
+                layer.digest
+            )));
+        }
+
+        // The layer was just verified, so unpack it into the bytecode store
+        // now, and only record where its bytecode is in the database.
+        let bytecode = self
+            .bytecode_store
+            .insert(&extract_bytecode(&image_content)?)?;
+        let digest = bytecode.digest().unwrap_or_default();
 
-        root_db.insert(bytecode_path, image_content).map_err(|e| {
+        root_db.insert(bytecode_path, digest).map_err(|e| {
             ImageError::DatabaseError("failed to write to db".to_string(), e.to_string())
         })?;
         root_db.flush().map_err(|e| {
@@ -224,7 +398,7 @@ impl ImageManager {
         &self,
         root_db: &Db,
         base_key: String,
-    ) -> Result<Vec<u8>, ImageError> {
+    ) -> Result<Bytecode, ImageError> {
         let manifest = serde_json::from_str::<OciImageManifest>(
             std::str::from_utf8(
                 &root_db
@@ -244,14 +418,8 @@ impl ImageManager {
         })?;
 
         let bytecode_sha = &manifest.layers[0].digest;
-
         let bytecode_key = base_key + bytecode_sha.clone().split(':').collect::<Vec<&str>>()[1];
 
-        debug!(
-            "bytecode is stored as tar+gzip file at key {}",
-            bytecode_key
-        );
-
         let f = root_db
             .get(bytecode_key.clone())
             .map_err(|e| ImageError::DatabaseError("failed to read db".to_string(), e.to_string()))?
@@ -260,9 +428,22 @@ impl ImageManager {
                 String::new(),
             ))?;
 
-        let mut hasher = Sha256::new();
-        copy(&mut f.as_ref(), &mut hasher).expect("cannot copy bytecode to hasher");
-        let hash = hasher.finalize();
+        if !f.starts_with(&GZIP_MAGIC) {
+            let digest = std::str::from_utf8(&f).map_err(|e| {
+                ImageError::DatabaseError("invalid bytecode digest".to_string(), e.to_string())
+            })?;
+            debug!("bytecode for key {bytecode_key} is {digest} in the bytecode store");
+            return self.bytecode_store.get(digest);
+        }
+
+        // Images pulled before the bytecode store existed have the whole
+        // layer in the database: move its bytecode to the store.
+        debug!(
+            "bytecode is stored as tar+gzip file at key {}",
+            bytecode_key
+        );
+
+        let hash = Sha256::digest(&f);
         let expected_sha = "sha256:".to_owned() + &base16ct::lower::encode_string(&hash);
 
         if *bytecode_sha != expected_sha {
@@ -273,26 +454,14 @@ impl ImageManager {
             panic!("Bpf Bytecode has been compromised")
         }
 
-        // The data is of OCI media type "application/vnd.oci.image.layer.v1.tar+gzip" or
-        // "application/vnd.docker.image.rootfs.diff.tar.gzip"
-        // decode and unpack to access bytecode
-        let unzipped_tarball = GzDecoder::new(f.as_ref());
-
-        return Ok(Archive::new(unzipped_tarball)
-            .entries()
-            .expect("unable to parse tarball entries")
-            .filter_map(|e| e.ok())
-            .map(|mut entry| {
-                let mut data = Vec::new();
-                entry
-                    .read_to_end(&mut data)
-                    .expect("unable to read bytecode tarball entry");
-                data
-            })
-            .collect::<Vec<Vec<u8>>>()
-            .first()
-            .expect("unable to get bytecode file bytes")
-            .to_owned());
+        let bytecode = self.bytecode_store.insert(&extract_bytecode(&f)?)?;
+        root_db
+            .insert(bytecode_key, bytecode.digest().unwrap_or_default())
+            .map_err(|e| {
+                ImageError::DatabaseError("failed to write to db".to_string(), e.to_string())
+            })?;
+
+        Ok(bytecode)
     }
 
     fn load_image_meta(
@@ -342,6 +511,28 @@ impl ImageManager {
     }
 }
 
+/// Returns the digests, in the bytecode store, of the bytecode of the images
+/// cached in the database. Only the current version of an image counts, not
+/// the bytecode of earlier pulls of its tag.
+pub(crate) fn image_bytecode_digests(root_db: &Db) -> HashSet<String> {
+    root_db
+        .scan_prefix("")
+        .flatten()
+        .filter_map(|(key, manifest)| {
+            let base_key = std::str::from_utf8(&key)
+                .ok()?
+                .strip_suffix("manifest.json")?;
+            let manifest: OciImageManifest = serde_json::from_slice(&manifest).ok()?;
+            let bytecode_sha = manifest.layers.first()?.digest.split(':').nth(1)?;
+            let digest = root_db.get(base_key.to_string() + bytecode_sha).ok()??;
+            if digest.starts_with(&GZIP_MAGIC) {
+                return None;
+            }
+            std::str::from_utf8(&digest).ok().map(String::from)
+        })
+        .collect()
+}
+
 fn get_image_content_key(image: &Reference) -> String {
     // Try to get the tag, if it doesn't exist, get the digest
     // if neither exist, return "latest" as the tag
@@ -373,7 +564,7 @@ mod tests {
         let root_db = init_database(get_db_config())
             .await
             .expect("Unable to open root database for unit test");
-        let mut mgr = ImageManager::new(true).await.unwrap();
+        let mut mgr = ImageManager::new(true, Duration::ZERO).await.unwrap();
         let (image_content_key, _) = mgr
             .get_image(
                 &root_db,
@@ -397,7 +588,7 @@ mod tests {
 
     #[tokio::test]
     async fn image_pull_policy_never_failure() {
-        let mut mgr = ImageManager::new(true).await.unwrap();
+        let mut mgr = ImageManager::new(true, Duration::ZERO).await.unwrap();
         let root_db = init_database(get_db_config())
             .await
             .expect("Unable to open root database for unit test");
@@ -418,7 +609,7 @@ mod tests {
     #[tokio::test]
     #[should_panic]
     async fn private_image_pull_failure() {
-        let mut mgr = ImageManager::new(true).await.unwrap();
+        let mut mgr = ImageManager::new(true, Duration::ZERO).await.unwrap();
         let root_db = init_database(get_db_config())
             .await
             .expect("Unable to open root database for unit test");
@@ -436,7 +627,7 @@ mod tests {
 
     #[tokio::test]
     async fn private_image_pull_and_bytecode_verify() {
-        let mut mgr = ImageManager::new(true).await.unwrap();
+        let mut mgr = ImageManager::new(true, Duration::ZERO).await.unwrap();
         let root_db = init_database(get_db_config())
             .await
             .expect("Unable to open root database for unit test");
@@ -464,7 +655,7 @@ mod tests {
 
     #[tokio::test]
     async fn image_pull_failure() {
-        let mut mgr = ImageManager::new(true).await.unwrap();
+        let mut mgr = ImageManager::new(true, Duration::ZERO).await.unwrap();
         let root_db = init_database(get_db_config())
             .await
             .expect("Unable to open root database for unit test");
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Authors of bpfman
 
+pub(crate) mod bytecode_store;
 pub(crate) mod cosign;
 pub mod image_manager;
 
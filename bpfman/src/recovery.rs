@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! Recovery of the state earlier bpfman processes left in the database.
+//!
+//! Only the program registry is loaded before bpfman starts serving, which
+//! rebuilds it in parallel if the database doesn't have one, and the bytecode
+//! store is swept of the bytecode nothing refers to anymore, as that can't
+//! race with programs being added yet. The state is then checked for
+//! consistency with what is pinned in bpffs in the background, once requests
+//! are served.
+//!
+//! The check runs in dependency order, map owners first, then the programs
+//! using their maps, then the dispatchers the programs are attached through,
+//! and processes the objects of each phase in parallel. Each phase is timed
+//! and logged. Inconsistencies, such as state left behind by a reboot, are
+//! logged rather than repaired.
+
+use std::{
+    collections::HashSet,
+    time::{Duration, Instant},
+};
+
+use log::{info, warn};
+use sled::Db;
+
+use crate::{
+    calc_map_pin_path,
+    errors::BpfmanError,
+    multiprog::{Dispatcher, TC_DISPATCHER_PREFIX, XDP_DISPATCHER_PREFIX},
+    oci_utils::{bytecode_store::BytecodeStore, image_manager::image_bytecode_digests},
+    registry,
+    types::{Program, ProgramData, PROGRAM_PREFIX},
+    utils::{bytes_to_string, parallel_map},
+    MAP_PREFIX,
+};
+
+/// What a recovery pass went through, and how long each phase took.
+#[derive(Debug, Default)]
+pub(crate) struct RecoveryReport {
+    pub(crate) phases: Vec<(&'static str, Duration)>,
+    pub(crate) map_owners: usize,
+    pub(crate) programs: usize,
+    pub(crate) dispatchers: usize,
+    /// Descriptions of the inconsistencies found.
+    pub(crate) stale: Vec<String>,
+}
+
+impl RecoveryReport {
+    fn phase<T>(&mut self, name: &'static str, f: impl FnOnce(&mut Self) -> T) -> T {
+        let started = Instant::now();
+        let result = f(self);
+        self.phases.push((name, started.elapsed()));
+        result
+    }
+}
+
+fn tree_names(root_db: &Db, prefix: &str) -> Vec<String> {
+    root_db
+        .tree_names()
+        .into_iter()
+        .map(|n| bytes_to_string(&n))
+        .filter(|n| n.starts_with(prefix))
+        .collect()
+}
+
+// Returns the ids of the map owners whose maps are still pinned.
+fn recover_map_owners(root_db: &Db, report: &mut RecoveryReport) -> HashSet<u32> {
+    // Map trees are named after the id of their owner, which also tells them
+    // apart from the map_used_by_ trees.
+    let owners: Vec<u32> = tree_names(root_db, MAP_PREFIX)
+        .iter()
+        .filter_map(|n| n[MAP_PREFIX.len()..].parse().ok())
+        .collect();
+    report.map_owners = owners.len();
+
+    let pinned = parallel_map(&owners, |id| calc_map_pin_path(*id).is_dir());
+    owners
+        .into_iter()
+        .zip(pinned)
+        .filter_map(|(id, pinned)| {
+            if !pinned {
+                report
+                    .stale
+                    .push(format!("maps of program {id} are not pinned"));
+            }
+            pinned.then_some(id)
+        })
+        .collect()
+}
+
+// Checks a program against the map owners found, returning a description of
+// what is wrong with it, if anything.
+fn check_program(
+    program: &Program,
+    map_owners: &HashSet<u32>,
+) -> Result<Option<String>, BpfmanError> {
+    let data = program.get_data();
+    let id = data.get_id()?;
+    if let Some(owner) = data.get_map_owner_id()? {
+        if !map_owners.contains(&owner) {
+            return Ok(Some(format!(
+                "program {id} uses the maps of program {owner}, which aren't pinned"
+            )));
+        }
+    }
+    if let Some(path) = data.get_map_pin_path()? {
+        if !path.is_dir() {
+            return Ok(Some(format!(
+                "maps of program {id} are not pinned at {}",
+                path.display()
+            )));
+        }
+    }
+    Ok(None)
+}
+
+// Returns the ids of the programs found in the registry.
+fn recover_programs(
+    root_db: &Db,
+    map_owners: &HashSet<u32>,
+    report: &mut RecoveryReport,
+) -> Result<HashSet<u32>, BpfmanError> {
+    let programs = registry::with_registry(root_db, |r| r.programs())?;
+    report.programs = programs.len();
+
+    let checked = parallel_map(&programs, |(id, name)| {
+        let tree = root_db
+            .open_tree(name)
+            .expect("unable to open database tree");
+        Program::new_from_db(*id, tree)
+            .and_then(|p| check_program(&p, map_owners))
+            .map_err(|e| e.to_string())
+    });
+    for ((id, _), result) in programs.iter().zip(checked) {
+        match result {
+            Ok(None) => {}
+            Ok(Some(stale)) => report.stale.push(stale),
+            Err(e) => report
+                .stale
+                .push(format!("program {id} can't be read: {e}")),
+        }
+    }
+    Ok(programs.into_iter().map(|(id, _)| id).collect())
+}
+
+// Checks a dispatcher is pinned and only has known programs in its slots.
+fn check_dispatcher(
+    dispatcher: &Dispatcher,
+    programs: &HashSet<u32>,
+) -> Result<Option<String>, BpfmanError> {
+    let dir = dispatcher.pin_dir()?;
+    if !dir.is_dir() {
+        return Ok(Some(format!("dispatcher {} is not pinned", dir.display())));
+    }
+    // Dispatchers loaded before the slot layout was recorded can't be
+    // checked further.
+    let slots = dispatcher
+        .slot_layout()?
+        .map(|l| l.programs)
+        .unwrap_or_default();
+    if let Some(id) = slots.iter().flatten().find(|id| !programs.contains(id)) {
+        return Ok(Some(format!(
+            "dispatcher {} has unknown program {id} in a slot",
+            dir.display()
+        )));
+    }
+    Ok(None)
+}
+
+fn recover_dispatchers(root_db: &Db, programs: &HashSet<u32>, report: &mut RecoveryReport) {
+    let mut trees = tree_names(root_db, XDP_DISPATCHER_PREFIX);
+    trees.extend(tree_names(root_db, TC_DISPATCHER_PREFIX));
+    report.dispatchers = trees.len();
+
+    // Every interface, and direction, has its own dispatcher.
+    let checked = parallel_map(&trees, |name| {
+        let tree = root_db
+            .open_tree(name)
+            .expect("unable to open database tree");
+        check_dispatcher(&Dispatcher::new_from_db(tree), programs).map_err(|e| e.to_string())
+    });
+    for (name, result) in trees.iter().zip(checked) {
+        match result {
+            Ok(None) => {}
+            Ok(Some(stale)) => report.stale.push(stale),
+            Err(e) => report
+                .stale
+                .push(format!("dispatcher {name} can't be read: {e}")),
+        }
+    }
+}
+
+/// Loads the program registry of `root_db`, rebuilding it if needed, and
+/// returns the number of programs in it.
+pub(crate) fn load_registry(root_db: &Db) -> Result<usize, BpfmanError> {
+    let started = Instant::now();
+    let programs = registry::with_registry(root_db, |r| r.programs().len())?;
+    info!(
+        "Loaded the registry of {programs} programs in {:?}",
+        started.elapsed()
+    );
+    Ok(programs)
+}
+
+/// Removes the bytecode that neither the programs nor the images cached in
+/// `root_db` refer to from the bytecode store, and returns how much was
+/// removed.
+pub(crate) fn sweep_bytecode(root_db: &Db) -> Result<usize, BpfmanError> {
+    let started = Instant::now();
+    // Every program tree is looked at, not only the registered ones, so that
+    // bytecode is never removed from under a program.
+    let trees: Vec<String> = root_db
+        .tree_names()
+        .into_iter()
+        .map(|n| bytes_to_string(&n))
+        .filter(|n| n.contains(PROGRAM_PREFIX))
+        .collect();
+    let digests = parallel_map(&trees, |name| {
+        let tree = root_db
+            .open_tree(name)
+            .expect("unable to open database tree");
+        ProgramData::new_empty(tree)
+            .get_program_bytecode_digest()
+            .map_err(|e| e.to_string())
+    });
+
+    let mut referenced = image_bytecode_digests(root_db);
+    for (name, digest) in trees.iter().zip(digests) {
+        match digest {
+            Ok(digest) => referenced.extend(digest),
+            Err(e) => {
+                return Err(BpfmanError::Error(format!(
+                    "unable to read the bytecode of {name}: {e}"
+                )))
+            }
+        }
+    }
+
+    let removed = BytecodeStore::default().sweep(&referenced)?;
+    info!(
+        "Removed {removed} unreferenced bytecode files in {:?}",
+        started.elapsed()
+    );
+    Ok(removed)
+}
+
+/// Checks the state of `root_db` against what is pinned in bpffs.
+pub(crate) fn check(root_db: &Db) -> Result<RecoveryReport, BpfmanError> {
+    let mut report = RecoveryReport::default();
+    let started = Instant::now();
+
+    let map_owners = report.phase("map owners", |r| recover_map_owners(root_db, r));
+    let programs = report.phase("programs", |r| recover_programs(root_db, &map_owners, r))?;
+    report.phase("dispatchers", |r| {
+        recover_dispatchers(root_db, &programs, r)
+    });
+
+    for stale in &report.stale {
+        warn!("Inconsistent state: {stale}");
+    }
+    let phases = report
+        .phases
+        .iter()
+        .map(|(name, elapsed)| format!("{name}: {elapsed:?}"))
+        .collect::<Vec<_>>()
+        .join(", ");
+    info!(
+        "Checked {} map owners, {} programs and {} dispatchers in {:?} ({phases})",
+        report.map_owners,
+        report.programs,
+        report.dispatchers,
+        started.elapsed()
+    );
+    Ok(report)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{get_db_config, init_database};
+
+    #[tokio::test]
+    async fn test_check_reports_unpinned_maps() {
+        let root_db = init_database(get_db_config())
+            .await
+            .expect("Unable to open root database for unit test");
+        root_db.open_tree("map_7").unwrap();
+        // Not a map owner.
+        root_db.open_tree("map_used_by_7").unwrap();
+
+        assert_eq!(load_registry(&root_db).unwrap(), 0);
+        let report = check(&root_db).unwrap();
+        assert_eq!(
+            report.phases.iter().map(|(p, _)| *p).collect::<Vec<_>>(),
+            vec!["map owners", "programs", "dispatchers"]
+        );
+        assert_eq!(report.map_owners, 1);
+        assert_eq!(report.programs, 0);
+        assert_eq!(report.dispatchers, 0);
+        assert_eq!(report.stale, vec!["maps of program 7 are not pinned"]);
+    }
+}
@@ -0,0 +1,425 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Authors of bpfman
+
+//! An index of the programs stored in the database, so that looking programs
+//! up by id, kind or attach point doesn't require opening and decoding every
+//! program tree.
+//!
+//! The index is persisted in its own tree next to the program trees, and kept
+//! in memory between calls. Every change stores a new random version in the
+//! database, which lets a process tell whether its in-memory copy is still
+//! current, since another bpfman process may have changed the database in the
+//! meantime.
+//!
+//! The registry also keeps the programs' shares of the memory of their maps,
+//! and the totals for the node and each namespace that map memory budgets are
+//! checked against, see map_memory.
+
+use std::{
+    collections::{BTreeMap, BTreeSet, HashMap},
+    sync::Mutex,
+};
+
+use lazy_static::lazy_static;
+use log::{debug, warn};
+use rand::Rng;
+use serde::{Deserialize, Serialize};
+use sled::{Db, Tree};
+
+use crate::{
+    errors::BpfmanError,
+    types::{Direction, Program, ProgramType, PROGRAM_PREFIX},
+    utils::{bytes_to_string, bytes_to_u64, parallel_map, sled_get_option, sled_insert},
+};
+
+const REGISTRY_TREE: &str = "registry";
+const VERSION: &str = "version";
+const ENTRY_PREFIX: &str = "entry_";
+const FORMAT: &str = "format";
+
+// Registries of an earlier format are rebuilt: 2 added the map memory of the
+// programs.
+const REGISTRY_FORMAT: u64 = 2;
+
+lazy_static! {
+    static ref REGISTRY: Mutex<Registry> = Mutex::new(Registry::default());
+}
+
+/// What the registry knows about a program, enough to find it without
+/// opening its tree.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub(crate) struct RegistryEntry {
+    pub(crate) id: u32,
+    pub(crate) kind: ProgramType,
+    pub(crate) if_index: Option<u32>,
+    pub(crate) direction: Option<Direction>,
+    /// The program's share of the memory of its maps.
+    #[serde(default)]
+    pub(crate) map_bytes_share: u64,
+    /// The namespace the program's map memory is accounted to.
+    #[serde(default)]
+    pub(crate) namespace: Option<String>,
+}
+
+impl RegistryEntry {
+    fn new(program: &Program) -> Result<Self, BpfmanError> {
+        let data = program.get_data();
+        Ok(Self {
+            id: data.get_id()?,
+            kind: program.kind(),
+            if_index: program.if_index().unwrap_or(None),
+            direction: program.direction()?,
+            map_bytes_share: data.get_map_bytes_share()?,
+            namespace: data.get_map_namespace()?,
+        })
+    }
+}
+
+type AttachPoint = (u32, Option<u32>, Option<Direction>);
+
+/// The in-memory copy of the index, keyed by program tree name.
+#[derive(Debug, Default)]
+pub(crate) struct Registry {
+    // Zero until the registry of a database is loaded.
+    version: u64,
+    entries: BTreeMap<String, RegistryEntry>,
+    by_kind: HashMap<u32, BTreeSet<String>>,
+    by_attach_point: HashMap<AttachPoint, BTreeSet<String>>,
+    // The sum of the map memory shares of the programs, and of those of each
+    // namespace.
+    map_bytes: u64,
+    map_bytes_by_namespace: HashMap<String, u64>,
+}
+
+impl Registry {
+    fn add(&mut self, tree: &str, entry: RegistryEntry) {
+        self.remove(tree);
+        self.map_bytes += entry.map_bytes_share;
+        if let Some(namespace) = &entry.namespace {
+            *self
+                .map_bytes_by_namespace
+                .entry(namespace.clone())
+                .or_default() += entry.map_bytes_share;
+        }
+        let kind = entry.kind.into();
+        self.by_kind
+            .entry(kind)
+            .or_default()
+            .insert(tree.to_string());
+        self.by_attach_point
+            .entry((kind, entry.if_index, entry.direction))
+            .or_default()
+            .insert(tree.to_string());
+        self.entries.insert(tree.to_string(), entry);
+    }
+
+    fn remove(&mut self, tree: &str) -> Option<RegistryEntry> {
+        let entry = self.entries.remove(tree)?;
+        self.map_bytes = self.map_bytes.saturating_sub(entry.map_bytes_share);
+        if let Some(namespace) = &entry.namespace {
+            if let Some(bytes) = self.map_bytes_by_namespace.get_mut(namespace) {
+                *bytes = bytes.saturating_sub(entry.map_bytes_share);
+                if *bytes == 0 {
+                    self.map_bytes_by_namespace.remove(namespace);
+                }
+            }
+        }
+        let kind = entry.kind.into();
+        if let Some(trees) = self.by_kind.get_mut(&kind) {
+            trees.remove(tree);
+        }
+        if let Some(trees) = self
+            .by_attach_point
+            .get_mut(&(kind, entry.if_index, entry.direction))
+        {
+            trees.remove(tree);
+        }
+        Some(entry)
+    }
+
+    /// Returns the tree of the fully loaded program with the given id.
+    pub(crate) fn program_tree(&self, id: u32) -> Option<String> {
+        let tree = format!("{PROGRAM_PREFIX}{id}");
+        self.entries.contains_key(&tree).then_some(tree)
+    }
+
+    fn with_ids<'a>(&self, trees: impl Iterator<Item = &'a String>) -> Vec<(u32, String)> {
+        trees
+            .filter_map(|t| self.entries.get(t).map(|e| (e.id, t.clone())))
+            .collect()
+    }
+
+    /// Returns the id and tree of every program, including those still being
+    /// loaded.
+    pub(crate) fn programs(&self) -> Vec<(u32, String)> {
+        self.with_ids(self.entries.keys())
+    }
+
+    /// Returns the id and tree of the programs of the given kind.
+    pub(crate) fn programs_of_kind(&self, kind: ProgramType) -> Vec<(u32, String)> {
+        self.with_ids(self.by_kind.get(&kind.into()).into_iter().flatten())
+    }
+
+    /// Returns the id and tree of the programs of the given kind attached, or
+    /// to be attached, to the given interface and direction.
+    pub(crate) fn programs_attached_to(
+        &self,
+        kind: ProgramType,
+        if_index: Option<u32>,
+        direction: Option<Direction>,
+    ) -> Vec<(u32, String)> {
+        self.with_ids(
+            self.by_attach_point
+                .get(&(kind.into(), if_index, direction))
+                .into_iter()
+                .flatten(),
+        )
+    }
+
+    /// Returns the map memory accounted to all the programs, and to the
+    /// programs of `namespace`.
+    pub(crate) fn map_bytes_in_use(&self, namespace: Option<&str>) -> (u64, u64) {
+        let in_namespace = namespace
+            .and_then(|n| self.map_bytes_by_namespace.get(n))
+            .copied()
+            .unwrap_or(0);
+        (self.map_bytes, in_namespace)
+    }
+
+    /// Returns whether the program with the given id is a program of a kind
+    /// other than `kind`.
+    pub(crate) fn is_other_kind(&self, id: u32, kind: ProgramType) -> bool {
+        self.program_tree(id)
+            .and_then(|t| self.entries.get(&t))
+            .map_or(false, |e| e.kind != kind)
+    }
+}
+
+fn open(root_db: &Db) -> Result<Tree, BpfmanError> {
+    root_db.open_tree(REGISTRY_TREE).map_err(|e| {
+        BpfmanError::DatabaseError("unable to open registry".to_string(), e.to_string())
+    })
+}
+
+fn new_version(tree: &Tree) -> Result<u64, BpfmanError> {
+    // Zero is reserved for a registry that isn't loaded.
+    let version = rand::thread_rng().gen_range(1..u64::MAX);
+    sled_insert(tree, VERSION, &version.to_ne_bytes())?;
+    Ok(version)
+}
+
+fn insert_entry(tree: &Tree, name: &str, entry: &RegistryEntry) -> Result<(), BpfmanError> {
+    let value = serde_json::to_vec(entry)
+        .map_err(|e| BpfmanError::Error(format!("unable to encode registry entry: {e}")))?;
+    sled_insert(tree, &format!("{ENTRY_PREFIX}{name}"), &value)
+}
+
+// Indexes the programs of a database that doesn't have a registry yet, or has
+// one of an earlier format. The program trees are decoded in parallel, as
+// there may be many of them.
+fn rebuild(root_db: &Db, tree: &Tree) -> Result<u64, BpfmanError> {
+    debug!("Rebuilding the program registry");
+    for key in tree.scan_prefix(ENTRY_PREFIX).keys() {
+        let key = key.map_err(|e| {
+            BpfmanError::DatabaseError("unable to read registry".to_string(), e.to_string())
+        })?;
+        tree.remove(key).map_err(|e| {
+            BpfmanError::DatabaseError("unable to remove registry entry".to_string(), e.to_string())
+        })?;
+    }
+
+    let programs: Vec<(u32, String)> = root_db
+        .tree_names()
+        .into_iter()
+        .map(|n| bytes_to_string(&n))
+        .filter(|n| n.contains(PROGRAM_PREFIX))
+        .filter_map(|name| {
+            let id = name.split('_').last()?.parse::<u32>().ok()?;
+            Some((id, name))
+        })
+        .collect();
+
+    let entries = parallel_map(&programs, |(id, name)| {
+        let program_tree = root_db
+            .open_tree(name)
+            .expect("unable to open database tree");
+        Program::new_from_db(*id, program_tree)
+            .and_then(|p| RegistryEntry::new(&p))
+            .map_err(|e| e.to_string())
+    });
+    for ((_, name), entry) in programs.iter().zip(entries) {
+        match entry {
+            Ok(entry) => insert_entry(tree, name, &entry)?,
+            Err(e) => warn!("Not indexing program tree {name}: {e}"),
+        }
+    }
+    sled_insert(tree, FORMAT, &REGISTRY_FORMAT.to_ne_bytes())?;
+    new_version(tree)
+}
+
+// Makes sure `registry` is the current registry of the database.
+fn refresh(root_db: &Db, tree: &Tree, registry: &mut Registry) -> Result<(), BpfmanError> {
+    let format = sled_get_option(tree, FORMAT)?.map(bytes_to_u64);
+    let version = match sled_get_option(tree, VERSION)? {
+        Some(v) if format == Some(REGISTRY_FORMAT) => bytes_to_u64(v),
+        _ => rebuild(root_db, tree)?,
+    };
+    if registry.version == version {
+        return Ok(());
+    }
+
+    let mut loaded = Registry {
+        version,
+        ..Default::default()
+    };
+    for r in tree.scan_prefix(ENTRY_PREFIX) {
+        let (k, v) = r.map_err(|e| {
+            BpfmanError::DatabaseError("unable to read registry".to_string(), e.to_string())
+        })?;
+        let entry: RegistryEntry = serde_json::from_slice(&v)
+            .map_err(|e| BpfmanError::Error(format!("unable to decode registry entry: {e}")))?;
+        loaded.add(&bytes_to_string(&k[ENTRY_PREFIX.len()..]), entry);
+    }
+    *registry = loaded;
+    Ok(())
+}
+
+/// Runs `f` on the registry of `root_db`.
+pub(crate) fn with_registry<T>(
+    root_db: &Db,
+    f: impl FnOnce(&Registry) -> T,
+) -> Result<T, BpfmanError> {
+    let tree = open(root_db)?;
+    let mut registry = REGISTRY.lock().unwrap();
+    refresh(root_db, &tree, &mut registry)?;
+    Ok(f(&registry))
+}
+
+// Runs `f` to change the registry of `root_db`, both in memory and in the
+// database.
+fn update(
+    root_db: &Db,
+    f: impl FnOnce(&Tree, &mut Registry) -> Result<(), BpfmanError>,
+) -> Result<(), BpfmanError> {
+    let tree = open(root_db)?;
+    let mut registry = REGISTRY.lock().unwrap();
+    refresh(root_db, &tree, &mut registry)?;
+    f(&tree, &mut registry)?;
+    registry.version = new_version(&tree)?;
+    Ok(())
+}
+
+/// Adds, or updates, the entry of a program stored in the given tree.
+pub(crate) fn register(root_db: &Db, name: &str, program: &Program) -> Result<(), BpfmanError> {
+    let entry = RegistryEntry::new(program)?;
+    update(root_db, |tree, registry| {
+        insert_entry(tree, name, &entry)?;
+        registry.add(name, entry);
+        Ok(())
+    })
+}
+
+/// Removes the entry of the program stored in the given tree, if any.
+pub(crate) fn unregister(root_db: &Db, name: &str) -> Result<(), BpfmanError> {
+    update(root_db, |tree, registry| {
+        tree.remove(format!("{ENTRY_PREFIX}{name}")).map_err(|e| {
+            BpfmanError::DatabaseError("unable to remove registry entry".to_string(), e.to_string())
+        })?;
+        registry.remove(name);
+        Ok(())
+    })
+}
+
+/// Moves the entry of a program to the tree it was moved to, under its new id.
+pub(crate) fn rename(root_db: &Db, from: &str, to: &str, id: u32) -> Result<(), BpfmanError> {
+    update(root_db, |tree, registry| {
+        let Some(mut entry) = registry.remove(from) else {
+            return Ok(());
+        };
+        tree.remove(format!("{ENTRY_PREFIX}{from}")).map_err(|e| {
+            BpfmanError::DatabaseError("unable to remove registry entry".to_string(), e.to_string())
+        })?;
+        entry.id = id;
+        insert_entry(tree, to, &entry)?;
+        registry.add(to, entry);
+        Ok(())
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn entry(id: u32, kind: ProgramType, if_index: Option<u32>) -> RegistryEntry {
+        RegistryEntry {
+            id,
+            kind,
+            if_index,
+            direction: None,
+            map_bytes_share: 0,
+            namespace: None,
+        }
+    }
+
+    #[test]
+    fn test_registry_indexes() {
+        let mut r = Registry::default();
+        r.add("program_1", entry(1, ProgramType::Xdp, Some(2)));
+        r.add("program_2", entry(2, ProgramType::Xdp, Some(2)));
+        r.add("program_3", entry(3, ProgramType::Xdp, Some(3)));
+        r.add("pre_load_program_7", entry(7, ProgramType::Xdp, Some(3)));
+        r.add("program_4", entry(4, ProgramType::Tracepoint, None));
+
+        assert_eq!(r.program_tree(3), Some("program_3".to_string()));
+        assert_eq!(r.program_tree(7), None);
+        assert_eq!(r.programs().len(), 5);
+        assert_eq!(r.programs_of_kind(ProgramType::Xdp).len(), 4);
+        assert_eq!(
+            r.programs_attached_to(ProgramType::Xdp, Some(2), None),
+            vec![(1, "program_1".to_string()), (2, "program_2".to_string())]
+        );
+        assert!(r.is_other_kind(4, ProgramType::Xdp));
+        assert!(!r.is_other_kind(1, ProgramType::Xdp));
+        assert!(!r.is_other_kind(5, ProgramType::Xdp));
+
+        // Moving a program to another interface updates every index.
+        r.add("program_2", entry(2, ProgramType::Xdp, Some(3)));
+        assert_eq!(
+            r.programs_attached_to(ProgramType::Xdp, Some(3), None),
+            vec![
+                (7, "pre_load_program_7".to_string()),
+                (2, "program_2".to_string()),
+                (3, "program_3".to_string())
+            ]
+        );
+
+        assert!(r.remove("program_3").is_some());
+        assert!(r.remove("program_3").is_none());
+        assert_eq!(r.programs_of_kind(ProgramType::Xdp).len(), 3);
+    }
+
+    #[test]
+    fn test_registry_map_bytes() {
+        let charged = |id, bytes, namespace: Option<&str>| RegistryEntry {
+            map_bytes_share: bytes,
+            namespace: namespace.map(String::from),
+            ..entry(id, ProgramType::Xdp, Some(2))
+        };
+        let mut r = Registry::default();
+        r.add("program_1", charged(1, 100, Some("tenant-a")));
+        r.add("program_2", charged(2, 50, Some("tenant-b")));
+        r.add("program_3", charged(3, 10, None));
+        assert_eq!(r.map_bytes_in_use(Some("tenant-a")), (160, 100));
+        assert_eq!(r.map_bytes_in_use(None), (160, 0));
+
+        // Another program sharing the maps of program 1 halves its share.
+        r.add("program_1", charged(1, 50, Some("tenant-a")));
+        r.add("program_4", charged(4, 50, Some("tenant-b")));
+        assert_eq!(r.map_bytes_in_use(Some("tenant-b")), (160, 100));
+
+        r.remove("program_2");
+        assert_eq!(r.map_bytes_in_use(Some("tenant-b")), (110, 50));
+        r.remove("program_4");
+        assert!(!r.map_bytes_by_namespace.contains_key("tenant-b"));
+    }
+}
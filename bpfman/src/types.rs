@@ -21,7 +21,11 @@ use crate::{
     directories::RTDIR_FS,
     errors::{BpfmanError, ParseError},
     multiprog::{DispatcherId, DispatcherInfo},
-    oci_utils::image_manager::ImageManager,
+    oci_utils::{
+        bytecode_store::{Bytecode, BytecodeStore},
+        image_manager::ImageManager,
+    },
+    registry,
     utils::{
         bytes_to_bool, bytes_to_i32, bytes_to_string, bytes_to_u32, bytes_to_u64, bytes_to_usize,
         sled_get, sled_get_option, sled_insert,
@@ -41,10 +45,15 @@ const LOCATION_USERNAME: &str = "location_username";
 const LOCATION_PASSWORD: &str = "location_password";
 const MAP_OWNER_ID: &str = "map_owner_id";
 const MAP_PIN_PATH: &str = "map_pin_path";
+const SHARE_MAPS: &str = "share_maps";
+const MAP_BYTES: &str = "map_bytes";
+const MAP_NAMESPACE: &str = "map_namespace";
 const PREFIX_GLOBAL_DATA: &str = "global_data_";
 const PREFIX_METADATA: &str = "metadata_";
 const PREFIX_MAPS_USED_BY: &str = "maps_used_by_";
 const PROGRAM_BYTES: &str = "program_bytes";
+// Set instead of PROGRAM_BYTES for bytecode from the bytecode store.
+const PROGRAM_BYTECODE_DIGEST: &str = "program_bytecode_digest";
 
 const KERNEL_NAME: &str = "kernel_name";
 const KERNEL_PROGRAM_TYPE: &str = "kernel_program_type";
@@ -65,6 +74,14 @@ const XDP_CURRENT_POSITION: &str = "xdp_current_position";
 const XDP_IF_INDEX: &str = "xdp_if_index";
 const XDP_ATTACHED: &str = "xdp_attached";
 const PREFIX_XDP_PROCEED_ON: &str = "xdp_proceed_on_";
+const XDP_CACHE_VERDICT: &str = "xdp_cache_verdict";
+const XDP_RX_QUEUE_MASK: &str = "xdp_rx_queue_mask";
+const XDP_SECTION: &str = "xdp_section";
+const XDP_FRAGS: &str = "xdp_frags";
+
+/// The number of RX queues an XDP program can be limited to, which are the
+/// queues with an index below it.
+pub const XDP_MAX_RX_QUEUES: u32 = 64;
 
 const TC_PRIORITY: &str = "tc_priority";
 const TC_IFACE: &str = "tc_iface";
@@ -224,9 +241,12 @@ impl Location {
         &self,
         root_db: &Db,
         image_manager: &mut ImageManager,
-    ) -> Result<(Vec<u8>, String), BpfmanError> {
+    ) -> Result<(Bytecode, String), BpfmanError> {
         match self {
-            Location::File(l) => Ok((crate::utils::read(l)?, "".to_owned())),
+            Location::File(l) => Ok((
+                Bytecode::Owned(crate::utils::read(l)?.into()),
+                "".to_owned(),
+            )),
             Location::Image(l) => {
                 let (path, bpf_function_name) = image_manager
                     .get_image(
@@ -288,6 +308,46 @@ impl std::fmt::Display for Direction {
     }
 }
 
+/// DispatcherSlotStats holds the statistics collected for a single program
+/// slot of a dispatcher that was loaded with stats collection enabled. All
+/// values are summed across CPUs.
+#[derive(Debug, Clone)]
+pub struct DispatcherSlotStats {
+    pub kind: ProgramType,
+    pub if_index: u32,
+    pub direction: Option<Direction>,
+    pub revision: u32,
+    pub slot: u32,
+    // Id of the program attached to the slot, if it could be found.
+    pub prog_id: Option<u32>,
+    pub count: u64,
+    pub run_time_ns: u64,
+    // Number of times each verdict was returned by the slot, indexed by
+    // verdict bucket (see `verdict_name`).
+    pub verdicts: Vec<u64>,
+    // Number of invocations per log2 latency bucket: bucket i counts the
+    // invocations that took between 2^i and 2^(i+1) nanoseconds.
+    pub latency: Vec<u64>,
+}
+
+impl DispatcherSlotStats {
+    /// Returns the name of the verdict counted in the given bucket, or "other"
+    /// for the bucket used to collect unknown return codes.
+    pub fn verdict_name(&self, bucket: usize) -> String {
+        match self.kind {
+            ProgramType::Xdp => XdpProceedOnEntry::try_from(bucket as i32)
+                .map(|v| v.to_string())
+                .unwrap_or_else(|_| "other".to_string()),
+            // TC verdicts are offset by one so that TC_ACT_UNSPEC (-1) is
+            // counted in bucket 0.
+            ProgramType::Tc => TcProceedOnEntry::try_from(bucket as i32 - 1)
+                .map(|v| v.to_string())
+                .unwrap_or_else(|_| "other".to_string()),
+            _ => "other".to_string(),
+        }
+    }
+}
+
 /// ProgramData stores information about bpf programs that are loaded and managed
 /// by bpfman.
 #[derive(Debug, Clone)]
@@ -304,6 +364,7 @@ impl ProgramData {
         metadata: HashMap<String, String>,
         global_data: HashMap<String, Vec<u8>>,
         map_owner_id: Option<u32>,
+        share_maps: bool,
     ) -> Result<Self, BpfmanError> {
         let db = sled::Config::default()
             .temporary(true)
@@ -327,6 +388,7 @@ impl ProgramData {
         if let Some(id) = map_owner_id {
             pd.set_map_owner_id(id)?;
         };
+        pd.set_share_maps(share_maps)?;
 
         Ok(pd)
     }
@@ -334,6 +396,37 @@ impl ProgramData {
     pub(crate) fn new_empty(tree: sled::Tree) -> Self {
         Self { db_tree: tree }
     }
+
+    /// Returns a copy of this, not yet loaded, program data in a new
+    /// temporary tree, including the program bytes if they are already set.
+    pub(crate) fn duplicate(&self) -> Result<Self, BpfmanError> {
+        let db = sled::Config::default()
+            .temporary(true)
+            .open()
+            .expect("unable to open temporary database");
+
+        let mut rng = rand::thread_rng();
+        let id_rand = rng.gen::<u32>();
+
+        let db_tree = db
+            .open_tree(PROGRAM_PRE_LOAD_PREFIX.to_string() + &id_rand.to_string())
+            .expect("Unable to open program database tree");
+
+        for r in self.db_tree.into_iter() {
+            let (k, v) = r.expect("unable to iterate db_tree");
+            db_tree.insert(k, v).map_err(|e| {
+                BpfmanError::DatabaseError(
+                    "unable to insert entry during copy".to_string(),
+                    e.to_string(),
+                )
+            })?;
+        }
+
+        let mut pd = Self { db_tree };
+        pd.set_id(id_rand)?;
+
+        Ok(pd)
+    }
     pub(crate) fn load(&mut self, root_db: &Db) -> Result<(), BpfmanError> {
         let db_tree = root_db
             .open_tree(self.db_tree.name())
@@ -356,6 +449,7 @@ impl ProgramData {
     }
 
     pub(crate) fn swap_tree(&mut self, root_db: &Db, new_id: u32) -> Result<(), BpfmanError> {
+        let old_name = self.db_tree_name();
         let new_tree = root_db
             .open_tree(PROGRAM_PREFIX.to_string() + &new_id.to_string())
             .expect("Unable to open program database tree");
@@ -377,10 +471,15 @@ impl ProgramData {
 
         self.db_tree = new_tree;
         self.set_id(new_id)?;
+        registry::rename(root_db, &old_name, &self.db_tree_name(), new_id)?;
 
         Ok(())
     }
 
+    pub(crate) fn db_tree_name(&self) -> String {
+        bytes_to_string(&self.db_tree.name())
+    }
+
     /*
      * Methods for setting and getting program data for programs managed by
      * bpfman.
@@ -552,6 +651,47 @@ impl ProgramData {
         sled_get_option(&self.db_tree, MAP_OWNER_ID).map(|v| v.map(bytes_to_u32))
     }
 
+    pub(crate) fn set_share_maps(&mut self, share_maps: bool) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, SHARE_MAPS, &(share_maps as i8).to_ne_bytes())
+    }
+
+    /// Returns whether the program uses the maps of the shared map pool of its
+    /// bytecode, if there are any, rather than creating its own.
+    pub fn get_share_maps(&self) -> Result<bool, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, SHARE_MAPS)?
+            .map(bytes_to_bool)
+            .unwrap_or(false))
+    }
+
+    pub(crate) fn set_map_bytes(&mut self, bytes: u64) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, MAP_BYTES, &bytes.to_ne_bytes())
+    }
+
+    /// Returns the estimated bytes of kernel memory taken by the maps the
+    /// program uses, whether it owns them or not.
+    pub fn get_map_bytes(&self) -> Result<u64, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, MAP_BYTES)?
+            .map(bytes_to_u64)
+            .unwrap_or(0))
+    }
+
+    /// Returns the program's share of the memory of its maps, which are
+    /// accounted evenly to the programs using them.
+    pub fn get_map_bytes_share(&self) -> Result<u64, BpfmanError> {
+        let users = self.get_maps_used_by()?.len().max(1) as u64;
+        Ok(self.get_map_bytes()? / users)
+    }
+
+    pub(crate) fn set_map_namespace(&mut self, namespace: &str) -> Result<(), BpfmanError> {
+        sled_insert(&self.db_tree, MAP_NAMESPACE, namespace.as_bytes())
+    }
+
+    /// Returns the namespace the memory of the program's maps is accounted
+    /// to, if any.
+    pub(crate) fn get_map_namespace(&self) -> Result<Option<String>, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, MAP_NAMESPACE)?.map(|v| bytes_to_string(&v)))
+    }
+
     pub(crate) fn set_map_pin_path(&mut self, path: &Path) -> Result<(), BpfmanError> {
         sled_insert(
             &self.db_tree,
@@ -601,8 +741,17 @@ impl ProgramData {
         });
     }
 
-    pub(crate) fn get_program_bytes(&self) -> Result<Vec<u8>, BpfmanError> {
-        sled_get(&self.db_tree, PROGRAM_BYTES)
+    /// Returns the digest of the program's bytecode in the bytecode store, if
+    /// it is there rather than in the database.
+    pub(crate) fn get_program_bytecode_digest(&self) -> Result<Option<String>, BpfmanError> {
+        Ok(sled_get_option(&self.db_tree, PROGRAM_BYTECODE_DIGEST)?.map(|v| bytes_to_string(&v)))
+    }
+
+    pub(crate) fn get_program_bytes(&self) -> Result<Bytecode, BpfmanError> {
+        if let Some(digest) = self.get_program_bytecode_digest()? {
+            return Ok(BytecodeStore::default().get(&digest)?);
+        }
+        sled_get(&self.db_tree, PROGRAM_BYTES).map(|v| Bytecode::Owned(v.into()))
     }
 
     pub(crate) async fn set_program_bytes(
@@ -639,8 +788,14 @@ impl ProgramData {
                         info!("Loading program bytecode from file: {}", l);
                     }
                 }
-                sled_insert(&self.db_tree, PROGRAM_BYTES, &v)?;
-                Ok(())
+                // Bytecode from the store is only referenced, so that programs
+                // sharing it don't each keep a copy in the database.
+                match v.digest() {
+                    Some(digest) => {
+                        sled_insert(&self.db_tree, PROGRAM_BYTECODE_DIGEST, digest.as_bytes())
+                    }
+                    None => sled_insert(&self.db_tree, PROGRAM_BYTES, &v),
+                }
             }
         }
     }
@@ -860,12 +1015,16 @@ impl XdpProgram {
         priority: i32,
         iface: String,
         proceed_on: XdpProceedOn,
+        cache_verdict: bool,
+        rx_queues: Vec<u32>,
     ) -> Result<Self, BpfmanError> {
         let mut xdp_prog = Self { data };
 
         xdp_prog.set_priority(priority)?;
         xdp_prog.set_iface(iface)?;
         xdp_prog.set_proceed_on(proceed_on)?;
+        xdp_prog.set_cache_verdict(cache_verdict)?;
+        xdp_prog.set_rx_queues(&rx_queues)?;
         xdp_prog.get_data_mut().set_kind(ProgramType::Xdp)?;
 
         Ok(xdp_prog)
@@ -920,6 +1079,74 @@ impl XdpProgram {
             .collect()
     }
 
+    pub(crate) fn set_cache_verdict(&mut self, cache_verdict: bool) -> Result<(), BpfmanError> {
+        sled_insert(
+            &self.data.db_tree,
+            XDP_CACHE_VERDICT,
+            &(cache_verdict as i8).to_ne_bytes(),
+        )
+    }
+
+    /// Returns whether the dispatcher caches the verdicts of this program that
+    /// end the chain, per flow, so that later packets of the flow skip the
+    /// chain.
+    pub fn get_cache_verdict(&self) -> Result<bool, BpfmanError> {
+        Ok(sled_get_option(&self.data.db_tree, XDP_CACHE_VERDICT)?
+            .map(bytes_to_bool)
+            .unwrap_or(false))
+    }
+
+    pub(crate) fn set_rx_queues(&mut self, rx_queues: &[u32]) -> Result<(), BpfmanError> {
+        let mut mask = 0u64;
+        for queue in rx_queues {
+            if *queue >= XDP_MAX_RX_QUEUES {
+                return Err(BpfmanError::Error(format!(
+                    "rx queue {queue} can't be selected, the highest is {}",
+                    XDP_MAX_RX_QUEUES - 1
+                )));
+            }
+            mask |= 1u64 << queue;
+        }
+        sled_insert(&self.data.db_tree, XDP_RX_QUEUE_MASK, &mask.to_ne_bytes())
+    }
+
+    /// Returns the mask of the RX queues the dispatcher runs this program for,
+    /// with bit n set for queue n, or 0 if it runs it for every queue.
+    pub(crate) fn get_rx_queue_mask(&self) -> Result<u64, BpfmanError> {
+        Ok(sled_get_option(&self.data.db_tree, XDP_RX_QUEUE_MASK)?
+            .map(bytes_to_u64)
+            .unwrap_or(0))
+    }
+
+    /// Returns the RX queues the dispatcher runs this program for, in
+    /// increasing order, or an empty list if it runs it for every queue.
+    pub fn get_rx_queues(&self) -> Result<Vec<u32>, BpfmanError> {
+        let mask = self.get_rx_queue_mask()?;
+        Ok((0..XDP_MAX_RX_QUEUES)
+            .filter(|q| mask & (1u64 << q) != 0)
+            .collect())
+    }
+
+    pub(crate) fn set_section(&mut self, section: &str) -> Result<(), BpfmanError> {
+        sled_insert(&self.data.db_tree, XDP_SECTION, section.as_bytes())
+    }
+
+    /// Returns the ELF section of the program's eBPF function, if it was
+    /// recorded when the program was added.
+    pub(crate) fn get_section(&self) -> Result<Option<String>, BpfmanError> {
+        Ok(sled_get_option(&self.data.db_tree, XDP_SECTION)?.map(|v| bytes_to_string(&v)))
+    }
+
+    pub(crate) fn set_frags(&mut self, frags: bool) -> Result<(), BpfmanError> {
+        sled_insert(&self.data.db_tree, XDP_FRAGS, &(frags as i8).to_ne_bytes())
+    }
+
+    /// Returns whether the program handles multi-buffer packets, if that was
+    /// recorded when the program was added.
+    pub(crate) fn get_frags(&self) -> Result<Option<bool>, BpfmanError> {
+        Ok(sled_get_option(&self.data.db_tree, XDP_FRAGS)?.map(bytes_to_bool))
+    }
+
     pub(crate) fn set_current_position(&mut self, pos: usize) -> Result<(), BpfmanError> {
         sled_insert(&self.data.db_tree, XDP_CURRENT_POSITION, &pos.to_ne_bytes())
     }
@@ -1419,9 +1646,16 @@ impl Program {
         }
     }
 
+    /// Adds the program, stored in `root_db`, to the registry so that it can
+    /// be found without scanning the database.
+    pub(crate) fn register(&self, root_db: &Db) -> Result<(), BpfmanError> {
+        registry::register(root_db, &self.get_data().db_tree_name(), self)
+    }
+
     pub(crate) fn delete(&self, root_db: &Db) -> Result<(), anyhow::Error> {
         let id = self.get_data().get_id()?;
         root_db.drop_tree(self.get_data().db_tree.name())?;
+        registry::unregister(root_db, &self.get_data().db_tree_name())?;
 
         let path = format!("{RTDIR_FS}/prog_{id}");
         if PathBuf::from(&path).exists() {
@@ -1454,6 +1688,27 @@ impl Program {
         }
     }
 
+    /// Returns a copy of this XDP or TC program, that hasn't been loaded yet,
+    /// to be attached to `iface` instead.
+    pub(crate) fn copy_for_iface(&self, iface: &str) -> Result<Program, BpfmanError> {
+        let data = self.get_data().duplicate()?;
+        match self {
+            Program::Xdp(_) => {
+                let mut p = XdpProgram { data };
+                p.set_iface(iface.to_string())?;
+                Ok(Program::Xdp(p))
+            }
+            Program::Tc(_) => {
+                let mut p = TcProgram { data };
+                p.set_iface(iface.to_string())?;
+                Ok(Program::Tc(p))
+            }
+            _ => Err(BpfmanError::Error(
+                "cannot set interface on programs other than TC or XDP".to_string(),
+            )),
+        }
+    }
+
     pub(crate) fn if_name(&self) -> Result<String, BpfmanError> {
         match self {
             Program::Xdp(p) => p.get_iface(),
@@ -16,6 +16,7 @@ use nix::{
     net::if_::if_nametoindex,
     sys::resource::{setrlimit, Resource},
 };
+use object::{Object, ObjectSection, ObjectSymbol, SymbolKind};
 use sled::Tree;
 
 use crate::{config::Config, directories::*, errors::BpfmanError};
@@ -80,6 +81,19 @@ pub(crate) fn should_map_be_pinned(name: &str) -> bool {
     !(name.contains(".rodata") || name.contains(".bss") || name.contains(".data"))
 }
 
+/// Returns the ELF section of the eBPF function `name` in `bytecode`, which
+/// is how a program declares its type and load flags (e.g. "xdp.frags").
+pub(crate) fn bpf_function_section(bytecode: &[u8], name: &str) -> Result<String, BpfmanError> {
+    let file = object::File::parse(bytecode)
+        .map_err(|e| BpfmanError::Error(format!("unable to parse bytecode: {e}")))?;
+    file.symbols()
+        .filter(|s| s.kind() == SymbolKind::Text && s.name() == Ok(name))
+        .find_map(|s| s.section_index())
+        .and_then(|i| file.section_by_index(i).ok())
+        .and_then(|s| s.name().ok().map(String::from))
+        .ok_or_else(|| BpfmanError::BpfFunctionNameNotValid(name.to_string()))
+}
+
 pub(crate) fn bytes_to_u32(bytes: Vec<u8>) -> u32 {
     u32::from_ne_bytes(
         bytes
@@ -206,6 +220,27 @@ pub(crate) fn get_error_msg_from_stderr(stderr: &[u8]) -> String {
         .to_string()
 }
 
+/// Runs `f` on every item, spread over as many threads as there are CPUs, and
+/// returns the results in the order of the items.
+pub(crate) fn parallel_map<T: Sync, R: Send>(items: &[T], f: impl Fn(&T) -> R + Sync) -> Vec<R> {
+    let threads = std::thread::available_parallelism().map_or(1, |n| n.get());
+    if threads == 1 || items.len() < 2 {
+        return items.iter().map(f).collect();
+    }
+    let chunk_size = items.len().div_ceil(threads);
+    let f = &f;
+    std::thread::scope(|s| {
+        let handles: Vec<_> = items
+            .chunks(chunk_size)
+            .map(|chunk| s.spawn(move || chunk.iter().map(f).collect::<Vec<R>>()))
+            .collect();
+        handles
+            .into_iter()
+            .flat_map(|h| h.join().unwrap_or_else(|e| std::panic::resume_unwind(e)))
+            .collect()
+    })
+}
+
 pub(crate) fn open_config_file() -> Config {
     if let Ok(c) = std::fs::read_to_string(CFGPATH_BPFMAN_CONFIG) {
         c.parse().unwrap_or_else(|_| {
@@ -270,6 +305,7 @@ pub(crate) fn initialize_bpfman() -> anyhow::Result<()> {
     create_dir_all(RTDIR_TUF).context("unable to create TUF directory")?;
 
     create_dir_all(STDIR).context("unable to create state directory")?;
+    create_dir_all(STDIR_BYTECODE).context("unable to create bytecode directory")?;
 
     create_dir_all(CFGDIR_STATIC_PROGRAMS).context("unable to create static programs directory")?;
 
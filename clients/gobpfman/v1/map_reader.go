@@ -0,0 +1,181 @@
+/*
+Copyright 2024.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package v1
+
+import (
+	"errors"
+	"fmt"
+
+	"github.com/cilium/ebpf"
+)
+
+// DefaultMapReadBatchSize is the number of keys a PerCpuMapReader reads per
+// BPF_MAP_LOOKUP_BATCH call unless told otherwise.
+const DefaultMapReadBatchSize = 256
+
+// PerCpuMapReader reads every entry of a per-CPU map pinned by bpfman and
+// aggregates the per-CPU values of each key.
+//
+// Entries are read with BPF_MAP_LOOKUP_BATCH, so a read costs one syscall per
+// batch of keys instead of one per key, and all buffers are allocated once and
+// reused between reads. On kernels without batch support for the map type,
+// the reader falls back to looking keys up one at a time.
+//
+// A PerCpuMapReader is not safe for concurrent use.
+type PerCpuMapReader[K comparable, V any] struct {
+	m   *ebpf.Map
+	add func(total *V, cpuValue *V)
+
+	nCpu      int
+	batchSize int
+	noBatch   bool
+
+	// Batch buffers, values holds nCpu values per key.
+	keys   []K
+	values []V
+
+	// Aggregated results of the last read.
+	outKeys   []K
+	outTotals []V
+}
+
+// NewPerCpuMapReader returns a reader of the given per-CPU map. `add` adds the
+// value of a key on one CPU to its running total.
+func NewPerCpuMapReader[K comparable, V any](
+	m *ebpf.Map,
+	add func(total *V, cpuValue *V),
+) (*PerCpuMapReader[K, V], error) {
+	switch m.Type() {
+	case ebpf.PerCPUArray, ebpf.PerCPUHash, ebpf.LRUCPUHash:
+	default:
+		return nil, fmt.Errorf("map type %s is not per-CPU", m.Type())
+	}
+
+	nCpu, err := ebpf.PossibleCPU()
+	if err != nil {
+		return nil, err
+	}
+
+	batchSize := DefaultMapReadBatchSize
+	if int(m.MaxEntries()) < batchSize {
+		batchSize = int(m.MaxEntries())
+	}
+
+	return &PerCpuMapReader[K, V]{
+		m:         m,
+		add:       add,
+		nCpu:      nCpu,
+		batchSize: batchSize,
+		keys:      make([]K, batchSize),
+		values:    make([]V, batchSize*nCpu),
+		outKeys:   make([]K, 0, m.MaxEntries()),
+		outTotals: make([]V, 0, m.MaxEntries()),
+	}, nil
+}
+
+// LoadPinnedPerCpuMapReader returns a reader of the per-CPU map pinned at path.
+func LoadPinnedPerCpuMapReader[K comparable, V any](
+	path string,
+	add func(total *V, cpuValue *V),
+) (*PerCpuMapReader[K, V], error) {
+	m, err := ebpf.LoadPinnedMap(path, &ebpf.LoadPinOptions{ReadOnly: true})
+	if err != nil {
+		return nil, err
+	}
+	r, err := NewPerCpuMapReader[K, V](m, add)
+	if err != nil {
+		m.Close()
+		return nil, err
+	}
+	return r, nil
+}
+
+// Close releases the map.
+func (r *PerCpuMapReader[K, V]) Close() error {
+	return r.m.Close()
+}
+
+// Read reads every entry of the map and returns its keys and the sum of their
+// per-CPU values, in matching order. The returned slices are owned by the
+// reader and only valid until the next call to Read.
+func (r *PerCpuMapReader[K, V]) Read() ([]K, []V, error) {
+	r.outKeys = r.outKeys[:0]
+	r.outTotals = r.outTotals[:0]
+
+	if r.noBatch {
+		return r.readEach()
+	}
+
+	var cursor ebpf.MapBatchCursor
+	for {
+		n, err := r.m.BatchLookup(&cursor, r.keys, r.values, nil)
+		for i := 0; i < n; i++ {
+			r.aggregate(r.keys[i], r.values[i*r.nCpu:(i+1)*r.nCpu])
+		}
+		switch {
+		case errors.Is(err, ebpf.ErrKeyNotExist):
+			// The whole map has been read.
+			return r.outKeys, r.outTotals, nil
+		case errors.Is(err, ebpf.ErrNotSupported):
+			r.noBatch = true
+			r.outKeys = r.outKeys[:0]
+			r.outTotals = r.outTotals[:0]
+			return r.readEach()
+		case err != nil:
+			return nil, nil, err
+		}
+	}
+}
+
+// Total returns the aggregated value of key from the last read.
+func (r *PerCpuMapReader[K, V]) Total(key K) (V, bool) {
+	for i, k := range r.outKeys {
+		if k == key {
+			return r.outTotals[i], true
+		}
+	}
+	var zero V
+	return zero, false
+}
+
+func (r *PerCpuMapReader[K, V]) aggregate(key K, cpuValues []V) {
+	var total V
+	for c := range cpuValues {
+		r.add(&total, &cpuValues[c])
+	}
+	r.outKeys = append(r.outKeys, key)
+	r.outTotals = append(r.outTotals, total)
+}
+
+// readEach is the fallback for kernels without batch lookups.
+func (r *PerCpuMapReader[K, V]) readEach() ([]K, []V, error) {
+	cpuValues := r.values[:r.nCpu]
+	var key K
+	iter := r.m.Iterate()
+	for iter.Next(&key, &cpuValues) {
+		r.aggregate(key, cpuValues)
+	}
+	if err := iter.Err(); err != nil {
+		return nil, nil, err
+	}
+	return r.outKeys, r.outTotals, nil
+}
+
+// SumUint64 is the add function of per-CPU maps of plain uint64 counters.
+func SumUint64(total *uint64, cpuValue *uint64) {
+	*total += *cpuValue
+}
@@ -0,0 +1,99 @@
+/*
+Copyright 2024.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+package v1
+
+import (
+	"fmt"
+	"sync/atomic"
+	"unsafe"
+
+	"github.com/cilium/ebpf"
+	"golang.org/x/sys/unix"
+)
+
+// mmapCounterSlotSize is the size of struct counter_rec in
+// examples/pkg/counters/bpf/counters.h, one cache line.
+const mmapCounterSlotSize = 64
+
+// MmapCounters reads the packet and byte counters of a BPF_F_MMAPABLE array
+// defined with DEFINE_MMAP_COUNTERS through a read-only shared mapping of the
+// map, so reads cost no syscall and no copy.
+//
+// The map holds one cache line sized slot per CPU and key, at index
+// `cpu * nKeys + key`, followed by a row of overflow slots shared by the CPUs
+// past MMAP_COUNTERS_MAX_CPUS. Read sums every row, overflow included.
+type MmapCounters struct {
+	mem   []byte
+	nKeys int
+	// The number of rows of slots, the overflow row included.
+	nRows int
+}
+
+// LoadPinnedMmapCounters maps the counters pinned at path, which hold nKeys
+// keys per CPU.
+func LoadPinnedMmapCounters(path string, nKeys int) (*MmapCounters, error) {
+	m, err := ebpf.LoadPinnedMap(path, &ebpf.LoadPinOptions{ReadOnly: true})
+	if err != nil {
+		return nil, err
+	}
+	// The mapping keeps the map alive once established.
+	defer m.Close()
+
+	if m.Type() != ebpf.Array || m.Flags()&unix.BPF_F_MMAPABLE == 0 {
+		return nil, fmt.Errorf("%s is not an mmapable array", path)
+	}
+	if m.ValueSize() != mmapCounterSlotSize {
+		return nil, fmt.Errorf("%s has %d byte values, expected %d",
+			path, m.ValueSize(), mmapCounterSlotSize)
+	}
+	if nKeys <= 0 || int(m.MaxEntries())%nKeys != 0 {
+		return nil, fmt.Errorf("%s has %d entries, not a multiple of %d keys",
+			path, m.MaxEntries(), nKeys)
+	}
+
+	size := int(m.MaxEntries()) * mmapCounterSlotSize
+	pageSize := unix.Getpagesize()
+	size = (size + pageSize - 1) / pageSize * pageSize
+	mem, err := unix.Mmap(m.FD(), 0, size, unix.PROT_READ, unix.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("unable to mmap %s: %w", path, err)
+	}
+
+	return &MmapCounters{
+		mem:   mem,
+		nKeys: nKeys,
+		nRows: int(m.MaxEntries()) / nKeys,
+	}, nil
+}
+
+// Close unmaps the counters.
+func (c *MmapCounters) Close() error {
+	return unix.Munmap(c.mem)
+}
+
+// Read returns the packets and bytes counted for key across all CPUs.
+func (c *MmapCounters) Read(key int) (packets uint64, bytes uint64) {
+	if key < 0 || key >= c.nKeys {
+		return 0, 0
+	}
+	for row := 0; row < c.nRows; row++ {
+		slot := unsafe.Pointer(&c.mem[(row*c.nKeys+key)*mmapCounterSlotSize])
+		packets += atomic.LoadUint64((*uint64)(slot))
+		bytes += atomic.LoadUint64((*uint64)(unsafe.Add(slot, 8)))
+	}
+	return packets, bytes
+}
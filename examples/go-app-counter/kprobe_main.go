@@ -23,6 +23,10 @@ type KprobeStats struct {
 	Counter uint64
 }
 
+func addKprobeStats(total *KprobeStats, cpuValue *KprobeStats) {
+	total.Counter += cpuValue.Counter
+}
+
 func processKprobe(cancelCtx context.Context, paramData *configMgmt.ParameterData) {
 	// determine the path to the kprobe_stats_map, whether provided via CRD
 	// or BPFMAN or otherwise.
@@ -124,6 +128,11 @@ func processKprobe(cancelCtx context.Context, paramData *configMgmt.ParameterDat
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, KprobeStats](statsMap, addKprobeStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
 
 	// retrieve and report on the number of times the kprobe is executed.
 	index := uint32(0)
@@ -134,17 +143,13 @@ func processKprobe(cancelCtx context.Context, paramData *configMgmt.ParameterDat
 			log.Printf("Exiting Kprobe...\n")
 			return
 		default:
-			var stats []KprobeStats
-			var totalCount uint64
-
-			if err := statsMap.Lookup(&index, &stats); err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Printf("map lookup failed: %v", err)
 				return
 			}
 
-			for _, stat := range stats {
-				totalCount += stat.Counter
-			}
+			stats, _ := statsReader.Total(index)
+			totalCount := stats.Counter
 
 			log.Printf("Kprobe: count: %d\n", totalCount)
 		}
@@ -20,6 +20,11 @@ type TCStats struct {
 	Bytes   uint64
 }
 
+func addTCStats(total *TCStats, cpuValue *TCStats) {
+	total.Packets += cpuValue.Packets
+	total.Bytes += cpuValue.Bytes
+}
+
 const (
 	TCBpfProgramMapIndex = "tc_stats_map"
 )
@@ -142,6 +147,11 @@ func processTC(cancelCtx context.Context, paramData *configMgmt.ParameterData) {
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, TCStats](statsMap, addTCStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
 
 	ticker := time.NewTicker(2 * time.Second)
 	for range ticker.C {
@@ -151,20 +161,14 @@ func processTC(cancelCtx context.Context, paramData *configMgmt.ParameterData) {
 			return
 		default:
 			key := uint32(TC_ACT_OK)
-			var stats []TCStats
-			var totalPackets uint64
-			var totalBytes uint64
-
-			err := statsMap.Lookup(&key, &stats)
-			if err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Print(err)
 				return
 			}
 
-			for _, cpuStat := range stats {
-				totalPackets += cpuStat.Packets
-				totalBytes += cpuStat.Bytes
-			}
+			stats, _ := statsReader.Total(key)
+			totalPackets := stats.Packets
+			totalBytes := stats.Bytes
 
 			log.Printf("TC: %d packets received %s\n", totalPackets, action)
 			log.Printf("TC: %d bytes received %s\n", totalBytes, action)
@@ -25,6 +25,10 @@ type TPStats struct {
 	Calls uint64
 }
 
+func addTPStats(total *TPStats, cpuValue *TPStats) {
+	total.Calls += cpuValue.Calls
+}
+
 func processTracepoint(cancelCtx context.Context, paramData *configMgmt.ParameterData) {
 	// determine the path to the tracepoint_stats_map, whether provided via CRD
 	// or BPFMAN or otherwise.
@@ -126,6 +130,11 @@ func processTracepoint(cancelCtx context.Context, paramData *configMgmt.Paramete
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, TPStats](statsMap, addTPStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
 
 	// send a SIGUSR1 signal to this program on repeat, which the BPF program
 	// will report on to the stats map.
@@ -150,17 +159,13 @@ func processTracepoint(cancelCtx context.Context, paramData *configMgmt.Paramete
 			log.Printf("Exiting Tracepoint...\n")
 			return
 		default:
-			var stats []TPStats
-			var totalCalls uint64
-
-			if err := statsMap.Lookup(&index, &stats); err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Printf("map lookup failed: %v", err)
 				return
 			}
 
-			for _, stat := range stats {
-				totalCalls += stat.Calls
-			}
+			stats, _ := statsReader.Total(index)
+			totalCalls := stats.Calls
 
 			log.Printf("Tracepoint: SIGUSR1 signal count: %d\n", totalCalls)
 		}
@@ -23,6 +23,10 @@ type Stats struct {
 	Counter uint64
 }
 
+func addStats(total *Stats, cpuValue *Stats) {
+	total.Counter += cpuValue.Counter
+}
+
 func processUprobe(cancelCtx context.Context, paramData *configMgmt.ParameterData) {
 	// determine the path to the uprobe_stats_map, whether provided via CRD
 	// or BPFMAN or otherwise.
@@ -127,6 +131,11 @@ func processUprobe(cancelCtx context.Context, paramData *configMgmt.ParameterDat
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, Stats](statsMap, addStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
 
 	// retrieve and report on the number of times the uprobe is executed.
 	index := uint32(0)
@@ -137,17 +146,13 @@ func processUprobe(cancelCtx context.Context, paramData *configMgmt.ParameterDat
 			log.Printf("Exiting...\n")
 			return
 		default:
-			var stats []Stats
-			var totalCount uint64
-
-			if err := statsMap.Lookup(&index, &stats); err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Printf("map lookup failed: %v", err)
 				return
 			}
 
-			for _, stat := range stats {
-				totalCount += stat.Counter
-			}
+			stats, _ := statsReader.Total(index)
+			totalCount := stats.Counter
 
 			log.Printf("Uprobe: count: %d\n", totalCount)
 		}
@@ -20,6 +20,11 @@ type XdpStats struct {
 	Bytes   uint64
 }
 
+func addXdpStats(total *XdpStats, cpuValue *XdpStats) {
+	total.Packets += cpuValue.Packets
+	total.Bytes += cpuValue.Bytes
+}
+
 const (
 	XDPBpfProgramMapIndex = "xdp_stats_map"
 )
@@ -129,6 +134,11 @@ func processXdp(cancelCtx context.Context, paramData *configMgmt.ParameterData)
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, XdpStats](statsMap, addXdpStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
 
 	ticker := time.NewTicker(2 * time.Second)
 	for range ticker.C {
@@ -138,20 +148,14 @@ func processXdp(cancelCtx context.Context, paramData *configMgmt.ParameterData)
 			return
 		default:
 			key := uint32(XDP_ACT_OK)
-			var stats []XdpStats
-			var totalPackets uint64
-			var totalBytes uint64
-
-			err := statsMap.Lookup(&key, &stats)
-			if err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Print(err)
 				return
 			}
 
-			for _, cpuStat := range stats {
-				totalPackets += cpuStat.Packets
-				totalBytes += cpuStat.Bytes
-			}
+			stats, _ := statsReader.Total(key)
+			totalPackets := stats.Packets
+			totalBytes := stats.Bytes
 
 			log.Printf("XDP: %d packets received\n", totalPackets)
 			log.Printf("XDP: %d bytes received\n", totalBytes)
@@ -7,6 +7,8 @@
 
 #include <bpf/bpf_helpers.h>
 
+#include "mmap_counters.h"
+
 // This counting program example was adapted from
 // https://github.com/xdp-project/xdp-tutorial/tree/master/basic03-map-counter
 
@@ -14,16 +16,26 @@
 struct datarec {
   __u64 rx_packets;
   __u64 rx_bytes;
-} datarec;
+};
 
 struct {
   __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
   __type(key, __u32);
-  __type(value, datarec);
+  __type(value, struct datarec);
   __uint(max_entries, TC_ACT_VALUE_MAX);
   __uint(pinning, LIBBPF_PIN_BY_NAME);
 } tc_stats_map SEC(".maps");
 
+/* The same counters, readable by userspace through a shared mapping. */
+DEFINE_MMAP_COUNTERS(tc_mmap_stats_map, TC_ACT_VALUE_MAX);
+
+/* And in shards shared by all CPUs, for when per-CPU copies of the counters
+ * cost too much memory.
+ */
+#define TC_COUNTER_SHARDS 8
+DEFINE_SHARDED_COUNTERS(tc_sharded_stats_map, TC_ACT_VALUE_MAX,
+                        TC_COUNTER_SHARDS);
+
 static __u32 tc_stats_record_action(struct __sk_buff *skb, __u32 action) {
   void *data = (void *)(long)skb->data;
   void *data_end = (void *)(long)skb->data_end;
@@ -34,16 +46,23 @@ static __u32 tc_stats_record_action(struct __sk_buff *skb, __u32 action) {
   if (action >= TC_ACT_VALUE_MAX)
     return TC_ACT_SHOT;
 
-  /* Lookup in kernel BPF-side return pointer to actual data record */
-  struct datarec *rec = bpf_map_lookup_elem(&tc_stats_map, &action);
-  if (!rec)
-    return TC_ACT_SHOT;
-
   /* Calculate packet length */
   __u64 bytes = data_end - data;
 
-  rec->rx_packets++;
-  rec->rx_bytes += bytes;
+  if (counter_layout_enabled(COUNTER_LAYOUT_PERCPU)) {
+    /* Lookup in kernel BPF-side return pointer to actual data record */
+    struct datarec *rec = bpf_map_lookup_elem(&tc_stats_map, &action);
+    if (!rec)
+      return TC_ACT_SHOT;
+
+    rec->rx_packets++;
+    rec->rx_bytes += bytes;
+  }
+  if (counter_layout_enabled(COUNTER_LAYOUT_MMAP))
+    mmap_counters_add(&tc_mmap_stats_map, TC_ACT_VALUE_MAX, action, bytes);
+  if (counter_layout_enabled(COUNTER_LAYOUT_SHARDED))
+    sharded_counters_add(&tc_sharded_stats_map, TC_ACT_VALUE_MAX,
+                         TC_COUNTER_SHARDS, action, bytes);
 
   return action;
 }
@@ -9,12 +9,14 @@ import (
 	"log"
 	"os"
 	"os/signal"
+	"path/filepath"
 	"syscall"
 	"time"
 
 	bpfmanHelpers "github.com/bpfman/bpfman-operator/pkg/helpers"
 	gobpfman "github.com/bpfman/bpfman/clients/gobpfman/v1"
 	configMgmt "github.com/bpfman/bpfman/examples/pkg/config-mgmt"
+	counters "github.com/bpfman/bpfman/examples/pkg/counters"
 	"github.com/cilium/ebpf"
 )
 
@@ -23,10 +25,16 @@ type Stats struct {
 	Bytes   uint64
 }
 
+func addStats(total *Stats, cpuValue *Stats) {
+	total.Packets += cpuValue.Packets
+	total.Bytes += cpuValue.Bytes
+}
+
 const (
 	DefaultByteCodeFile = "bpf_bpfel.o"
 	TcProgramName       = "go-tc-counter-example"
 	BpfProgramMapIndex  = "tc_stats_map"
+	MmapStatsMapIndex   = "tc_mmap_stats_map"
 
 	// MapsMountPoint is the "go-tc-counter-maps" volumeMount "mountPath" from "deployment.yaml"
 	MapsMountPoint = "/run/tc/maps"
@@ -34,9 +42,12 @@ const (
 
 const (
 	TC_ACT_OK = 0
+
+	// Number of keys of the mmapable counters, one per action.
+	TC_ACT_VALUE_MAX = 8
 )
 
-//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -cc clang -no-strip -cflags "-O2 -g -Wall" bpf ./bpf/tc_counter.c -- -I.:/usr/include/bpf:/usr/include/linux
+//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -cc clang -no-strip -cflags "-O2 -g -Wall" bpf ./bpf/tc_counter.c -- -I.:../pkg/counters/bpf:/usr/include/bpf:/usr/include/linux
 func main() {
 	stop := make(chan os.Signal, 1)
 	signal.Notify(stop, os.Interrupt, syscall.SIGINT, syscall.SIGTERM)
@@ -48,6 +59,23 @@ func main() {
 		return
 	}
 
+	// measure the per-packet cost of each counter layout and exit.
+	if paramData.Bench > 0 {
+		if paramData.BytecodeSrc != configMgmt.SrcFile {
+			log.Printf("-bench requires a bytecode file\n")
+			return
+		}
+		spec, err := ebpf.LoadCollectionSpec(paramData.BytecodeSource.GetFile())
+		if err != nil {
+			log.Print(err)
+			return
+		}
+		if err := counters.LogBenchmark(spec, "stats", paramData.Bench); err != nil {
+			log.Print(err)
+		}
+		return
+	}
+
 	var action string
 	var direction bpfmanHelpers.TcProgramDirection
 	if paramData.Direction == configMgmt.TcDirectionIngress {
@@ -178,24 +206,40 @@ func main() {
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, Stats](statsMap, addStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
+
+	// prefer the mmapable counters, which are read without any syscall, when
+	// the bytecode provides them.
+	mmapPath := filepath.Join(filepath.Dir(mapPath), MmapStatsMapIndex)
+	mmapCounters, err := gobpfman.LoadPinnedMmapCounters(mmapPath, TC_ACT_VALUE_MAX)
+	if err != nil {
+		log.Printf("Not using mmapable counters: %v\n", err)
+		mmapCounters = nil
+	} else {
+		defer mmapCounters.Close()
+	}
 
 	ticker := time.NewTicker(3 * time.Second)
 	go func() {
 		for range ticker.C {
-			key := uint32(TC_ACT_OK)
-			var stats []Stats
 			var totalPackets uint64
 			var totalBytes uint64
 
-			err := statsMap.Lookup(&key, &stats)
-			if err != nil {
-				log.Print(err)
-				return
-			}
+			if mmapCounters != nil {
+				totalPackets, totalBytes = mmapCounters.Read(TC_ACT_OK)
+			} else {
+				if _, _, err := statsReader.Read(); err != nil {
+					log.Print(err)
+					return
+				}
 
-			for _, cpuStat := range stats {
-				totalPackets += cpuStat.Packets
-				totalBytes += cpuStat.Bytes
+				stats, _ := statsReader.Total(uint32(TC_ACT_OK))
+				totalPackets = stats.Packets
+				totalBytes = stats.Bytes
 			}
 
 			log.Printf("%d packets %s\n", totalPackets, action)
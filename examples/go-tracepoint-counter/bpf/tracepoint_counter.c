@@ -8,14 +8,16 @@
 
 #include <bpf/bpf_helpers.h>
 
+#include "ringbuf_events.h"
+
 struct datarec {
   __u64 calls;
-} datarec;
+};
 
 struct {
   __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
   __type(key, __u32);
-  __type(value, datarec);
+  __type(value, struct datarec);
   __uint(max_entries, 8);
   __uint(pinning, LIBBPF_PIN_BY_NAME);
 } tracepoint_stats_map SEC(".maps");
@@ -38,7 +40,7 @@ static __u32 tracepoint_kill_recorder(struct kill_args *ctx) {
     return 1;
 
   rec->calls++;
-  bpf_printk("process received SIGUSR1");
+  bpfman_event_emit(BPFMAN_EVENT_TRACEPOINT, ctx->pid);
 
   return 0;
 }
@@ -5,16 +5,20 @@ package main
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"log"
 	"os"
 	"os/signal"
+	"path/filepath"
+	"sync/atomic"
 	"syscall"
 	"time"
 
 	bpfmanHelpers "github.com/bpfman/bpfman-operator/pkg/helpers"
 	gobpfman "github.com/bpfman/bpfman/clients/gobpfman/v1"
 	configMgmt "github.com/bpfman/bpfman/examples/pkg/config-mgmt"
+	ringbufEvents "github.com/bpfman/bpfman/examples/pkg/ringbuf-events"
 	"github.com/cilium/ebpf"
 )
 
@@ -31,7 +35,11 @@ type Stats struct {
 	Calls uint64
 }
 
-//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -cc clang -no-strip -cflags "-O2 -g -Wall" bpf ./bpf/tracepoint_counter.c -- -I.:/usr/include/bpf:/usr/include/linux
+func addStats(total *Stats, cpuValue *Stats) {
+	total.Calls += cpuValue.Calls
+}
+
+//go:generate go run github.com/cilium/ebpf/cmd/bpf2go -cc clang -no-strip -cflags "-O2 -g -Wall" bpf ./bpf/tracepoint_counter.c -- -I.:../pkg/ringbuf-events/bpf:/usr/include/bpf:/usr/include/linux
 func main() {
 	stop := make(chan os.Signal, 1)
 	signal.Notify(stop, os.Interrupt, syscall.SIGINT, syscall.SIGTERM)
@@ -163,6 +171,30 @@ func main() {
 		log.Print(err)
 		return
 	}
+	statsReader, err := gobpfman.NewPerCpuMapReader[uint32, Stats](statsMap, addStats)
+	if err != nil {
+		log.Print(err)
+		return
+	}
+
+	// drain the events the program emits on each hit, in batches.
+	events, err := ringbufEvents.OpenPinned(filepath.Dir(mapPath))
+	if err != nil {
+		log.Printf("Failed to open events ring buffer in: %s\n", filepath.Dir(mapPath))
+		log.Print(err)
+		return
+	}
+	var eventCount atomic.Uint64
+	eventsCtx, cancelEvents := context.WithCancel(context.Background())
+	defer cancelEvents()
+	go func() {
+		err := events.Run(eventsCtx, func(batch []ringbufEvents.Event) {
+			eventCount.Add(uint64(len(batch)))
+		})
+		if err != nil && !errors.Is(err, context.Canceled) {
+			log.Printf("events consumer failed: %v", err)
+		}
+	}()
 
 	// send a SIGUSR1 signal to this program on repeat, which the BPF program
 	// will report on to the stats map.
@@ -183,19 +215,15 @@ func main() {
 	ticker := time.NewTicker(1 * time.Second)
 	go func() {
 		for range ticker.C {
-			var stats []Stats
-			var totalCalls uint64
-
-			if err := statsMap.Lookup(&index, &stats); err != nil {
+			if _, _, err := statsReader.Read(); err != nil {
 				log.Printf("map lookup failed: %v", err)
 				return
 			}
 
-			for _, stat := range stats {
-				totalCalls += stat.Calls
-			}
+			stats, _ := statsReader.Total(index)
+			totalCalls := stats.Calls
 
-			log.Printf("SIGUSR1 signal count: %d\n", totalCalls)
+			log.Printf("SIGUSR1 signal count: %d, events: %d\n", totalCalls, eventCount.Load())
 		}
 	}()
 
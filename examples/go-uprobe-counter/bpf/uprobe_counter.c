@@ -8,14 +8,16 @@
 
 #include <bpf/bpf_helpers.h>
 
+#include "ringbuf_events.h"
+
 struct datarec {
   __u64 counter;
-} datarec;
+};
 
 struct {
   __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
   __type(key, __u32);
-  __type(value, datarec);
+  __type(value, struct datarec);
   __uint(max_entries, 1);
   __uint(pinning, LIBBPF_PIN_BY_NAME);
 } uprobe_stats_map SEC(".maps");
@@ -29,7 +31,7 @@ static __u32 uprobe_counter(struct pt_regs *ctx) {
     return 1;
 
   rec->counter++;
-  bpf_printk("uprobe called");
+  bpfman_event_emit(BPFMAN_EVENT_UPROBE, rec->counter);
 
   return 0;
 }
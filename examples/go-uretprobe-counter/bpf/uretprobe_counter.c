@@ -8,6 +8,8 @@
 
 #include <bpf/bpf_helpers.h>
 
+#include "ringbuf_events.h"
+
 struct {
   __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
   __type(key, __u32);
@@ -28,7 +30,7 @@ static __u32 uretprobe_counter(struct pt_regs *ctx) {
     return 0;
   }
   __sync_fetch_and_add(valp, 1);
-  bpf_printk("uretprobe called");
+  bpfman_event_emit(BPFMAN_EVENT_URETPROBE, *valp);
 
   return 0;
 }
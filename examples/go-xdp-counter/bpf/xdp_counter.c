@@ -8,13 +8,15 @@
 
 #include <bpf/bpf_helpers.h>
 
+#include "mmap_counters.h"
+
 #define XDP_ACTION_MAX (XDP_REDIRECT + 1)
 
 /* This is the data record stored in the map */
 struct datarec {
   __u64 rx_packets;
   __u64 rx_bytes;
-} datarec;
+};
 
 /* Lesson#1: See how a map is defined.
  * - Here an array with XDP_ACTION_MAX (max_)entries are created.
@@ -23,11 +25,21 @@ struct datarec {
 struct {
   __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
   __type(key, __u32);
-  __type(value, datarec);
+  __type(value, struct datarec);
   __uint(max_entries, XDP_ACTION_MAX);
   __uint(pinning, LIBBPF_PIN_BY_NAME);
 } xdp_stats_map SEC(".maps");
 
+/* The same counters, readable by userspace through a shared mapping. */
+DEFINE_MMAP_COUNTERS(xdp_mmap_stats_map, XDP_ACTION_MAX);
+
+/* And in shards shared by all CPUs, for when per-CPU copies of the counters
+ * cost too much memory.
+ */
+#define XDP_COUNTER_SHARDS 8
+DEFINE_SHARDED_COUNTERS(xdp_sharded_stats_map, XDP_ACTION_MAX,
+                        XDP_COUNTER_SHARDS);
+
 static __always_inline __u32 xdp_stats_record_action(struct xdp_md *ctx,
                                                      __u32 action) {
   void *data_end = (void *)(long)ctx->data_end;
@@ -36,20 +48,27 @@ static __always_inline __u32 xdp_stats_record_action(struct xdp_md *ctx,
   if (action >= XDP_ACTION_MAX)
     return XDP_ABORTED;
 
-  /* Lookup in kernel BPF-side return pointer to actual data record */
-  struct datarec *rec = bpf_map_lookup_elem(&xdp_stats_map, &action);
-  if (!rec)
-    return XDP_ABORTED;
-
   /* Calculate packet length */
   __u64 bytes = data_end - data;
 
-  /* BPF_MAP_TYPE_PERCPU_ARRAY returns a data record specific to current
-   * CPU and XDP hooks runs under Softirq, which makes it safe to update
-   * without atomic operations.
-   */
-  rec->rx_packets++;
-  rec->rx_bytes += bytes;
+  if (counter_layout_enabled(COUNTER_LAYOUT_PERCPU)) {
+    /* Lookup in kernel BPF-side return pointer to actual data record */
+    struct datarec *rec = bpf_map_lookup_elem(&xdp_stats_map, &action);
+    if (!rec)
+      return XDP_ABORTED;
+
+    /* BPF_MAP_TYPE_PERCPU_ARRAY returns a data record specific to current
+     * CPU and XDP hooks runs under Softirq, which makes it safe to update
+     * without atomic operations.
+     */
+    rec->rx_packets++;
+    rec->rx_bytes += bytes;
+  }
+  if (counter_layout_enabled(COUNTER_LAYOUT_MMAP))
+    mmap_counters_add(&xdp_mmap_stats_map, XDP_ACTION_MAX, action, bytes);
+  if (counter_layout_enabled(COUNTER_LAYOUT_SHARDED))
+    sharded_counters_add(&xdp_sharded_stats_map, XDP_ACTION_MAX,
+                         XDP_COUNTER_SHARDS, action, bytes);
 
   return action;
 }
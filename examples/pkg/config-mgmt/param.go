@@ -69,6 +69,9 @@ type ParameterData struct {
 	// because isBytecodeLocation_Location is not Public
 	BytecodeSource *gobpfman.BytecodeLocation
 	BytecodeSrc    int
+	// Number of runs of the counter layouts benchmark, zero when not
+	// benchmarking.
+	Bench int
 }
 
 func ParseParamData(progType ProgType, bytecodeFile string) (ParameterData, error) {
@@ -107,6 +110,13 @@ func ParseParamData(progType ProgType, bytecodeFile string) (ParameterData, erro
 	flag.IntVar(&paramData.MapOwnerId, "map_owner_id", 0,
 		"Program Id of loaded eBPF program this eBPF program will share a map with.\n"+
 			"Example: -map_owner_id 9785")
+	if progType == ProgTypeXdp || progType == ProgTypeTc {
+		flag.IntVar(&paramData.Bench, "bench", 0,
+			"Run the bytecode file this many times with BPF_PROG_TEST_RUN for each\n"+
+				"counter layout and report the per-packet cost, instead of loading it\n"+
+				"with bpfman. Optional.\n"+
+				"Example: -bench 1000000")
+	}
 	flag.Parse()
 
 	if paramData.CrdFlag {
@@ -0,0 +1,109 @@
+/*
+Copyright 2024.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Package counters benchmarks the counter layouts of bpf/counters.h.
+package counters
+
+import (
+	"fmt"
+	"log"
+	"time"
+
+	"github.com/cilium/ebpf"
+)
+
+// Counter layouts, matching the COUNTER_LAYOUT_* flags of counters.h.
+const (
+	LayoutPerCpu  uint32 = 1 << 0
+	LayoutMmap    uint32 = 1 << 1
+	LayoutSharded uint32 = 1 << 2
+
+	// LayoutsVariable is the global selecting the layouts a program updates.
+	LayoutsVariable = "counter_layouts"
+)
+
+// BenchLayouts are the layouts benchmarked, none first as the baseline.
+var BenchLayouts = []struct {
+	Name    string
+	Layouts uint32
+}{
+	{"none", 0},
+	{"per-cpu", LayoutPerCpu},
+	{"mmap", LayoutMmap},
+	{"sharded", LayoutSharded},
+	{"per-cpu+mmap (default)", LayoutPerCpu | LayoutMmap},
+}
+
+// benchPacket is a minimal Ethernet frame, the counting programs don't parse
+// packets.
+var benchPacket = make([]byte, 64)
+
+// Benchmark runs the program named progName of spec `repeat` times per counter
+// layout with BPF_PROG_TEST_RUN and returns the cost per packet of each layout.
+//
+// The program is loaded directly rather than through bpfman, with pinning
+// disabled so it doesn't touch the maps of a deployed program.
+func Benchmark(spec *ebpf.CollectionSpec, progName string, repeat int) (map[string]time.Duration, error) {
+	results := make(map[string]time.Duration, len(BenchLayouts))
+
+	for _, layout := range BenchLayouts {
+		s := spec.Copy()
+		for _, m := range s.Maps {
+			m.Pinning = ebpf.PinNone
+		}
+		if err := s.RewriteConstants(map[string]interface{}{
+			LayoutsVariable: layout.Layouts,
+		}); err != nil {
+			return nil, err
+		}
+
+		coll, err := ebpf.NewCollection(s)
+		if err != nil {
+			return nil, fmt.Errorf("loading %s with %s counters: %w", progName, layout.Name, err)
+		}
+		prog, ok := coll.Programs[progName]
+		if !ok {
+			coll.Close()
+			return nil, fmt.Errorf("program %s not found", progName)
+		}
+
+		_, perRun, err := prog.Benchmark(benchPacket, repeat, nil)
+		coll.Close()
+		if err != nil {
+			return nil, fmt.Errorf("running %s with %s counters: %w", progName, layout.Name, err)
+		}
+		results[layout.Name] = perRun
+	}
+
+	return results, nil
+}
+
+// LogBenchmark runs Benchmark and logs the results, relative to a program
+// that counts nothing.
+func LogBenchmark(spec *ebpf.CollectionSpec, progName string, repeat int) error {
+	results, err := Benchmark(spec, progName, repeat)
+	if err != nil {
+		return err
+	}
+
+	baseline := results[BenchLayouts[0].Name]
+	log.Printf("Per-packet cost of %s over %d runs:\n", progName, repeat)
+	for _, layout := range BenchLayouts {
+		d := results[layout.Name]
+		log.Printf("  %-24s %6dns (%+dns)\n", layout.Name, d.Nanoseconds(), (d - baseline).Nanoseconds())
+	}
+	return nil
+}
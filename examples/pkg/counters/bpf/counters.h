@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause)
+// Copyright Authors of bpfman
+
+#ifndef __BPFMAN_COUNTERS_H
+#define __BPFMAN_COUNTERS_H
+
+/* Packet and byte counter records that never share a cache line, and
+ * sharded counters for maps shared by all CPUs.
+ *
+ * A BPF_MAP_TYPE_PERCPU_ARRAY gives every CPU its own copy of a counter, at
+ * the cost of one copy per possible CPU. When that is too much memory, a
+ * plain array can be used instead, but CPUs then write to the same cache
+ * lines and the counters false-share. Sharded counters keep `nshards` padded
+ * records per key instead, and every CPU updates the shard picked by its CPU
+ * number, so contention is limited to the CPUs sharing a shard while memory
+ * stays independent of the number of CPUs. The shards of `key` are at
+ * indexes [key * nshards, (key + 1) * nshards) and userspace sums them.
+ */
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#define COUNTERS_CACHE_LINE 64
+
+/* A counter record padded to, and aligned on, a cache line. */
+struct counter_rec {
+  __u64 packets;
+  __u64 bytes;
+} __attribute__((aligned(COUNTERS_CACHE_LINE)));
+
+/* Defines a pinned array of `nshards` counters per key, for keys in
+ * [0, nkeys).
+ */
+#define DEFINE_SHARDED_COUNTERS(name, nkeys, nshards)                          \
+  struct {                                                                     \
+    __uint(type, BPF_MAP_TYPE_ARRAY);                                          \
+    __type(key, __u32);                                                        \
+    __type(value, struct counter_rec);                                         \
+    __uint(max_entries, (nkeys) * (nshards));                                  \
+    __uint(pinning, LIBBPF_PIN_BY_NAME);                                       \
+  } name SEC(".maps")
+
+/* Counts one packet of `bytes` bytes for `key` in the shard of the current
+ * CPU. Shards can be shared by several CPUs, so updates are atomic.
+ */
+static __always_inline void sharded_counters_add(void *map, __u32 nkeys,
+                                                 __u32 nshards, __u32 key,
+                                                 __u64 bytes) {
+  struct counter_rec *rec;
+  __u32 index;
+
+  if (key >= nkeys)
+    return;
+
+  index = key * nshards + bpf_get_smp_processor_id() % nshards;
+  rec = bpf_map_lookup_elem(map, &index);
+  if (!rec)
+    return;
+
+  __sync_fetch_and_add(&rec->packets, 1);
+  __sync_fetch_and_add(&rec->bytes, bytes);
+}
+
+/* The counter layouts a program updates, selected at load time through the
+ * `counter_layouts` global (e.g. with bpfman's `--global` option). It lives
+ * in rodata, so the verifier prunes the layouts that aren't selected and
+ * they cost nothing.
+ */
+#define COUNTER_LAYOUT_PERCPU (1U << 0)
+#define COUNTER_LAYOUT_MMAP (1U << 1)
+#define COUNTER_LAYOUT_SHARDED (1U << 2)
+
+#ifndef COUNTER_LAYOUTS_DEFAULT
+#define COUNTER_LAYOUTS_DEFAULT (COUNTER_LAYOUT_PERCPU | COUNTER_LAYOUT_MMAP)
+#endif
+
+volatile const __u32 counter_layouts = COUNTER_LAYOUTS_DEFAULT;
+
+static __always_inline int counter_layout_enabled(__u32 layout) {
+  return counter_layouts & layout;
+}
+
+#endif /* __BPFMAN_COUNTERS_H */
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause)
+// Copyright Authors of bpfman
+
+#ifndef __BPFMAN_MMAP_COUNTERS_H
+#define __BPFMAN_MMAP_COUNTERS_H
+
+/* Packet and byte counters kept in a BPF_F_MMAPABLE array, so userspace can
+ * read them through a shared mapping of the pinned map, with no syscall and
+ * no copy per read.
+ *
+ * Unlike a BPF_MAP_TYPE_PERCPU_ARRAY, an mmapable array is a single region
+ * shared by all CPUs, so every CPU gets its own slot per key and each slot is
+ * padded to a cache line to keep CPUs from bouncing lines between them. The
+ * slot of `key` on CPU `cpu` is at index `cpu * nkeys + key`, which is the
+ * layout the Go reader in the bpfman client expects.
+ *
+ * Only the owning CPU writes a slot and the programs using these counters run
+ * with preemption disabled (XDP, TC), so plain increments are enough. CPUs
+ * from MMAP_COUNTERS_MAX_CPUS up share an extra row of overflow slots after
+ * the per-CPU ones, which they update atomically, so nothing goes uncounted
+ * on nodes with more CPUs, and the reader sums the overflow with the rest.
+ */
+
+#include "counters.h"
+
+/* Number of CPUs with slots of their own, the others share the overflow
+ * slots.
+ */
+#ifndef MMAP_COUNTERS_MAX_CPUS
+#define MMAP_COUNTERS_MAX_CPUS 256
+#endif
+
+/* Defines a pinned mmapable array of counters named `name`, for keys in
+ * [0, nkeys), with a row of overflow slots.
+ */
+#define DEFINE_MMAP_COUNTERS(name, nkeys)                                      \
+  struct {                                                                     \
+    __uint(type, BPF_MAP_TYPE_ARRAY);                                          \
+    __type(key, __u32);                                                        \
+    __type(value, struct counter_rec);                                         \
+    __uint(max_entries, (MMAP_COUNTERS_MAX_CPUS + 1) * (nkeys));               \
+    __uint(map_flags, BPF_F_MMAPABLE);                                         \
+    __uint(pinning, LIBBPF_PIN_BY_NAME);                                       \
+  } name SEC(".maps")
+
+/* Counts one packet of `bytes` bytes for `key` on the current CPU. */
+static __always_inline void mmap_counters_add(void *map, __u32 nkeys,
+                                              __u32 key, __u64 bytes) {
+  __u32 cpu = bpf_get_smp_processor_id();
+  struct counter_rec *slot;
+  __u32 index;
+
+  if (key >= nkeys)
+    return;
+
+  if (cpu >= MMAP_COUNTERS_MAX_CPUS) {
+    index = MMAP_COUNTERS_MAX_CPUS * nkeys + key;
+    slot = bpf_map_lookup_elem(map, &index);
+    if (!slot)
+      return;
+    __sync_fetch_and_add(&slot->packets, 1);
+    __sync_fetch_and_add(&slot->bytes, bytes);
+    return;
+  }
+
+  index = cpu * nkeys + key;
+  slot = bpf_map_lookup_elem(map, &index);
+  if (!slot)
+    return;
+
+  slot->packets++;
+  slot->bytes += bytes;
+}
+
+#endif /* __BPFMAN_MMAP_COUNTERS_H */
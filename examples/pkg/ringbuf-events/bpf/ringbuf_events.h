@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: (GPL-2.0-only OR BSD-2-Clause)
+// Copyright Authors of bpfman
+
+#ifndef __BPFMAN_RINGBUF_EVENTS_H
+#define __BPFMAN_RINGBUF_EVENTS_H
+
+/* Structured events for tracing programs (kprobe, uprobe, tracepoint),
+ * delivered to userspace through a BPF_MAP_TYPE_RINGBUF instead of
+ * bpf_printk().
+ *
+ * Every event is reserved directly in the ring buffer and submitted in place,
+ * so there is no copy and no serialisation through trace_pipe. Two knobs keep
+ * hot probes cheap:
+ *
+ *  - `bpfman_events_sample_rate` emits one event in N (0 disables events). It
+ *    is a global in rodata, so it can be set at load time with bpfman's
+ *    `--global` option, e.g. `--global bpfman_events_sample_rate=64000000`
+ *    for one in 100 on a little endian host.
+ *  - Consumers are only woken up once BPFMAN_EVENTS_WAKEUP_BYTES of events are
+ *    pending, so userspace drains the buffer in batches instead of taking an
+ *    interrupt per event. Consumers must therefore poll with a timeout, as
+ *    the Go consumer in this package does.
+ *
+ * Events that don't fit in the ring buffer are counted in the per-CPU
+ * `bpfman_events_dropped` map.
+ *
+ * The ring buffer and its size can be tuned by defining
+ * BPFMAN_EVENTS_RINGBUF_SIZE (a power of two multiple of the page size) and
+ * BPFMAN_EVENTS_WAKEUP_BYTES before including this header.
+ */
+
+#include <linux/bpf.h>
+#include <linux/types.h>
+
+#include <bpf/bpf_helpers.h>
+
+#ifndef BPFMAN_EVENTS_RINGBUF_SIZE
+#define BPFMAN_EVENTS_RINGBUF_SIZE (256 * 1024)
+#endif
+
+#ifndef BPFMAN_EVENTS_WAKEUP_BYTES
+#define BPFMAN_EVENTS_WAKEUP_BYTES (BPFMAN_EVENTS_RINGBUF_SIZE / 8)
+#endif
+
+#define BPFMAN_EVENT_COMM_LEN 16
+
+/* Identifies the program that emitted an event. Must match the Kind
+ * constants of the Go consumer.
+ */
+enum bpfman_event_kind {
+  BPFMAN_EVENT_KPROBE = 1,
+  BPFMAN_EVENT_UPROBE = 2,
+  BPFMAN_EVENT_URETPROBE = 3,
+  BPFMAN_EVENT_TRACEPOINT = 4,
+};
+
+/* Layout shared with the Go consumer, keep both in sync. */
+struct bpfman_event {
+  __u64 timestamp_ns; /* bpf_ktime_get_ns() when the event was emitted */
+  __u32 kind;         /* enum bpfman_event_kind */
+  __u32 cpu;          /* CPU the program ran on */
+  __u32 pid;          /* Thread id */
+  __u32 tgid;         /* Process id */
+  __u64 value;        /* Program specific, e.g. the counter value */
+  char comm[BPFMAN_EVENT_COMM_LEN];
+};
+
+volatile const __u32 bpfman_events_sample_rate = 1;
+
+struct {
+  __uint(type, BPF_MAP_TYPE_RINGBUF);
+  __uint(max_entries, BPFMAN_EVENTS_RINGBUF_SIZE);
+  __uint(pinning, LIBBPF_PIN_BY_NAME);
+} bpfman_events SEC(".maps");
+
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __type(key, __u32);
+  __type(value, __u64);
+  __uint(max_entries, 1);
+  __uint(pinning, LIBBPF_PIN_BY_NAME);
+} bpfman_events_dropped SEC(".maps");
+
+static __always_inline int bpfman_event_sampled(void) {
+  __u32 rate = bpfman_events_sample_rate;
+
+  if (rate <= 1)
+    return rate == 1;
+  return bpf_get_prandom_u32() % rate == 0;
+}
+
+static __always_inline __u64 bpfman_event_wakeup_flags(void) {
+  if (bpf_ringbuf_query(&bpfman_events, BPF_RB_AVAIL_DATA) >=
+      BPFMAN_EVENTS_WAKEUP_BYTES)
+    return BPF_RB_FORCE_WAKEUP;
+  return BPF_RB_NO_WAKEUP;
+}
+
+/* Emits an event of the given kind carrying `value`, subject to sampling. */
+static __always_inline void bpfman_event_emit(__u32 kind, __u64 value) {
+  struct bpfman_event *e;
+  __u64 pid_tgid;
+  __u32 index = 0;
+  __u64 *dropped;
+
+  if (!bpfman_event_sampled())
+    return;
+
+  e = bpf_ringbuf_reserve(&bpfman_events, sizeof(*e), 0);
+  if (!e) {
+    dropped = bpf_map_lookup_elem(&bpfman_events_dropped, &index);
+    if (dropped)
+      (*dropped)++;
+    return;
+  }
+
+  pid_tgid = bpf_get_current_pid_tgid();
+  e->timestamp_ns = bpf_ktime_get_ns();
+  e->kind = kind;
+  e->cpu = bpf_get_smp_processor_id();
+  e->pid = (__u32)pid_tgid;
+  e->tgid = pid_tgid >> 32;
+  e->value = value;
+  bpf_get_current_comm(e->comm, sizeof(e->comm));
+
+  bpf_ringbuf_submit(e, bpfman_event_wakeup_flags());
+}
+
+#endif /* __BPFMAN_RINGBUF_EVENTS_H */
@@ -0,0 +1,202 @@
+/*
+Copyright 2024.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Package ringbufEvents consumes the events emitted by BPF programs built
+// with bpf/ringbuf_events.h.
+package ringbufEvents
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"time"
+
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/ringbuf"
+)
+
+const (
+	// EventsMapName is the name of the ring buffer map defined by
+	// ringbuf_events.h.
+	EventsMapName = "bpfman_events"
+	// DroppedMapName is the name of the map counting the events that didn't
+	// fit in the ring buffer.
+	DroppedMapName = "bpfman_events_dropped"
+
+	// EventSize is the size of struct bpfman_event.
+	EventSize = 48
+
+	DefaultBatchSize     = 256
+	DefaultFlushInterval = 100 * time.Millisecond
+)
+
+// Kinds of event, matching enum bpfman_event_kind.
+const (
+	KindKprobe     uint32 = 1
+	KindUprobe     uint32 = 2
+	KindUretprobe  uint32 = 3
+	KindTracepoint uint32 = 4
+)
+
+// Event mirrors struct bpfman_event.
+type Event struct {
+	TimestampNs uint64
+	Kind        uint32
+	Cpu         uint32
+	Pid         uint32
+	Tgid        uint32
+	Value       uint64
+	Comm        [16]byte
+}
+
+// CommString returns the command name of the task that emitted the event.
+func (e *Event) CommString() string {
+	if i := bytes.IndexByte(e.Comm[:], 0); i >= 0 {
+		return string(e.Comm[:i])
+	}
+	return string(e.Comm[:])
+}
+
+// decode fills the event from a raw sample without going through reflection,
+// which matters at millions of events per second.
+func (e *Event) decode(raw []byte) error {
+	if len(raw) < EventSize {
+		return fmt.Errorf("short event: %d bytes", len(raw))
+	}
+	e.TimestampNs = binary.NativeEndian.Uint64(raw[0:8])
+	e.Kind = binary.NativeEndian.Uint32(raw[8:12])
+	e.Cpu = binary.NativeEndian.Uint32(raw[12:16])
+	e.Pid = binary.NativeEndian.Uint32(raw[16:20])
+	e.Tgid = binary.NativeEndian.Uint32(raw[20:24])
+	e.Value = binary.NativeEndian.Uint64(raw[24:32])
+	copy(e.Comm[:], raw[32:48])
+	return nil
+}
+
+// Consumer drains the events ring buffer in batches.
+//
+// The BPF side only wakes consumers up once enough events are pending, so a
+// batch is handed over either when it is full or when FlushInterval has
+// elapsed since its first event, whichever comes first.
+type Consumer struct {
+	BatchSize     int
+	FlushInterval time.Duration
+
+	reader *ringbuf.Reader
+}
+
+// NewConsumer returns a consumer of the given ring buffer map.
+func NewConsumer(eventsMap *ebpf.Map) (*Consumer, error) {
+	reader, err := ringbuf.NewReader(eventsMap)
+	if err != nil {
+		return nil, err
+	}
+	return &Consumer{
+		BatchSize:     DefaultBatchSize,
+		FlushInterval: DefaultFlushInterval,
+		reader:        reader,
+	}, nil
+}
+
+// OpenPinned returns a consumer of the events map pinned in mapDir, the
+// directory the maps of a program loaded by bpfman are pinned in.
+func OpenPinned(mapDir string) (*Consumer, error) {
+	eventsMap, err := ebpf.LoadPinnedMap(filepath.Join(mapDir, EventsMapName), nil)
+	if err != nil {
+		return nil, err
+	}
+	// The reader keeps its own reference on the map.
+	defer eventsMap.Close()
+	return NewConsumer(eventsMap)
+}
+
+// Close stops the consumer, making Run return.
+func (c *Consumer) Close() error {
+	return c.reader.Close()
+}
+
+// Run hands batches of events to handle until ctx is done or the consumer is
+// closed. The batch is reused once handle returns, so handle must copy any
+// events it keeps.
+func (c *Consumer) Run(ctx context.Context, handle func([]Event)) error {
+	go func() {
+		<-ctx.Done()
+		c.reader.Close()
+	}()
+
+	batchSize := c.BatchSize
+	if batchSize <= 0 {
+		batchSize = DefaultBatchSize
+	}
+	batch := make([]Event, 0, batchSize)
+	flush := func() {
+		if len(batch) > 0 {
+			handle(batch)
+			batch = batch[:0]
+		}
+	}
+
+	var record ringbuf.Record
+	for {
+		if len(batch) == 0 {
+			c.reader.SetDeadline(time.Now().Add(c.FlushInterval))
+		}
+
+		err := c.reader.ReadInto(&record)
+		switch {
+		case err == nil:
+			batch = batch[:len(batch)+1]
+			if err := batch[len(batch)-1].decode(record.RawSample); err != nil {
+				batch = batch[:len(batch)-1]
+				continue
+			}
+			if len(batch) == batchSize {
+				flush()
+			}
+		case errors.Is(err, os.ErrDeadlineExceeded):
+			flush()
+		case errors.Is(err, ringbuf.ErrClosed):
+			flush()
+			return ctx.Err()
+		default:
+			return err
+		}
+	}
+}
+
+// Dropped returns the number of events that didn't fit in the ring buffer,
+// read from the dropped events map pinned in mapDir.
+func Dropped(mapDir string) (uint64, error) {
+	droppedMap, err := ebpf.LoadPinnedMap(filepath.Join(mapDir, DroppedMapName), nil)
+	if err != nil {
+		return 0, err
+	}
+	defer droppedMap.Close()
+
+	var perCpu []uint64
+	if err := droppedMap.Lookup(uint32(0), &perCpu); err != nil {
+		return 0, err
+	}
+	var total uint64
+	for _, d := range perCpu {
+		total += d
+	}
+	return total, nil
+}
@@ -18,19 +18,20 @@ fn main() -> anyhow::Result<()> {
     if tests_to_run_len > 0 {
         info!("Executing test case(s): {:?}", tests_to_run);
     } else {
-        info!("Executing all test cases");
+        info!("Executing all test cases, except the benchmarks");
     }
 
     for t in inventory::iter::<IntegrationTest> {
-        let test_name: String = t
-            .name
-            .split("::")
-            .collect::<Vec<&str>>()
-            .pop()
-            .expect("not a valid test name")
-            .to_string();
+        // Test cases are selected by name, or by the name of their module,
+        // e.g. bench for all the benchmarks. The benchmarks take long, so
+        // they only run when selected.
+        let mut parts = t.name.split("::");
+        let selected = parts
+            .clone()
+            .any(|part| tests_to_run.iter().any(|t| t == part));
+        let is_bench = parts.any(|part| part == "bench");
 
-        if tests_to_run_len == 0 || tests_to_run.contains(&test_name) {
+        if (tests_to_run_len == 0 && !is_bench) || selected {
             info!("Running {}", t.name);
             (t.test_fn)();
         }
@@ -0,0 +1,515 @@
+use std::{
+    collections::HashMap,
+    fs,
+    os::fd::AsFd,
+    path::{Path, PathBuf},
+    time::{Duration, Instant},
+};
+
+use bpfman::{
+    add_program, list_programs, remove_program,
+    types::{
+        Direction, KprobeProgram, ListFilter, Location, Program, ProgramData, TcProceedOn,
+        TcProgram, TracepointProgram, XdpProceedOn, XdpProgram,
+    },
+};
+use log::info;
+
+use super::{integration_test, sys, IntegrationTest, RTDIR_FS_TC_INGRESS, RTDIR_FS_XDP};
+use crate::tests::utils::*;
+
+/// Number of programs attached to the interface by the dispatcher benchmarks.
+const DISPATCHER_BENCH_PROGRAMS: u32 = 10;
+
+/// Number of interfaces programs are attached to at the same time by the
+/// parallel attach benchmark.
+const PARALLEL_BENCH_IFACES: usize = 8;
+
+/// Number of times BPF_PROG_TEST_RUN runs a dispatcher on each packet.
+const TEST_RUN_REPEAT: u32 = 100_000;
+
+/// XDP_PASS, and TC_ACT_OK, which is what the dispatchers return when every
+/// program passes the packet.
+const XDP_PASS: u32 = 2;
+const TC_ACT_OK: u32 = 0;
+
+const IPPROTO_TCP: u8 = 6;
+const IPPROTO_UDP: u8 = 17;
+
+/// Numbers of programs loaded on the node the control plane benchmark
+/// measures each operation with.
+const CONTROL_PLANE_SCALES: &[usize] = &[10, 100, 1000];
+
+/// Number of times the control plane benchmark measures each operation at
+/// each scale.
+const CONTROL_PLANE_SAMPLES: usize = 50;
+
+const BPFMAN_DB_DIR: &str = "/var/lib/bpfman/db";
+
+fn log_costs(what: &str, costs: &[Duration]) {
+    for (existing, cost) in costs.iter().enumerate() {
+        info!("{what} with {existing} other program(s) attached: {cost:?}");
+    }
+}
+
+/// Measures the cost of adding a program behind, and removing the last
+/// program from, N programs already attached to a dispatcher. Removing the
+/// last program, and adding one into a spare slot (see
+/// `spare_dispatcher_slots` in the interface configuration), update the
+/// running dispatcher instead of loading a new one, so their cost should not
+/// grow with N.
+#[integration_test]
+fn test_dispatcher_update_cost() {
+    let _namespace_guard = create_namespace().unwrap();
+
+    assert!(iface_exists(DEFAULT_BPFMAN_IFACE));
+
+    let mut loaded_ids = vec![];
+    let mut add_costs = vec![];
+    for priority in 1..=DISPATCHER_BENCH_PROGRAMS {
+        let start = Instant::now();
+        let (prog_id, _) = add_xdp(
+            DEFAULT_BPFMAN_IFACE,
+            priority,
+            None,
+            None,
+            &LoadType::File,
+            XDP_PASS_IMAGE_LOC,
+            XDP_PASS_FILE_LOC,
+            Some(XDP_PASS_NAME),
+            None, // metadata
+            None, // map_owner_id
+        );
+        add_costs.push(start.elapsed());
+        loaded_ids.push(prog_id.unwrap());
+    }
+
+    let mut remove_costs = vec![];
+    for id in loaded_ids.iter().rev() {
+        let start = Instant::now();
+        bpfman_del_program(id).expect("bpfman unload failed");
+        remove_costs.push(start.elapsed());
+    }
+    remove_costs.reverse();
+
+    log_costs("xdp add", &add_costs);
+    log_costs("xdp remove", &remove_costs);
+    assert!(!bpffs_has_entries(RTDIR_FS_XDP));
+
+    let mut loaded_ids = vec![];
+    let mut add_costs = vec![];
+    for priority in 1..=DISPATCHER_BENCH_PROGRAMS {
+        let start = Instant::now();
+        let (prog_id, _) = add_tc(
+            "ingress",
+            DEFAULT_BPFMAN_IFACE,
+            priority,
+            None,
+            None,
+            &LoadType::File,
+            TC_PASS_IMAGE_LOC,
+            TC_PASS_FILE_LOC,
+        );
+        add_costs.push(start.elapsed());
+        loaded_ids.push(prog_id.unwrap());
+    }
+
+    let mut remove_costs = vec![];
+    for id in loaded_ids.iter().rev() {
+        let start = Instant::now();
+        bpfman_del_program(id).expect("bpfman unload failed");
+        remove_costs.push(start.elapsed());
+    }
+    remove_costs.reverse();
+
+    log_costs("tc add", &add_costs);
+    log_costs("tc remove", &remove_costs);
+    assert!(!bpffs_has_entries(RTDIR_FS_TC_INGRESS));
+}
+
+fn program_data(path: &str, name: &str) -> ProgramData {
+    ProgramData::new(
+        Location::File(path.to_string()),
+        name.to_string(),
+        HashMap::new(),
+        HashMap::new(),
+        None,
+        false,
+    )
+    .unwrap()
+}
+
+fn xdp_pass_program(iface: &str) -> Program {
+    let data = program_data(XDP_PASS_FILE_LOC, XDP_PASS_NAME);
+    Program::Xdp(
+        XdpProgram::new(
+            data,
+            50,
+            iface.to_string(),
+            XdpProceedOn::default(),
+            false,
+            vec![],
+        )
+        .unwrap(),
+    )
+}
+
+fn tc_pass_program(iface: &str) -> Program {
+    let data = program_data(TC_PASS_FILE_LOC, "pass");
+    Program::Tc(
+        TcProgram::new(
+            data,
+            50,
+            iface.to_string(),
+            TcProceedOn::default(),
+            Direction::Ingress,
+        )
+        .unwrap(),
+    )
+}
+
+fn kprobe_program() -> Program {
+    let data = program_data(KPROBE_FILE_LOC, "my_kprobe");
+    Program::Kprobe(
+        KprobeProgram::new(
+            data,
+            KPROBE_KERNEL_FUNCTION_NAME.to_string(),
+            0,
+            false,
+            None,
+        )
+        .unwrap(),
+    )
+}
+
+fn tracepoint_program() -> Program {
+    let data = program_data(TRACEPOINT_FILE_LOC, "enter_openat");
+    Program::Tracepoint(
+        TracepointProgram::new(data, TRACEPOINT_TRACEPOINT_NAME.to_string()).unwrap(),
+    )
+}
+
+// Attaches a program to every interface, one after the other or all at the
+// same time, then removes them the same way. Returns how long attaching took.
+async fn attach_to_all(ifaces: &[String], parallel: bool) -> Duration {
+    let start = Instant::now();
+    let ids: Vec<u32> = if parallel {
+        let tasks: Vec<_> = ifaces
+            .iter()
+            .map(|iface| tokio::spawn(add_program(xdp_pass_program(iface))))
+            .collect();
+        let mut ids = vec![];
+        for task in tasks {
+            let program = task.await.unwrap().expect("bpfman load failed");
+            ids.push(program.get_data().get_id().unwrap());
+        }
+        ids
+    } else {
+        let mut ids = vec![];
+        for iface in ifaces {
+            let program = add_program(xdp_pass_program(iface))
+                .await
+                .expect("bpfman load failed");
+            ids.push(program.get_data().get_id().unwrap());
+        }
+        ids
+    };
+    let elapsed = start.elapsed();
+
+    let tasks: Vec<_> = ids
+        .into_iter()
+        .map(|id| tokio::spawn(remove_program(id)))
+        .collect();
+    for task in tasks {
+        task.await.unwrap().expect("bpfman unload failed");
+    }
+    elapsed
+}
+
+/// Measures attaching a program to N interfaces with N requests made one
+/// after the other, and with N requests made at the same time, as bpfman-rpc
+/// serves them. Every interface has its own dispatcher, so the concurrent
+/// requests don't wait for each other and should take about as long as the
+/// slowest of them, instead of N times as long.
+#[integration_test]
+fn test_parallel_attach_cost() {
+    let veths = create_veths(PARALLEL_BENCH_IFACES).unwrap();
+
+    let runtime = tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()
+        .unwrap();
+    let serial = runtime.block_on(attach_to_all(&veths.ifaces, false));
+    assert!(!bpffs_has_entries(RTDIR_FS_XDP));
+    let parallel = runtime.block_on(attach_to_all(&veths.ifaces, true));
+    assert!(!bpffs_has_entries(RTDIR_FS_XDP));
+
+    info!(
+        "xdp attach to {PARALLEL_BENCH_IFACES} interfaces: {serial:?} one at a time, {parallel:?} in parallel"
+    );
+}
+
+// Builds an Ethernet, IPv4 and TCP or UDP packet of `len` bytes.
+fn ipv4_packet(protocol: u8, len: usize) -> Vec<u8> {
+    let mut packet = vec![0; len];
+    packet[0..6].copy_from_slice(&[0x02, 0, 0, 0, 0, 0x02]);
+    packet[6..12].copy_from_slice(&[0x02, 0, 0, 0, 0, 0x01]);
+    packet[12..14].copy_from_slice(&0x0800u16.to_be_bytes());
+
+    let ip = &mut packet[14..];
+    ip[0] = 0x45;
+    ip[2..4].copy_from_slice(&((len - 14) as u16).to_be_bytes());
+    ip[8] = 64;
+    ip[9] = protocol;
+    ip[12..16].copy_from_slice(&[10, 0, 0, 1]);
+    ip[16..20].copy_from_slice(&[10, 0, 0, 2]);
+
+    let l4 = &mut ip[20..];
+    l4[0..2].copy_from_slice(&12345u16.to_be_bytes());
+    l4[2..4].copy_from_slice(&80u16.to_be_bytes());
+    if protocol == IPPROTO_TCP {
+        // Data offset of 5 words, ACK.
+        l4[12] = 5 << 4;
+        l4[13] = 0x10;
+    } else {
+        l4[4..6].copy_from_slice(&((len - 34) as u16).to_be_bytes());
+    }
+    packet
+}
+
+// Returns the pin of the program of the newest dispatcher of `iface` under
+// `base`, whose dispatcher directories are named dispatcher_{ifindex}_{revision}.
+fn dispatcher_pin(base: &str, iface: &str) -> PathBuf {
+    let if_index = fs::read_to_string(format!("/sys/class/net/{iface}/ifindex")).unwrap();
+    let prefix = format!("dispatcher_{}_", if_index.trim());
+    let revision = fs::read_dir(base)
+        .unwrap()
+        .filter_map(|e| e.ok()?.file_name().into_string().ok())
+        .filter_map(|name| name.strip_prefix(&prefix)?.parse::<u32>().ok())
+        .max()
+        .expect("no dispatcher loaded on the interface");
+    PathBuf::from(format!("{base}/{prefix}{revision}/dispatcher"))
+}
+
+// Runs the dispatcher of `iface` under `base` on each packet, returning the
+// average time a run took per packet.
+fn run_dispatcher(
+    base: &str,
+    iface: &str,
+    packets: &[(&str, Vec<u8>)],
+    verdict: u32,
+) -> Vec<Duration> {
+    let prog = sys::prog_from_pin(&dispatcher_pin(base, iface)).unwrap();
+    packets
+        .iter()
+        .map(|(_, packet)| {
+            let (retval, duration) =
+                sys::test_run(prog.as_fd(), packet, TEST_RUN_REPEAT).expect("test run failed");
+            assert_eq!(retval, verdict);
+            duration
+        })
+        .collect()
+}
+
+fn log_run_costs(what: &str, packets: &[(&str, Vec<u8>)], costs: &[Vec<Duration>]) {
+    for (depth, costs) in costs.iter().enumerate() {
+        for ((packet, _), cost) in packets.iter().zip(costs) {
+            info!(
+                "{what} with {} program(s), {packet} packet: {} ns/packet",
+                depth + 1,
+                cost.as_nanos()
+            );
+        }
+    }
+}
+
+/// Measures the time the XDP and TC dispatchers take to run a packet through
+/// a chain of 1 to N pass programs, with BPF_PROG_TEST_RUN, for a small UDP
+/// and a full sized TCP packet. Every program passes the packet on to the
+/// next one. bpfman doesn't load a dispatcher without programs, so the chain
+/// of 1 program is the baseline.
+#[integration_test]
+fn test_dispatcher_chain_run_cost() {
+    let _namespace_guard = create_namespace().unwrap();
+
+    assert!(iface_exists(DEFAULT_BPFMAN_IFACE));
+
+    let packets = [
+        ("64 byte udp", ipv4_packet(IPPROTO_UDP, 64)),
+        ("1500 byte tcp", ipv4_packet(IPPROTO_TCP, 1500)),
+    ];
+
+    let mut loaded_ids = vec![];
+    let mut costs = vec![];
+    for priority in 1..=DISPATCHER_BENCH_PROGRAMS {
+        let (prog_id, _) = add_xdp(
+            DEFAULT_BPFMAN_IFACE,
+            priority,
+            None,
+            None,
+            &LoadType::File,
+            XDP_PASS_IMAGE_LOC,
+            XDP_PASS_FILE_LOC,
+            Some(XDP_PASS_NAME),
+            None, // metadata
+            None, // map_owner_id
+        );
+        loaded_ids.push(prog_id.unwrap());
+        costs.push(run_dispatcher(
+            RTDIR_FS_XDP,
+            DEFAULT_BPFMAN_IFACE,
+            &packets,
+            XDP_PASS,
+        ));
+    }
+    log_run_costs("xdp dispatcher", &packets, &costs);
+    verify_and_delete_programs(loaded_ids);
+    assert!(!bpffs_has_entries(RTDIR_FS_XDP));
+
+    // tc_pass returns TC_ACT_OK, which only goes on to the next program
+    // when it is a proceed-on action.
+    let mut loaded_ids = vec![];
+    let mut costs = vec![];
+    for priority in 1..=DISPATCHER_BENCH_PROGRAMS {
+        let (prog_id, _) = add_tc(
+            "ingress",
+            DEFAULT_BPFMAN_IFACE,
+            priority,
+            None,
+            Some(vec!["ok", "dispatcher_return"]),
+            &LoadType::File,
+            TC_PASS_IMAGE_LOC,
+            TC_PASS_FILE_LOC,
+        );
+        loaded_ids.push(prog_id.unwrap());
+        costs.push(run_dispatcher(
+            RTDIR_FS_TC_INGRESS,
+            DEFAULT_BPFMAN_IFACE,
+            &packets,
+            TC_ACT_OK,
+        ));
+    }
+    log_run_costs("tc dispatcher", &packets, &costs);
+    verify_and_delete_programs(loaded_ids);
+    assert!(!bpffs_has_entries(RTDIR_FS_TC_INGRESS));
+}
+
+// Returns the median and 99th percentile of `samples`.
+fn percentiles(samples: &mut [Duration]) -> (Duration, Duration) {
+    samples.sort();
+    let at = |p: usize| samples[(samples.len() * p / 100).min(samples.len() - 1)];
+    (at(50), at(99))
+}
+
+fn log_latency(what: &str, existing: usize, samples: &mut [Duration]) {
+    let (p50, p99) = percentiles(samples);
+    info!("{what} with {existing} programs loaded: p50 {p50:?}, p99 {p99:?}");
+}
+
+fn dir_size(path: &Path) -> u64 {
+    fs::read_dir(path)
+        .map(|entries| {
+            entries
+                .filter_map(|e| e.ok())
+                .map(|e| match e.metadata() {
+                    Ok(m) if m.is_dir() => dir_size(&e.path()),
+                    Ok(m) => m.len(),
+                    Err(_) => 0,
+                })
+                .sum()
+        })
+        .unwrap_or(0)
+}
+
+// Returns the resident set size of this process, in KiB.
+fn rss_kib() -> u64 {
+    fs::read_to_string("/proc/self/status")
+        .unwrap()
+        .lines()
+        .find_map(|l| l.strip_prefix("VmRSS:"))
+        .and_then(|v| v.trim().trim_end_matches("kB").trim().parse().ok())
+        .unwrap_or(0)
+}
+
+// Measures adding, and then removing, a program of each type, and listing the
+// programs, with `existing` programs loaded.
+async fn measure_control_plane(existing: usize, iface: &str) {
+    let kinds: [(&str, Box<dyn Fn() -> Program + '_>); 4] = [
+        ("xdp", Box::new(|| xdp_pass_program(iface))),
+        ("tc", Box::new(|| tc_pass_program(iface))),
+        ("kprobe", Box::new(kprobe_program)),
+        ("tracepoint", Box::new(tracepoint_program)),
+    ];
+    for (kind, program) in kinds.iter() {
+        let mut adds = Vec::with_capacity(CONTROL_PLANE_SAMPLES);
+        let mut removes = Vec::with_capacity(CONTROL_PLANE_SAMPLES);
+        for _ in 0..CONTROL_PLANE_SAMPLES {
+            let start = Instant::now();
+            let id = add_program(program())
+                .await
+                .expect("bpfman load failed")
+                .get_data()
+                .get_id()
+                .unwrap();
+            adds.push(start.elapsed());
+
+            let start = Instant::now();
+            remove_program(id).await.expect("bpfman unload failed");
+            removes.push(start.elapsed());
+        }
+        log_latency(&format!("{kind} add"), existing, &mut adds);
+        log_latency(&format!("{kind} remove"), existing, &mut removes);
+    }
+
+    let mut lists = Vec::with_capacity(CONTROL_PLANE_SAMPLES);
+    for _ in 0..CONTROL_PLANE_SAMPLES {
+        let start = Instant::now();
+        let programs = list_programs(ListFilter::new(None, HashMap::new(), true))
+            .await
+            .expect("bpfman list failed");
+        lists.push(start.elapsed());
+        assert!(programs.len() >= existing);
+    }
+    log_latency("list", existing, &mut lists);
+
+    info!(
+        "with {existing} programs loaded: database {} KiB, rss {} KiB",
+        dir_size(Path::new(BPFMAN_DB_DIR)) / 1024,
+        rss_kib()
+    );
+}
+
+/// Measures the latency of the control plane calls, in process as bpfman-rpc
+/// makes them, with 10, 100 and 1000 programs loaded, and logs the p50 and p99
+/// latency of adding and removing XDP, TC, kprobe and tracepoint programs and
+/// of listing the programs, with the size of the database and the resident
+/// set size of the process. The node is populated with tracepoint programs,
+/// which unlike XDP and TC programs aren't limited in number per interface,
+/// and unlike kprobes don't slow down the rest of the node.
+#[integration_test]
+fn test_control_plane_latency() {
+    let _namespace_guard = create_namespace().unwrap();
+
+    let runtime = tokio::runtime::Builder::new_multi_thread()
+        .enable_all()
+        .build()
+        .unwrap();
+    runtime.block_on(async {
+        let mut loaded_ids = vec![];
+        for existing in CONTROL_PLANE_SCALES {
+            while loaded_ids.len() < *existing {
+                let program = add_program(tracepoint_program())
+                    .await
+                    .expect("bpfman load failed");
+                loaded_ids.push(program.get_data().get_id().unwrap());
+            }
+            measure_control_plane(*existing, DEFAULT_BPFMAN_IFACE).await;
+        }
+
+        for id in loaded_ids {
+            remove_program(id).await.expect("bpfman unload failed");
+        }
+    });
+    assert!(!bpffs_has_entries(RTDIR_FS_XDP));
+    assert!(!bpffs_has_entries(RTDIR_FS_TC_INGRESS));
+}
@@ -1,6 +1,8 @@
 pub mod basic;
+pub mod bench;
 pub mod e2e;
 pub mod error;
+pub mod sys;
 pub mod utils;
 
 pub use integration_test_macros::integration_test;
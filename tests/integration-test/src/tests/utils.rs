@@ -819,6 +819,61 @@ pub fn create_namespace() -> Result<NamespaceGuard> {
     Ok(NamespaceGuard { name: NS_NAME })
 }
 
+pub struct VethGuard {
+    pub ifaces: Vec<String>,
+}
+
+impl Drop for VethGuard {
+    fn drop(&mut self) {
+        // Deleting one end of a veth pair deletes both.
+        for iface in &self.ifaces {
+            let status = Command::new("ip")
+                .args(["link", "delete", iface])
+                .status()
+                .expect("could not delete veth");
+
+            if !status.success() {
+                println!("could not delete veth {iface}: {status}");
+            }
+        }
+    }
+}
+
+/// Create `count` veth pairs in the host namespace, for tests that need several
+/// interfaces, and return the names of the ends the programs are attached to
+pub fn create_veths(count: usize) -> Result<VethGuard> {
+    let mut guard = VethGuard { ifaces: vec![] };
+    for i in 0..count {
+        let iface = format!("veth-bpfm-b{i}");
+        let peer = format!("veth-bpfm-p{i}");
+
+        let status = Command::new("ip")
+            .args(["link", "add", &iface, "type", "veth", "peer", "name", &peer])
+            .status()
+            .expect("Failed to create veth");
+        if !status.success() {
+            return Err(anyhow!(
+                "failed to create veth pair {iface}-{peer}: {status}"
+            ));
+        }
+        guard.ifaces.push(iface.clone());
+
+        for dev in [&iface, &peer] {
+            let status = Command::new("ip")
+                .args(["link", "set", "dev", dev, "up"])
+                .status()
+                .expect("Failed to set veth up");
+            if !status.success() {
+                return Err(anyhow!("failed to set dev {dev} to up: {status}"));
+            }
+        }
+    }
+
+    debug!("Successfully created {count} veth pairs");
+
+    Ok(guard)
+}
+
 /// start a ping to the network namespace IP address with output logged to [`PING_FILE_NAME`]
 pub fn start_ping() -> Result<ChildGuard> {
     let f = File::create(PING_FILE_NAME).unwrap();
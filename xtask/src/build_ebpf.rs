@@ -66,6 +66,21 @@ fn get_libbpf_headers<P: AsRef<Path>>(libbpf_dir: P, include_path: P) -> anyhow:
     Ok(())
 }
 
+/// Dispatchers that are also built with a non default number of slots, see
+/// bpf/dispatcher_slots.h. The slot counts must match the ones used in
+/// bpfman/src/dispatcher_config.rs.
+const DISPATCHER_VARIANTS: &[(&str, &[usize])] = &[
+    ("xdp_dispatcher_v2.bpf.c", &[1, 2, 4, 8, 64]),
+    ("tc_dispatcher.bpf.c", &[64]),
+];
+
+/// Dispatchers that are also built, with the default and with each of the
+/// slot counts above but 1, with DISPATCHER_UNIFORM_ACTIONS defined, for
+/// chains whose slots all have the same chain call actions.
+const UNIFORM_ACTIONS_DISPATCHERS: &[&str] = &["xdp_dispatcher_v2.bpf.c"];
+
+const UNIFORM_ACTIONS_DEFINE: &str = "-DDISPATCHER_UNIFORM_ACTIONS";
+
 fn build_ebpf_files(
     src_path: PathBuf,
     include_path: PathBuf,
@@ -79,7 +94,38 @@ fn build_ebpf_files(
                 let mut out = PathBuf::from(&out_path);
                 out.push(p.file_name().unwrap());
                 out.set_extension("o");
-                compile_with_clang(&p, &out, &include_path)?;
+                compile_with_clang(&p, &out, &include_path, &[])?;
+
+                let file_name = p.file_name().unwrap().to_string_lossy().to_string();
+                let stem = file_name.trim_end_matches(".bpf.c");
+                let uniform = UNIFORM_ACTIONS_DISPATCHERS.contains(&file_name.as_str());
+                if uniform {
+                    let out = out_path.join(format!("{stem}_uniform.bpf.o"));
+                    compile_with_clang(
+                        &p,
+                        &out,
+                        &include_path,
+                        &[UNIFORM_ACTIONS_DEFINE.to_string()],
+                    )?;
+                }
+                for (_, variants) in DISPATCHER_VARIANTS.iter().filter(|(f, _)| *f == file_name) {
+                    for slots in variants.iter() {
+                        let slots_define = format!("-DMAX_DISPATCHER_ACTIONS={slots}");
+                        let out = out_path.join(format!("{stem}_{slots}.bpf.o"));
+                        compile_with_clang(&p, &out, &include_path, &[slots_define.clone()])?;
+
+                        // A single slot has nothing to share its actions with.
+                        if uniform && *slots > 1 {
+                            let out = out_path.join(format!("{stem}_{slots}_uniform.bpf.o"));
+                            compile_with_clang(
+                                &p,
+                                &out,
+                                &include_path,
+                                &[slots_define, UNIFORM_ACTIONS_DEFINE.to_string()],
+                            )?;
+                        }
+                    }
+                }
             }
         }
     }
@@ -113,11 +159,13 @@ pub fn build_ebpf(opts: Options) -> anyhow::Result<()> {
     Ok(())
 }
 
-/// Build eBPF programs with clang and libbpf headers.
+/// Build eBPF programs with clang and libbpf headers, passing any extra
+/// arguments (e.g. defines) to clang.
 fn compile_with_clang<P: Clone + AsRef<Path>>(
     src: P,
     out: P,
     include_path: P,
+    extra_args: &[String],
 ) -> anyhow::Result<()> {
     let clang = match env::var("CLANG") {
         Ok(val) => val,
@@ -136,6 +184,7 @@ fn compile_with_clang<P: Clone + AsRef<Path>>(
         .arg("bpf")
         .arg("-c")
         .arg(format!("-D__TARGET_ARCH_{arch}"))
+        .args(extra_args)
         .arg(src.as_ref().as_os_str())
         .arg("-o")
         .arg(out.as_ref().as_os_str());
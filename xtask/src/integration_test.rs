@@ -11,8 +11,8 @@ pub struct Options {
     /// Optional: The command used to wrap your application
     #[clap(short, long, default_value = "sudo -E")]
     pub runner: String,
-    /// An optional list of test cases to execute. All test cases will be
-    /// executed if not provided.
+    /// An optional list of test cases, or of modules of test cases, to
+    /// execute. All test cases will be executed if not provided.
     /// Example: cargo xtask integration-test -- test_load_unload_tracepoint_maps test_load_unload_tc_maps
     #[clap(name = "tests", verbatim_doc_comment, last = true)]
     pub run_args: Vec<String>,
@@ -34,6 +34,15 @@ fn build(opts: &Options) -> Result<(), anyhow::Error> {
     Ok(())
 }
 
+/// Build and run the benchmarks, which are the integration test cases of the
+/// bench module, or the given subset of them.
+pub fn bench(mut opts: Options) -> Result<(), anyhow::Error> {
+    if opts.run_args.is_empty() {
+        opts.run_args.push("bench".to_string());
+    }
+    test(opts)
+}
+
 /// Build and run the project
 pub fn test(opts: Options) -> Result<(), anyhow::Error> {
     build(&opts).context("Error while building userspace application")?;
@@ -34,6 +34,9 @@ enum Command {
     Run(run::Options),
     /// Run the integration tests for bpfman.
     IntegrationTest(integration_test::Options),
+    /// Run the benchmarks for bpfman, e.g. the control plane latency and
+    /// dispatcher benchmarks.
+    Bench(integration_test::Options),
     /// Build the man pages for bpfman.
     BuildManPage(build_manpage::Options),
     /// Build the completion scripts for bpfman.
@@ -61,6 +64,7 @@ fn main() {
         Copy(opts) => copy::copy(opts),
         Run(opts) => run::run(opts),
         IntegrationTest(opts) => integration_test::test(opts),
+        Bench(opts) => integration_test::bench(opts),
         BuildManPage(opts) => build_manpage::build_manpage(opts),
         BuildCompletion(opts) => build_completion::build_completion(opts),
         PublicApi(opts) => public_api::public_api(opts, metadata),